@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Resultado do cozimento de um arquivo (malha ou textura)
+struct CookReport
+{
+    std::string source;
+    std::string output;
+    bool upToDate = false;  // saída já correspondia à origem; nada foi feito
+    bool ok = false;
+    std::string error;
+    double ms = 0.0;
+    uint64_t sourceBytes = 0;
+    uint64_t cookedBytes = 0;
+    std::string details;
+};
+
+// OBJ -> .meshbin: vértices únicos, índices na ordem do cache de vértices, atributos quantizados
+bool cookMesh(const std::string& objPath, bool force, CookReport& report);
+
+// Imagem -> .texbin: RGBA8 com todos os níveis de mipmap
+bool cookTexture(const std::string& imagePath, bool force, CookReport& report);
+
+// Texturas citadas (map_*) por um arquivo MTL, com caminhos relativos à pasta do MTL
+void findMtlTextures(const std::string& mtlPath, std::vector<std::string>& textures);
+
+// Reordena os triângulos de um intervalo de índices para reaproveitar o cache de
+// vértices da GPU (algoritmo de Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+void optimizeVertexCache(unsigned int* indices, size_t nIndices, size_t nVertices);
+
+// Renumera os vértices na ordem do primeiro uso, para leituras sequenciais do VBO
+void optimizeVertexFetch(std::vector<float>& vertices, int floatsPerVertex, std::vector<unsigned int>& indices);
+
+// Média de vértices transformados por triângulo com um cache FIFO (3.0 = sem reuso)
+float computeAcmr(const unsigned int* indices, size_t nIndices, size_t nVertices, int cacheSize);
@@ -0,0 +1,188 @@
+// Cozimento de malhas (.meshbin) e texturas (.texbin)
+
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <filesystem>
+#include <cstdio>
+
+#include "AssetCooker.h"
+#include "ObjLoader.h"
+#include "MeshCache.h"
+#include "CookedTexture.h"
+#include "MappedFile.h"
+#include "stb_image.h"
+
+namespace fs = std::filesystem;
+
+static double elapsedMs(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static uint64_t fileSize(const std::string& path)
+{
+    FileStamp stamp;
+    return getFileStamp(path, stamp) ? stamp.size : 0;
+}
+
+bool cookMesh(const std::string& objPath, bool force, CookReport& report)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    report.source = objPath;
+    report.output = MeshCache::getCachePath(objPath);
+    report.sourceBytes = fileSize(objPath);
+
+    if (!force && MeshCache::isUpToDate(objPath, MESH_CACHE_COOKED)) {
+        report.upToDate = true;
+        report.ok = true;
+        report.cookedBytes = fileSize(report.output);
+        report.ms = elapsedMs(start);
+        return true;
+    }
+
+    // Cada malha é lida de forma serial; o paralelismo fica entre os arquivos
+    ObjData obj;
+    if (!loadObj(objPath, obj, 1)) {
+        report.error = "falha ao ler o OBJ";
+        report.ms = elapsedMs(start);
+        return false;
+    }
+
+    MeshData mesh;
+    buildMeshData(obj, mesh);
+    size_t nVertices = mesh.vertices.size() / 8;
+    float acmrBefore = computeAcmr(mesh.indices.data(), mesh.indices.size(), nVertices, 32);
+
+    // Submalhas continuam contíguas: cada intervalo é reordenado separadamente
+    for (size_t i = 0; i < mesh.subMeshes.size(); i++)
+        optimizeVertexCache(&mesh.indices[mesh.subMeshes[i].firstIndex], mesh.subMeshes[i].indexCount, nVertices);
+    optimizeVertexFetch(mesh.vertices, 8, mesh.indices);
+    float acmrAfter = computeAcmr(mesh.indices.data(), mesh.indices.size(), nVertices, 32);
+
+    FileStamp source;
+    getFileStamp(objPath, source);
+    hashFile(objPath, source.hash);
+
+    std::vector<char> blob;
+    MeshCache::serialize(mesh, source, MESH_VERTEX_QUANTIZED, MESH_CACHE_COOKED, blob);
+    if (!writeFileAtomically(report.output, blob.data(), blob.size())) {
+        report.error = "falha ao gravar " + report.output;
+        report.ms = elapsedMs(start);
+        return false;
+    }
+
+    char details[128];
+    snprintf(details, sizeof(details), "%d tri, %d vert, %d submalhas, ACMR %.2f -> %.2f",
+        obj.getNbTriangles(), (int)nVertices, (int)mesh.subMeshes.size(), acmrBefore, acmrAfter);
+    report.details = details;
+    report.cookedBytes = blob.size();
+    report.ok = true;
+    report.ms = elapsedMs(start);
+    return true;
+}
+
+// Reduz um nível pela metade com média de 2x2 pixels (bordas ímpares repetem a última coluna/linha)
+static void downsample(const std::vector<unsigned char>& src, int width, int height, std::vector<unsigned char>& dst)
+{
+    int newWidth = width > 1 ? width / 2 : 1;
+    int newHeight = height > 1 ? height / 2 : 1;
+    dst.resize((size_t)newWidth * newHeight * 4);
+
+    for (int y = 0; y < newHeight; y++) {
+        int y0 = y * 2 < height ? y * 2 : height - 1;
+        int y1 = y * 2 + 1 < height ? y * 2 + 1 : height - 1;
+        for (int x = 0; x < newWidth; x++) {
+            int x0 = x * 2 < width ? x * 2 : width - 1;
+            int x1 = x * 2 + 1 < width ? x * 2 + 1 : width - 1;
+            for (int c = 0; c < 4; c++) {
+                int sum = src[((size_t)y0 * width + x0) * 4 + c] + src[((size_t)y0 * width + x1) * 4 + c]
+                    + src[((size_t)y1 * width + x0) * 4 + c] + src[((size_t)y1 * width + x1) * 4 + c];
+                dst[((size_t)y * newWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+bool cookTexture(const std::string& imagePath, bool force, CookReport& report)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    report.source = imagePath;
+    report.output = CookedTexture::getCachePath(imagePath);
+    report.sourceBytes = fileSize(imagePath);
+
+    if (!force && CookedTexture::isUpToDate(imagePath)) {
+        report.upToDate = true;
+        report.ok = true;
+        report.cookedBytes = fileSize(report.output);
+        report.ms = elapsedMs(start);
+        return true;
+    }
+
+    // Sempre RGBA, para todos os níveis terem linhas alinhadas em 4 bytes
+    int width, height, nrChannels;
+    unsigned char* data = stbi_load(imagePath.c_str(), &width, &height, &nrChannels, 4);
+    if (!data) {
+        report.error = fs::exists(imagePath) ? "falha ao ler a imagem" : "imagem nao encontrada";
+        report.ms = elapsedMs(start);
+        return false;
+    }
+
+    std::vector<std::vector<unsigned char>> levels(1);
+    levels[0].assign(data, data + (size_t)width * height * 4);
+    stbi_image_free(data);
+
+    int levelWidth = width, levelHeight = height;
+    while ((levelWidth > 1 || levelHeight > 1) && levels.size() < (size_t)MAX_TEXTURE_LEVELS) {
+        std::vector<unsigned char> next;
+        downsample(levels.back(), levelWidth, levelHeight, next);
+        levels.push_back(std::move(next));
+        levelWidth = levelWidth > 1 ? levelWidth / 2 : 1;
+        levelHeight = levelHeight > 1 ? levelHeight / 2 : 1;
+    }
+
+    FileStamp source;
+    getFileStamp(imagePath, source);
+    hashFile(imagePath, source.hash);
+
+    std::vector<char> blob;
+    CookedTexture::serialize(levels, width, height, source, blob);
+    if (!writeFileAtomically(report.output, blob.data(), blob.size())) {
+        report.error = "falha ao gravar " + report.output;
+        report.ms = elapsedMs(start);
+        return false;
+    }
+
+    char details[128];
+    snprintf(details, sizeof(details), "%dx%d, %d niveis", width, height, (int)levels.size());
+    report.details = details;
+    report.cookedBytes = blob.size();
+    report.ok = true;
+    report.ms = elapsedMs(start);
+    return true;
+}
+
+void findMtlTextures(const std::string& mtlPath, std::vector<std::string>& textures)
+{
+    std::ifstream file(mtlPath);
+    if (!file.is_open())
+        return;
+
+    fs::path folder = fs::path(mtlPath).parent_path();
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string prefix;
+        iss >> prefix;
+        if (prefix.compare(0, 4, "map_") != 0)
+            continue;
+
+        // O nome pode ter espaços; é o resto da linha
+        std::string name;
+        std::getline(iss >> std::ws, name);
+        while (!name.empty() && (name.back() == '\r' || name.back() == ' ' || name.back() == '\t'))
+            name.pop_back();
+        if (!name.empty())
+            textures.push_back((folder / fs::path(name)).lexically_normal().string());
+    }
+}
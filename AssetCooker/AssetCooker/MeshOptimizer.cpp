@@ -0,0 +1,189 @@
+// Otimizações de ordem de índices e vértices usadas pelo AssetCooker
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+#include "AssetCooker.h"
+
+// Parâmetros sugeridos por Forsyth para um cache LRU simulado de 32 entradas
+static const int vertexCacheSize = 32;
+static const float cacheDecayPower = 1.5f;
+static const float lastTriangleScore = 0.75f;
+static const float valenceBoostScale = 2.0f;
+static const float valenceBoostPower = 0.5f;
+
+static float vertexScore(int cachePosition, int remainingTriangles)
+{
+    if (remainingTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // Os 3 vértices do último triângulo recebem uma pontuação fixa para não
+        // favorecer tiras longas de triângulos
+        if (cachePosition < 3)
+            score = lastTriangleScore;
+        else
+            score = std::pow(1.0f - (cachePosition - 3) / (float)(vertexCacheSize - 3), cacheDecayPower);
+    }
+
+    // Vértices com poucos triângulos restantes são terminados primeiro
+    score += valenceBoostScale * std::pow((float)remainingTriangles, -valenceBoostPower);
+    return score;
+}
+
+void optimizeVertexCache(unsigned int* indices, size_t nIndices, size_t nVertices)
+{
+    size_t nTriangles = nIndices / 3;
+    if (nTriangles < 2)
+        return;
+
+    // Lista de triângulos de cada vértice; os ainda não emitidos ficam no começo da lista
+    std::vector<int> remaining(nVertices, 0);
+    for (size_t i = 0; i < nTriangles * 3; i++)
+        remaining[indices[i]]++;
+
+    std::vector<size_t> firstTriangle(nVertices + 1, 0);
+    for (size_t v = 0; v < nVertices; v++)
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+
+    std::vector<int> adjacency(nTriangles * 3);
+    std::vector<int> filled(nVertices, 0);
+    for (size_t t = 0; t < nTriangles; t++)
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = indices[t * 3 + k];
+            adjacency[firstTriangle[v] + filled[v]++] = (int)t;
+        }
+
+    std::vector<int> cachePosition(nVertices, -1);
+    std::vector<float> score(nVertices);
+    for (size_t v = 0; v < nVertices; v++)
+        score[v] = vertexScore(-1, remaining[v]);
+
+    std::vector<float> triangleScore(nTriangles);
+    std::vector<char> emitted(nTriangles, 0);
+    int best = 0;
+    for (size_t t = 0; t < nTriangles; t++) {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+        if (triangleScore[t] > triangleScore[best])
+            best = (int)t;
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(nTriangles * 3);
+
+    int cache[vertexCacheSize + 3];
+    int cacheCount = 0;
+    size_t cursor = 0;
+
+    while (best >= 0) {
+        const unsigned int* tri = &indices[best * 3];
+        output.insert(output.end(), tri, tri + 3);
+        emitted[best] = 1;
+
+        // Tira o triângulo das listas dos seus vértices
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = tri[k];
+            int* list = &adjacency[firstTriangle[v]];
+            for (int i = 0; i < remaining[v]; i++)
+                if (list[i] == best) {
+                    list[i] = list[remaining[v] - 1];
+                    list[remaining[v] - 1] = best;
+                    break;
+                }
+            remaining[v]--;
+        }
+
+        // Os vértices do triângulo vão para o início do cache e empurram os demais
+        int newCache[vertexCacheSize + 3];
+        int newCount = 0;
+        for (int k = 0; k < 3; k++)
+            if (newCount == 0 || (newCache[0] != (int)tri[k] && (newCount < 2 || newCache[1] != (int)tri[k])))
+                newCache[newCount++] = (int)tri[k];
+        for (int i = 0; i < cacheCount; i++) {
+            int v = cache[i];
+            if (v != (int)tri[0] && v != (int)tri[1] && v != (int)tri[2])
+                newCache[newCount++] = v;
+        }
+
+        for (int i = 0; i < newCount; i++) {
+            int v = newCache[i];
+            cachePosition[v] = i < vertexCacheSize ? i : -1;
+            score[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+
+        // Só os triângulos de vértices que mudaram de posição precisam ser reavaliados
+        best = -1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < newCount; i++) {
+            int v = newCache[i];
+            const int* list = &adjacency[firstTriangle[v]];
+            for (int j = 0; j < remaining[v]; j++) {
+                int t = list[j];
+                const unsigned int* other = &indices[t * 3];
+                triangleScore[t] = score[other[0]] + score[other[1]] + score[other[2]];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        cacheCount = newCount < vertexCacheSize ? newCount : vertexCacheSize;
+        memcpy(cache, newCache, cacheCount * sizeof(int));
+
+        // Nenhum triângulo tocando o cache: continua do próximo ainda não emitido
+        if (best < 0) {
+            while (cursor < nTriangles && emitted[cursor])
+                cursor++;
+            if (cursor < nTriangles)
+                best = (int)cursor;
+        }
+    }
+
+    memcpy(indices, output.data(), output.size() * sizeof(unsigned int));
+}
+
+void optimizeVertexFetch(std::vector<float>& vertices, int floatsPerVertex, std::vector<unsigned int>& indices)
+{
+    size_t nVertices = vertices.size() / floatsPerVertex;
+    std::vector<unsigned int> remap(nVertices, ~0u);
+    std::vector<float> reordered;
+    reordered.reserve(vertices.size());
+
+    unsigned int next = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        unsigned int& newIndex = remap[indices[i]];
+        if (newIndex == ~0u) {
+            newIndex = next++;
+            const float* v = &vertices[(size_t)indices[i] * floatsPerVertex];
+            reordered.insert(reordered.end(), v, v + floatsPerVertex);
+        }
+        indices[i] = newIndex;
+    }
+
+    vertices.swap(reordered);
+}
+
+float computeAcmr(const unsigned int* indices, size_t nIndices, size_t nVertices, int cacheSize)
+{
+    if (nIndices < 3)
+        return 0.0f;
+
+    // Momento em que cada vértice entrou no cache FIFO
+    std::vector<size_t> insertedAt(nVertices, 0);
+    size_t clock = 0;
+    size_t misses = 0;
+
+    for (size_t i = 0; i < nIndices; i++) {
+        size_t& t = insertedAt[indices[i]];
+        if (t == 0 || clock - t >= (size_t)cacheSize) {
+            clock++;
+            t = clock;
+            misses++;
+        }
+    }
+
+    return misses / (float)(nIndices / 3);
+}
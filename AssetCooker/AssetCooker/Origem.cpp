@@ -0,0 +1,141 @@
+﻿/*
+*   AssetCooker
+*
+*   Percorre a pasta de modelos e gera, ao lado de cada arquivo de origem, os dados
+*   prontos para a GPU que os módulos carregam na inicialização:
+*     modelo.obj  -> modelo.meshbin     (índices otimizados, atributos quantizados)
+*     imagem.png  -> imagem.png.texbin  (RGBA8 com mipmaps)
+*   Só refaz o que mudou desde o último cozimento e processa vários arquivos em paralelo.
+*
+*   Uso: AssetCooker [pasta] [--force] [--threads N]
+*     pasta padrão: ../../3D_Models
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+
+#include "AssetCooker.h"
+#include "ThreadPool.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct CookJob
+{
+    string path;
+    bool isTexture;
+};
+
+static string lowerExtension(const fs::path& path)
+{
+    string extension = path.extension().string();
+    transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return extension;
+}
+
+// OBJs e texturas citadas pelos MTLs da pasta (cada textura uma única vez)
+static void findJobs(const fs::path& root, vector<CookJob>& jobs)
+{
+    vector<string> textures;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file())
+            continue;
+        string extension = lowerExtension(entry.path());
+        if (extension == ".obj")
+            jobs.push_back({ entry.path().string(), false });
+        else if (extension == ".mtl")
+            findMtlTextures(entry.path().string(), textures);
+    }
+
+    set<string> seen;
+    for (const string& texture : textures) {
+        error_code error;
+        fs::path canonical = fs::weakly_canonical(texture, error);
+        string key = error ? texture : canonical.string();
+        if (seen.insert(key).second)
+            jobs.push_back({ texture, true });
+    }
+
+    sort(jobs.begin(), jobs.end(), [](const CookJob& a, const CookJob& b) {
+        return a.isTexture != b.isTexture ? !a.isTexture : a.path < b.path;
+    });
+}
+
+static void printUsage()
+{
+    cout << "Uso: AssetCooker [pasta] [--force] [--threads N]" << endl;
+}
+
+int main(int argc, char** argv)
+{
+    string root = "../../3D_Models";
+    bool force = false;
+    int nThreads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--force")
+            force = true;
+        else if (arg == "--threads" && i + 1 < argc)
+            nThreads = atoi(argv[++i]);
+        else if (arg[0] == '-') {
+            printUsage();
+            return 1;
+        }
+        else
+            root = arg;
+    }
+
+    if (!fs::is_directory(root)) {
+        cout << "Pasta nao encontrada: " << root << endl;
+        return 1;
+    }
+
+    vector<CookJob> jobs;
+    findJobs(root, jobs);
+
+    ThreadPool pool(nThreads);
+    vector<CookReport> reports(jobs.size());
+
+    auto start = chrono::high_resolution_clock::now();
+    pool.parallelFor((int)jobs.size(), [&](int i) {
+        if (jobs[i].isTexture)
+            cookTexture(jobs[i].path, force, reports[i]);
+        else
+            cookMesh(jobs[i].path, force, reports[i]);
+    });
+    double totalMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+    // Relatório na ordem dos arquivos, depois que todas as threads terminaram
+    int nCooked = 0, nUpToDate = 0, nFailed = 0;
+    uint64_t sourceBytes = 0, cookedBytes = 0;
+    for (const CookReport& r : reports) {
+        string name = fs::relative(r.source, root).string();
+        if (!r.ok) {
+            printf("  FALHA     %-40s %s\n", name.c_str(), r.error.c_str());
+            nFailed++;
+            continue;
+        }
+
+        printf("  %-9s %-40s %9.1f ms  %8.1f KB -> %8.1f KB  %s\n", r.upToDate ? "atual" : "cozido", name.c_str(), r.ms,
+            r.sourceBytes / 1024.0, r.cookedBytes / 1024.0, r.details.c_str());
+        if (r.upToDate)
+            nUpToDate++;
+        else
+            nCooked++;
+        sourceBytes += r.sourceBytes;
+        cookedBytes += r.cookedBytes;
+    }
+
+    printf("%d cozidos, %d ja atualizados, %d falhas em %.1f ms (%d threads); %.1f MB de origem -> %.1f MB cozidos\n",
+        nCooked, nUpToDate, nFailed, totalMs, pool.getNbThreads(), sourceBytes / (1024.0 * 1024.0), cookedBytes / (1024.0 * 1024.0));
+
+    return nFailed > 0 ? 1 : 0;
+}
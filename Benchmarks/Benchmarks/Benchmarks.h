@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chrono>
+
+// Cada benchmark recebe os argumentos restantes da linha de comando
+int runObjBenchmark(int argc, char** argv);
+int runUniformBenchmark(int argc, char** argv);
+int runCurveBenchmark(int argc, char** argv);
+
+// Cronômetro simples em milissegundos
+class Timer
+{
+public:
+	Timer() { reset(); }
+	void reset() { start = std::chrono::high_resolution_clock::now(); }
+	double elapsedMs() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point start;
+};
@@ -0,0 +1,153 @@
+// Compara a geração de pontos de curvas do HelloCurves original (G * M * T por ponto, t
+// acumulado em float e push_back) com os coeficientes por segmento de CurveEval, no laço
+// escalar e no lote SSE, para as bases de Bézier, Hermite e Catmull-Rom.
+
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "Benchmarks.h"
+#include "CurveEval.h"
+
+using namespace std;
+
+struct CurveBasis
+{
+    const char* name;
+    glm::mat4 M;
+    bool hermite; // G leva P0, P3 e as tangentes em vez dos 4 pontos
+};
+
+// Mesmas matrizes de base das classes do HelloCurves
+static vector<CurveBasis> curveBases()
+{
+    vector<CurveBasis> bases;
+    CurveBasis bezier = { "Bezier", glm::mat4(-1, 3, -3, 1, 3, -6, 3, 0, -3, 3, 0, 0, 1, 0, 0, 0), false };
+    CurveBasis hermite = { "Hermite", glm::mat4(2, -2, 1, 1, -3, 3, -2, -1, 0, 0, 1, 0, 1, 0, 0, 0), true };
+    CurveBasis catmull = { "CatmullRom", glm::mat4(-1, 3, -3, 1, 2, -5, 4, -1, -1, 0, 1, 0, 0, 2, 0, 0) * 0.5f, false };
+    bases.push_back(bezier);
+    bases.push_back(hermite);
+    bases.push_back(catmull);
+    return bases;
+}
+
+static glm::mat4x3 segmentGeometry(const CurveBasis& basis, const vector<glm::vec3>& controlPoints, int segment)
+{
+    int i = segment * 3;
+    if (basis.hermite)
+        return glm::mat4x3(controlPoints[i], controlPoints[i + 3], controlPoints[i + 1] - controlPoints[i],
+            controlPoints[i + 2] - controlPoints[i + 3]);
+    return glm::mat4x3(controlPoints[i], controlPoints[i + 1], controlPoints[i + 2], controlPoints[i + 3]);
+}
+
+// Cópia do laço de generateCurve antes dos coeficientes por segmento
+static void legacyGenerateCurve(const CurveBasis& basis, const vector<glm::vec3>& controlPoints, int pointsPerSegment,
+    vector<glm::vec3>& curvePoints)
+{
+    float step = 1.0 / (float)pointsPerSegment;
+    int nControlPoints = controlPoints.size();
+    for (int i = 0; i < nControlPoints - 3; i += 3)
+    {
+        for (float t = 0.0; t <= 1.0; t += step)
+        {
+            glm::vec4 T(t * t * t, t * t, t, 1);
+            glm::mat4x3 G = segmentGeometry(basis, controlPoints, i / 3);
+            glm::vec3 p = G * basis.M * T;
+            curvePoints.push_back(p);
+        }
+    }
+}
+
+// Os dois caminhos novos escrevem em curvePoints já com nSegments * (pointsPerSegment + 1) pontos
+static void scalarGenerateCurve(const CurveBasis& basis, const vector<glm::vec3>& controlPoints, int nSegments,
+    int pointsPerSegment, vector<glm::vec3>& curvePoints)
+{
+    int n = pointsPerSegment + 1;
+    for (int s = 0; s < nSegments; s++)
+    {
+        glm::mat4x3 coefficients = cubicCoefficients(segmentGeometry(basis, controlPoints, s), basis.M);
+        glm::vec3* out = &curvePoints[s * n];
+        for (int k = 0; k < n; k++)
+            out[k] = evaluateCubic(coefficients, k / (float)pointsPerSegment);
+    }
+}
+
+static void batchGenerateCurve(const CurveBasis& basis, const vector<glm::vec3>& controlPoints, int nSegments,
+    int pointsPerSegment, vector<glm::vec3>& curvePoints)
+{
+    int n = pointsPerSegment + 1;
+    for (int s = 0; s < nSegments; s++)
+        evaluateCubicUniform(cubicCoefficients(segmentGeometry(basis, controlPoints, s), basis.M), pointsPerSegment, &curvePoints[s * n]);
+}
+
+// Melhor de 'repeats' execuções, em milhões de pontos por segundo; reset roda fora do tempo medido
+template <typename Reset, typename Function>
+static double measure(Reset reset, Function generate, const vector<glm::vec3>& curvePoints, int repeats)
+{
+    double bestMs = 1e30;
+    for (int r = 0; r < repeats; r++)
+    {
+        reset();
+        Timer timer;
+        generate();
+        bestMs = std::min(bestMs, timer.elapsedMs());
+    }
+    return curvePoints.size() / (bestMs * 1000.0);
+}
+
+int runCurveBenchmark(int argc, char** argv)
+{
+    int nSegments = argc > 0 ? atoi(argv[0]) : 1000;
+    int pointsPerSegment = argc > 1 ? atoi(argv[1]) : 1000;
+    int repeats = 5;
+    if (nSegments <= 0 || pointsPerSegment <= 0) {
+        cout << "Uso: curves [segmentos] [pontos por segmento]" << endl;
+        return 1;
+    }
+
+    mt19937 generator(42);
+    uniform_real_distribution<float> distribution(-0.9f, 0.9f);
+    vector<glm::vec3> controlPoints(nSegments * 3 + 1);
+    for (glm::vec3& p : controlPoints)
+        p = glm::vec3(distribution(generator), distribution(generator), 0.0f);
+
+    printf("%d segmentos, %d pontos por segmento\n", nSegments, pointsPerSegment);
+    for (const CurveBasis& basis : curveBases())
+    {
+        // O original parte de um vetor vazio e cresce com push_back, como antes; os novos
+        // avaliam num buffer alocado uma vez só, fora da medição
+        vector<glm::vec3> legacy;
+        vector<glm::vec3> scalar(nSegments * (pointsPerSegment + 1)), batch(scalar.size());
+        double legacyRate = measure([&]() { vector<glm::vec3>().swap(legacy); },
+            [&]() { legacyGenerateCurve(basis, controlPoints, pointsPerSegment, legacy); }, legacy, repeats);
+        double scalarRate = measure([]() {},
+            [&]() { scalarGenerateCurve(basis, controlPoints, nSegments, pointsPerSegment, scalar); }, scalar, repeats);
+        double batchRate = measure([]() {},
+            [&]() { batchGenerateCurve(basis, controlPoints, nSegments, pointsPerSegment, batch); }, batch, repeats);
+
+        // O lote tem que repetir o escalar bit a bit; o original difere no arredondamento
+        // (e pode ter um ponto a mais ou a menos por segmento, pelo t acumulado)
+        bool identical = scalar.size() == batch.size() && std::equal(scalar.begin(), scalar.end(), batch.begin());
+        float maxError = 0.0f;
+        for (int s = 0; s < nSegments; s++)
+            for (int k = 0; k <= pointsPerSegment; k += std::max(pointsPerSegment / 10, 1))
+            {
+                float t = k / (float)pointsPerSegment;
+                glm::vec3 reference = segmentGeometry(basis, controlPoints, s) * basis.M * glm::vec4(t * t * t, t * t, t, 1);
+                maxError = std::max(maxError, glm::length(reference - batch[s * (pointsPerSegment + 1) + k]));
+            }
+
+        printf("%s\n", basis.name);
+        printf("  original (G * M * T): %8.1f Mpontos/s  (%zu pontos)\n", legacyRate, legacy.size());
+        printf("  coeficientes:         %8.1f Mpontos/s  %.1fx\n", scalarRate, scalarRate / legacyRate);
+        printf("  lote SSE:             %8.1f Mpontos/s  %.1fx  (%zu pontos)\n", batchRate, batchRate / legacyRate, batch.size());
+        printf("  lote %s do escalar, erro maximo %g em relacao a G * M * T\n", identical ? "identico" : "DIFERENTE", maxError);
+    }
+    return 0;
+}
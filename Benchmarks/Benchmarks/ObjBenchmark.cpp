@@ -0,0 +1,216 @@
+// Compara o leitor OBJ mapeado em memória (ObjLoader), serial e paralelo, com o
+// laço getline/istringstream usado originalmente em readFromObj (Módulos 3 a 5),
+// em arquivos OBJ sintéticos com milhões de triângulos.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "Benchmarks.h"
+#include "ObjLoader.h"
+#include "ThreadPool.h"
+#include "MeshCache.h"
+
+using namespace std;
+
+// Cópia fiel do readFromObj dos módulos, usada como referência
+static bool legacyReadFromObj(const string& path, vector<float>& totalVertices)
+{
+    std::ifstream file(path);
+
+    if (!file.is_open()) {
+        std::cout << "Failed to open the file." << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> tempVertices;
+    std::vector<glm::vec2> tempTextures;
+    std::vector<glm::vec3> tempNormals;
+
+    std::string line;
+
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            std::istringstream iss(line);
+            std::string prefix;
+            iss >> prefix;
+
+            if (prefix == "v") {
+                glm::vec3 values;
+                iss >> values.x >> values.y >> values.z;
+                tempVertices.push_back(values);
+            }
+            else if (prefix == "vt") {
+                glm::vec2 values;
+                iss >> values.x >> values.y;
+                tempTextures.push_back(values);
+            }
+            else if (prefix == "vn") {
+                glm::vec3 values;
+                iss >> values.x >> values.y >> values.z;
+                tempNormals.push_back(values);
+            }
+            else if (prefix == "f") {
+                unsigned int vertexIndex[3], textIndex[3], normalIndex[3];
+                char slash;
+
+                for (int i = 0; i < 3; ++i) {
+                    iss >> vertexIndex[i] >> slash >> textIndex[i] >> slash >> normalIndex[i];
+
+                    if (vertexIndex[i] > tempVertices.size() || textIndex[i] > tempTextures.size() || normalIndex[i] > tempNormals.size()) {
+                        std::cerr << "Index out of bounds in OBJ file at line: " << line << std::endl;
+                        return false;
+                    }
+
+                    glm::vec3 vertex = tempVertices[vertexIndex[i] - 1];
+                    glm::vec3 normal = tempNormals[normalIndex[i] - 1];
+                    glm::vec2 texture = tempTextures[textIndex[i] - 1];
+
+                    totalVertices.insert(totalVertices.end(), { vertex.x, vertex.y, vertex.z });
+                    totalVertices.insert(totalVertices.end(), { texture.x, texture.y });
+                    totalVertices.insert(totalVertices.end(), { normal.x, normal.y, normal.z });
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// Gera uma malha em grade (ondulada) com aproximadamente nTriangles triângulos
+static bool writeSyntheticObj(const string& path, int nTriangles)
+{
+    int n = (int)std::sqrt(nTriangles / 2.0) + 1; // vértices por lado
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+
+    fprintf(f, "# OBJ sintetico: grade %dx%d\n", n, n);
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+            float x = i / (float)(n - 1) * 2.0f - 1.0f;
+            float z = j / (float)(n - 1) * 2.0f - 1.0f;
+            fprintf(f, "v %f %f %f\n", x, 0.1f * std::sin(x * 10.0f) * std::cos(z * 10.0f), z);
+        }
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+            fprintf(f, "vt %f %f\n", i / (float)(n - 1), j / (float)(n - 1));
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+            fprintf(f, "vn %f %f %f\n", 0.0f, 1.0f, 0.0f);
+
+    for (int j = 0; j < n - 1; j++)
+        for (int i = 0; i < n - 1; i++)
+        {
+            int a = j * n + i + 1;
+            int b = a + 1;
+            int c = a + n;
+            int d = c + 1;
+            fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, c, c, c, b, b, b);
+            fprintf(f, "f %d/%d/%d %d/%d/%d %d/%d/%d\n", b, b, b, c, c, c, d, d, d);
+        }
+
+    fclose(f);
+    return true;
+}
+
+static bool sameObjData(const ObjData& a, const ObjData& b)
+{
+    return a.mtlFileName == b.mtlFileName
+        && a.positions.size() == b.positions.size() && a.texCoords.size() == b.texCoords.size()
+        && a.normals.size() == b.normals.size() && a.corners.size() == b.corners.size()
+        && memcmp(a.positions.data(), b.positions.data(), a.positions.size() * sizeof(glm::vec3)) == 0
+        && memcmp(a.texCoords.data(), b.texCoords.data(), a.texCoords.size() * sizeof(glm::vec2)) == 0
+        && memcmp(a.normals.data(), b.normals.data(), a.normals.size() * sizeof(glm::vec3)) == 0
+        && memcmp(a.corners.data(), b.corners.data(), a.corners.size() * sizeof(ObjIndex)) == 0;
+}
+
+static long long fileSize(const string& path)
+{
+    ifstream file(path, ios::binary | ios::ate);
+    return file.is_open() ? (long long)file.tellg() : 0;
+}
+
+int runObjBenchmark(int argc, char** argv)
+{
+    vector<int> sizes;
+    for (int i = 0; i < argc; i++)
+        sizes.push_back(atoi(argv[i]));
+    if (sizes.empty())
+        sizes = { 1000000, 2000000, 4000000 };
+
+    for (int nTriangles : sizes)
+    {
+        string path = "synthetic_" + to_string(nTriangles) + ".obj";
+        if (!writeSyntheticObj(path, nTriangles)) {
+            cout << "Falha ao gerar " << path << endl;
+            return 1;
+        }
+        double megabytes = fileSize(path) / (1024.0 * 1024.0);
+
+        Timer timer;
+        vector<float> legacyVertices;
+        legacyReadFromObj(path, legacyVertices);
+        double legacyMs = timer.elapsedMs();
+
+        timer.reset();
+        ObjData obj;
+        vector<float> vertices;
+        loadObj(path, obj);
+        expandVertices(obj, vertices);
+        double mappedMs = timer.elapsedMs();
+
+        timer.reset();
+        ObjData parallelObj;
+        loadObj(path, parallelObj, 0);
+        double parallelMs = timer.elapsedMs();
+
+        // Primeira carga grava o .meshbin; a segunda só mapeia o arquivo
+        string cachePath = MeshCache::getCachePath(path);
+        remove(cachePath.c_str());
+        timer.reset();
+        MeshCache cache;
+        cache.load(path);
+        double cacheWriteMs = timer.elapsedMs();
+
+        timer.reset();
+        cache.load(path);
+        double cacheHitMs = timer.elapsedMs();
+        bool cacheHit = cache.wasCacheHit();
+        cache.clear();
+
+        // Os dois caminhos devem produzir o mesmo buffer de vértices
+        float maxError = 0.0f;
+        bool sameSize = legacyVertices.size() == vertices.size();
+        if (sameSize)
+            for (size_t i = 0; i < vertices.size(); i++)
+                maxError = std::max(maxError, std::fabs(vertices[i] - legacyVertices[i]));
+
+        printf("%d triangulos (%.1f MB)\n", obj.getNbTriangles(), megabytes);
+        printf("  istringstream: %9.1f ms  (%7.1f MB/s)\n", legacyMs, megabytes / (legacyMs / 1000.0));
+        printf("  mapeado:       %9.1f ms  (%7.1f MB/s)  %.1fx\n", mappedMs, megabytes / (mappedMs / 1000.0), legacyMs / mappedMs);
+        printf("  paralelo (%2d): %9.1f ms  (%7.1f MB/s)  %.1fx  (so leitura, sem expandir)\n", ThreadPool::shared().getNbThreads(),
+            parallelMs, megabytes / (parallelMs / 1000.0), legacyMs / parallelMs);
+        // Só é idêntica se todos os floats coincidirem; com o mesmo tamanho e erro > 0 o
+        // parser próprio apenas arredondou diferente de istringstream
+        const char* outputStatus = !sameSize ? "DIFERENTE" : maxError == 0.0f ? "identica" : "com arredondamento diferente";
+        printf("  saida %s (erro maximo %g), paralelo %s do serial\n", outputStatus, maxError,
+            sameObjData(obj, parallelObj) ? "identico" : "DIFERENTE");
+        printf("  .meshbin: gravar %.1f ms, carregar %.2f ms (%s)\n", cacheWriteMs, cacheHitMs, cacheHit ? "cache usado" : "CACHE IGNORADO");
+
+        remove(path.c_str());
+        remove(cachePath.c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,41 @@
+/*
+*   Benchmarks dos utilitários em Common/
+*
+*   Uso: Benchmarks <nome> [argumentos]
+*     obj [triangulos...]   leitor OBJ mapeado x leitura com istringstream, e cache .meshbin
+*     uniforms [chamadas] [pasta dos shaders]   custo por chamada de glUniform com e sem localização em cache
+*     curves [segmentos] [pontos por segmento]   pontos de curvas cúbicas: G * M * T por ponto x coeficientes, escalar e SSE
+*/
+
+#include <iostream>
+#include <string>
+#include "Benchmarks.h"
+
+using namespace std;
+
+static void printUsage()
+{
+    cout << "Uso: Benchmarks <nome> [argumentos]" << endl;
+    cout << "  obj [triangulos...]" << endl;
+    cout << "  uniforms [chamadas] [pasta dos shaders]" << endl;
+    cout << "  curves [segmentos] [pontos por segmento]" << endl;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    string name = argv[1];
+    if (name == "obj")
+        return runObjBenchmark(argc - 2, argv + 2);
+    if (name == "uniforms")
+        return runUniformBenchmark(argc - 2, argv + 2);
+    if (name == "curves")
+        return runCurveBenchmark(argc - 2, argv + 2);
+
+    printUsage();
+    return 1;
+}
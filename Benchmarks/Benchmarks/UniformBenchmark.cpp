@@ -0,0 +1,96 @@
+// Custo por chamada de atualizar um uniform mat4: glGetUniformLocation a cada chamada
+// (como os set* do Shader faziam), a tabela de nomes do Shader, e um UniformMat4 já
+// resolvido, com valor novo e com valor repetido. Roda em uma janela GLFW oculta.
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLFW
+#include <GLFW/glfw3.h>
+
+#include "Benchmarks.h"
+#include "Shader.h"
+
+using namespace std;
+
+int runUniformBenchmark(int argc, char** argv)
+{
+    int nCalls = argc > 0 ? atoi(argv[0]) : 1000000;
+    string shaderDir = argc > 1 ? argv[1] : "../../Modulo5/shaders/";
+
+    if (!glfwInit()) {
+        cout << "Falha ao inicializar a GLFW" << endl;
+        return 1;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "Benchmarks", nullptr, nullptr);
+    if (!window) {
+        cout << "Falha ao criar a janela" << endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        cout << "Falha ao inicializar a GLAD" << endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    Shader shader((shaderDir + "sprite.vs").c_str(), (shaderDir + "sprite.fs").c_str());
+    glUseProgram(shader.ID);
+    UniformMat4 model = shader.uniform("model");
+    if (!model.isValid()) {
+        cout << "O shader nao tem o uniform model (pasta " << shaderDir << ")" << endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    // Cada chamada envia uma matriz diferente, menos no último caso
+    float matrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    Timer timer;
+
+    glFinish();
+    timer.reset();
+    for (int i = 0; i < nCalls; i++) {
+        matrix[12] = (float)i;
+        glUniformMatrix4fv(glGetUniformLocation(shader.ID, std::string("model").c_str()), 1, GL_FALSE, matrix);
+    }
+    glFinish();
+    double lookupMs = timer.elapsedMs();
+
+    timer.reset();
+    for (int i = 0; i < nCalls; i++) {
+        matrix[12] = (float)-i;
+        shader.setMat4("model", matrix);
+    }
+    glFinish();
+    double tableMs = timer.elapsedMs();
+
+    timer.reset();
+    for (int i = 0; i < nCalls; i++) {
+        matrix[12] = (float)i;
+        model.set(matrix);
+    }
+    glFinish();
+    double handleMs = timer.elapsedMs();
+
+    timer.reset();
+    for (int i = 0; i < nCalls; i++)
+        model.set(matrix);
+    glFinish();
+    double repeatedMs = timer.elapsedMs();
+
+    printf("%d chamadas de mat4 (%s)\n", nCalls, (const char*)glGetString(GL_RENDERER));
+    printf("  glGetUniformLocation + glUniform: %7.1f ns/chamada\n", lookupMs * 1e6 / nCalls);
+    printf("  Shader::setMat4 (tabela):         %7.1f ns/chamada  %.1fx\n", tableMs * 1e6 / nCalls, lookupMs / tableMs);
+    printf("  UniformMat4, valor novo:          %7.1f ns/chamada  %.1fx\n", handleMs * 1e6 / nCalls, lookupMs / handleMs);
+    printf("  UniformMat4, valor repetido:      %7.1f ns/chamada  %.1fx\n", repeatedMs * 1e6 / nCalls, lookupMs / repeatedMs);
+
+    glfwTerminate();
+    return 0;
+}
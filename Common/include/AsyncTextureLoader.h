@@ -0,0 +1,98 @@
+// Carregamento de texturas em segundo plano
+// As imagens são decodificadas (stb_image, ou cópia do .texbin cozido) nas threads do
+// ThreadPool e enviadas à GPU pela thread do contexto OpenGL em update(), através de um
+// pixel unpack buffer e com um limite de bytes por quadro. Enquanto a imagem não chega
+// inteira, a textura mostra uma cor de espera: o nível 0 é preenchido aos poucos e
+// GL_TEXTURE_BASE_LEVEL aponta para um nível 1x1 com essa cor até o fim do envio.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <set>
+#include <cstdint>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "ThreadPool.h"
+
+class AsyncTextureLoader
+{
+public:
+	AsyncTextureLoader();
+
+	// Deve ser chamado com o contexto OpenGL ativo
+	void initialize(size_t bytesPerFrame = 4 * 1024 * 1024, ThreadPool* pool = nullptr);
+	// Apaga o PBO e esquece os envios em andamento; decodificações que terminarem depois são
+	// descartadas. As texturas continuam de quem as pediu. Chamar antes de glfwTerminate
+	void release();
+
+	// Cria a textura já com a cor de espera e agenda a leitura; o ID pode ser usado imediatamente
+	GLuint load(const std::string& path);
+
+	// Envia à GPU até bytesPerFrame bytes das imagens já decodificadas; retorna quantas ficaram prontas
+	int update();
+
+	// Apaga a textura, mesmo que ainda esteja sendo lida ou enviada
+	void unload(GLuint textureID);
+
+	// Texturas agendadas que ainda não terminaram de ser enviadas
+	int getNbPending() const { return nPending; }
+	bool isPending(GLuint textureID) const { return pending.count(textureID) > 0; }
+	size_t getUploadedBytes() const { return uploadedBytes; }
+
+	// Memória de vídeo ocupada pela textura com todos os níveis (0 enquanto não se sabe o tamanho)
+	size_t getTextureBytes(GLuint textureID) const;
+	// Hash do conteúdo da imagem original, calculado na thread que a decodificou (0 até lá)
+	uint64_t getContentHash(GLuint textureID) const;
+
+	// Cor mostrada enquanto a textura não está pronta (RGBA)
+	void setPlaceholderColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255);
+
+	// Imagem decodificada e o progresso do seu envio
+	struct Job
+	{
+		GLuint textureID;
+		std::string path;
+		bool failed;
+		bool hasMipmaps; // veio do .texbin com todos os níveis
+		uint64_t contentHash;
+		std::vector<std::vector<unsigned char>> levels;
+		std::vector<int> widths;
+		std::vector<int> heights;
+		int level; // nível e linha do próximo trecho a enviar
+		int row;
+	};
+
+	// Fila compartilhada com as tarefas de decodificação, que podem terminar depois do loader
+	struct DecodedQueue
+	{
+		std::mutex mutex;
+		std::deque<std::unique_ptr<Job>> jobs;
+	};
+
+private:
+	AsyncTextureLoader(const AsyncTextureLoader&);
+	AsyncTextureLoader& operator=(const AsyncTextureLoader&);
+
+	void beginUpload(Job& job);
+	void finishUpload(Job& job);
+
+	ThreadPool* pool;
+	std::shared_ptr<DecodedQueue> decoded;
+	std::deque<std::unique_ptr<Job>> uploading;
+	std::set<GLuint> pending;
+	std::map<GLuint, size_t> textureBytes;
+	std::map<GLuint, uint64_t> contentHashes;
+
+	GLuint pbo;
+	size_t bytesPerFrame;
+	size_t uploadedBytes;
+	int nPending;
+	unsigned char placeholder[4];
+};
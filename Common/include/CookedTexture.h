@@ -0,0 +1,56 @@
+// Textura cozida (.texbin), gerada pelo AssetCooker ao lado da imagem original
+// Guarda a cadeia completa de mipmaps em RGBA8, pronta para glTexImage2D, e é
+// lida mapeando o arquivo em memória, sem decodificar PNG/JPG na inicialização.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "MappedFile.h"
+
+const int MAX_TEXTURE_LEVELS = 16;
+
+struct CookedTextureHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t nLevels;
+	FileStamp source; // identificação da imagem que gerou o arquivo
+	uint32_t width;   // tamanho do nível 0
+	uint32_t height;
+	uint64_t levelOffsets[MAX_TEXTURE_LEVELS];
+	uint64_t fileSize;
+};
+
+class CookedTexture
+{
+public:
+	CookedTexture();
+
+	// Mapeia o .texbin da imagem; falha se não existir ou se a imagem mudou depois de cozida
+	bool load(const std::string& imagePath);
+	void clear();
+
+	int getNbLevels() const { return header ? (int)header->nLevels : 0; }
+	int getWidth(int level = 0) const;
+	int getHeight(int level = 0) const;
+	const unsigned char* getLevel(int level) const { return (const unsigned char*)file.data() + header->levelOffsets[level]; }
+
+	// "Terra.jpg" -> "Terra.jpg.texbin" (imagens com o mesmo nome e extensões diferentes não colidem)
+	static std::string getCachePath(const std::string& imagePath);
+
+	static bool isUpToDate(const std::string& imagePath);
+
+	// levels[i] tem max(width >> i, 1) x max(height >> i, 1) pixels RGBA
+	static void serialize(const std::vector<std::vector<unsigned char>>& levels, int width, int height,
+		const FileStamp& source, std::vector<char>& blob);
+
+private:
+	CookedTexture(const CookedTexture&);
+	CookedTexture& operator=(const CookedTexture&);
+
+	MappedFile file;
+	const CookedTextureHeader* header;
+};
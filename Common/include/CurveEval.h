@@ -0,0 +1,33 @@
+// Avaliação em lote de segmentos de curvas cúbicas
+// Um segmento de Bézier, Hermite ou Catmull-Rom é p(t) = G * M * T; G * M não depende de t,
+// então é calculado uma vez por segmento e vira os coeficientes do polinômio
+// p(t) = a t³ + b t² + c t + d (as colunas 0 a 3 da matriz). Cada ponto sai pelo método de
+// Horner, ((a t + b) t + c) t + d, e com SSE quatro valores de t são avaliados de uma vez:
+// x, y e z de quatro pontos em registradores separados (estrutura de arrays), entrelaçados
+// só na escrita, direto no vetor de saída já alocado.
+
+#pragma once
+
+//GLM
+#include <glm/glm.hpp>
+
+// Coeficientes (a, b, c, d) do segmento com matriz de geometria G e matriz de base M
+inline glm::mat4x3 cubicCoefficients(const glm::mat4x3& G, const glm::mat4& M) { return G * M; }
+
+// Um ponto; mesma aritmética do lote, então os resultados são iguais
+inline glm::vec3 evaluateCubic(const glm::mat4x3& coefficients, float t)
+{
+	return ((coefficients[0] * t + coefficients[1]) * t + coefficients[2]) * t + coefficients[3];
+}
+
+// Derivada p'(t) = 3a t² + 2b t + c (a tangente, sem normalizar)
+inline glm::vec3 evaluateCubicDerivative(const glm::mat4x3& coefficients, float t)
+{
+	return (coefficients[0] * (3.0f * t) + coefficients[1] * 2.0f) * t + coefficients[2];
+}
+
+// n pontos nos valores de t dados
+void evaluateCubic(const glm::mat4x3& coefficients, const float* t, int n, glm::vec3* out);
+
+// nSteps + 1 pontos com t = k / nSteps, de t = 0 a t = 1 exatos
+void evaluateCubicUniform(const glm::mat4x3& coefficients, int nSteps, glm::vec3* out);
@@ -0,0 +1,78 @@
+// Desenho imediato de depuração: linhas, pontos, caixas, volumes de visualização e nós de BVH
+// As chamadas só acumulam vértices (posição e cor RGBA8, 16 bytes) durante o quadro; flush
+// copia tudo para um StreamBuffer e desenha com duas chamadas, uma de GL_LINES e uma de
+// GL_POINTS. Os vetores são reaproveitados de um quadro para o outro, então depois dos
+// primeiros quadros nada é alocado, nem na CPU nem na GPU.
+
+#pragma once
+
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include "InstanceBVH.h"
+
+struct DebugVertex
+{
+	glm::vec3 position;
+	GLuint color; // RGBA8, r no byte mais baixo
+};
+
+class DebugDraw
+{
+public:
+	DebugDraw();
+	~DebugDraw();
+
+	// Contexto OpenGL ativo; maxVertices: vértices por quadro (o que passar é descartado e contado)
+	void initialize(int maxVertices = 128 * 1024);
+	// Apaga shader, VAO e buffer; chamar antes de glfwTerminate, com o contexto ainda ativo
+	void release();
+
+	void line(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color);
+	// Segmentos entre pontos consecutivos (o polígono de controle de uma curva, por exemplo)
+	void lineStrip(const glm::vec3* points, int n, const glm::vec4& color);
+	void point(const glm::vec3& p, const glm::vec4& color);
+	// Três segmentos cruzados em p, para marcar posições (luzes, alvos) de qualquer ângulo
+	void cross(const glm::vec3& p, float size, const glm::vec4& color);
+	// Arestas de uma caixa alinhada aos eixos
+	void box(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec4& color);
+	// Arestas do volume de visualização de uma câmera (os cantos do cubo [-1, 1] levados de volta ao mundo)
+	void frustum(const glm::mat4& viewProjection, const glm::vec4& color);
+	// Caixas dos nós até maxDepth (-1: todos); as folhas usam leafColor
+	void bvh(const InstanceBVH& bvh, const glm::vec4& color, const glm::vec4& leafColor, int maxDepth = -1);
+
+	// Desenha o que foi acumulado com a câmera dada e esvazia as listas; uma vez por quadro.
+	// Teste de profundidade, largura das linhas e tamanho dos pontos ficam como estiverem;
+	// o programa e o VAO atuais são restaurados
+	void flush(const glm::mat4& viewProjection);
+
+	int getNbLines() const { return (int)lines.size() / 2; }
+	int getNbPoints() const { return (int)points.size(); }
+	// Vértices descartados no último flush por falta de espaço
+	int getNbDropped() const { return nDropped; }
+	const StreamBuffer& getStream() const { return stream; }
+
+private:
+	DebugDraw(const DebugDraw&);
+	DebugDraw& operator=(const DebugDraw&);
+
+	static GLuint packColor(const glm::vec4& color);
+	void boxEdges(const glm::vec3* corners, GLuint color);
+
+	Shader* shader;
+	GLint viewProjectionLocation;
+	GLuint VAO;
+	StreamBuffer stream;
+	int maxVertices;
+	std::vector<DebugVertex> lines; // pares de vértices
+	std::vector<DebugVertex> points;
+	std::vector<int> stack;         // percurso da BVH
+	int nDropped;
+};
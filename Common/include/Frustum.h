@@ -0,0 +1,93 @@
+// Recorte pelo volume de visualização (frustum culling)
+// Os seis planos são extraídos de projection * view (método de Gribb e Hartmann) e
+// normalizados, com a normal apontando para dentro. As caixas de um quadro ficam numa
+// BoxList em estrutura de arrays (centro e meia extensão em espaço de mundo), e cull
+// testa quatro caixas por instrução com SSE: a caixa está fora se, para algum plano,
+// dot(n, centro) + d < -(|n.x| ext.x + |n.y| ext.y + |n.z| ext.z).
+// O teste é conservador: uma caixa perto de um canto do frustum pode passar sem aparecer.
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+enum FrustumPlane
+{
+	FRUSTUM_LEFT = 0,
+	FRUSTUM_RIGHT,
+	FRUSTUM_BOTTOM,
+	FRUSTUM_TOP,
+	FRUSTUM_NEAR,
+	FRUSTUM_FAR,
+	FRUSTUM_NB_PLANES
+};
+
+// Resultado de Frustum::classifyBox
+enum FrustumTest
+{
+	FRUSTUM_OUTSIDE = 0,
+	FRUSTUM_INTERSECTS,
+	FRUSTUM_INSIDE
+};
+
+// Caixa alinhada aos eixos que envolve a caixa local transformada por model
+void transformBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model,
+	glm::vec3& worldMin, glm::vec3& worldMax);
+
+// Caixas alinhadas aos eixos, uma coordenada por array; os arrays crescem de 4 em 4
+class BoxList
+{
+public:
+	BoxList();
+
+	void clear() { nBoxes = 0; }
+	void reserve(int nBoxes);
+
+	// Caixa já em espaço de mundo
+	void add(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	// Caixa local levada ao mundo por model; o resultado envolve a caixa transformada
+	void add(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model);
+
+	int size() const { return nBoxes; }
+	glm::vec3 getCenter(int i) const { return glm::vec3(cx[i], cy[i], cz[i]); }
+	glm::vec3 getExtent(int i) const { return glm::vec3(ex[i], ey[i], ez[i]); }
+
+private:
+	friend class Frustum;
+
+	void push(const glm::vec3& center, const glm::vec3& extent);
+
+	std::vector<float> cx, cy, cz;
+	std::vector<float> ex, ey, ez;
+	int nBoxes;
+};
+
+class Frustum
+{
+public:
+	Frustum();
+
+	// viewProjection = projection * view; as caixas e esferas devem estar em espaço de mundo
+	void extract(const glm::mat4& viewProjection);
+	const glm::vec4& getPlane(int plane) const { return planes[plane]; }
+
+	bool isSphereVisible(const glm::vec3& center, float radius) const;
+	bool isBoxVisible(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+	// Distingue as caixas inteiramente dentro, que dispensam testar o que elas contêm
+	FrustumTest classifyBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+	// visible[i] recebe 1 se a caixa i pode aparecer e 0 se está fora; retorna quantas são visíveis
+	int cull(const BoxList& boxes, std::vector<unsigned char>& visible);
+
+	// Caixas testadas por cull desde o último resetStats
+	void resetStats() { nVisible = nCulled = 0; }
+	int getNbVisible() const { return nVisible; }
+	int getNbCulled() const { return nCulled; }
+
+private:
+	glm::vec4 planes[FRUSTUM_NB_PLANES]; // (normal, d)
+	int nVisible;
+	int nCulled;
+};
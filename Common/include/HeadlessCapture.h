@@ -0,0 +1,74 @@
+// Modo sem janela para testes automáticos e medições em servidores
+// Com --headless a janela é criada invisível (opcionalmente num contexto EGL ou OSMesa, como
+// o llvmpipe do Mesa, em máquinas sem GPU), cada quadro é desenhado num framebuffer próprio
+// e gravado em PNG, e o programa termina sozinho depois de N quadros. O tempo da animação
+// avança um passo fixo por quadro, então a mesma execução gera sempre as mesmas imagens.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+struct HeadlessOptions
+{
+	bool enabled = false;
+	int nFrames = 60;
+	std::string outDir = "headless";
+	std::string context = "native"; // native, egl ou osmesa (GLFW_CONTEXT_CREATION_API)
+	double frameTime = 1.0 / 60.0;  // passo do tempo simulado, em segundos
+};
+
+// Lê --headless, --frames N, --out pasta e --context api; os demais argumentos são ignorados.
+// Retorna false (e mostra o uso) se algum desses vier sem valor ou com valor inválido
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions& options);
+
+// Dicas da GLFW para a próxima janela: invisível e com a API de contexto pedida (antes de glfwCreateWindow)
+void setHeadlessWindowHints(const HeadlessOptions& options);
+
+class HeadlessCapture
+{
+public:
+	HeadlessCapture();
+
+	// Cria o framebuffer (cor RGBA8 e profundidade) e a consulta de tempo; contexto OpenGL ativo
+	bool initialize(const HeadlessOptions& options, int width, int height);
+	// Apaga framebuffer, renderbuffers e consulta; chamar antes de glfwTerminate, com o contexto
+	// ainda ativo (também depois de initialize falhar)
+	void release();
+
+	// Tempo simulado do quadro atual, no lugar de glfwGetTime
+	double getTime() const { return frame * frameTime; }
+	bool isDone() const { return frame >= nFrames; }
+	int getFrame() const { return frame; }
+
+	// Liga o framebuffer e começa as medições de CPU e GPU do quadro
+	void beginFrame();
+	// Fecha as medições, lê a imagem e grava pasta/frame_NNNN.png
+	void endFrame();
+
+	// Resumo dos tempos; retorna o código de saída do programa (1 se algum quadro não foi gravado)
+	int finish();
+
+private:
+	HeadlessCapture(const HeadlessCapture&);
+	HeadlessCapture& operator=(const HeadlessCapture&);
+
+	GLuint framebuffer;
+	GLuint colorBuffer;
+	GLuint depthBuffer;
+	GLuint query;
+	int width;
+	int height;
+	int nFrames;
+	int frame;
+	double frameTime;
+	std::string outDir;
+	double cpuStart;
+	std::vector<double> cpuMs;
+	std::vector<double> gpuMs;
+	std::vector<unsigned char> pixels;
+	int nFailed;
+};
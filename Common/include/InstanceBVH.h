@@ -0,0 +1,67 @@
+// Hierarquia de volumes envolventes (BVH) sobre as caixas das instâncias de uma cena
+// A árvore é construída pela heurística de área de superfície (SAH) com os centros das
+// caixas separados em faixas, e guardada num único array de nós em profundidade: os dois
+// filhos de um nó interno são vizinhos, e os filhos vêm sempre depois do pai no array.
+// Quando só as transformações mudam, refit recalcula as caixas de baixo para cima sem
+// mexer na topologia; quando instâncias entram ou saem (ou a árvore degrada demais,
+// ver needsRebuild), build refaz tudo. A construção só enxerga caixas, então a mesma
+// árvore serve para triângulos (o RayTracer percorre os nós com o seu próprio teste).
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Frustum.h"
+
+// 32 bytes: dois nós por linha de cache de 64 bytes
+struct BVHNode
+{
+	glm::vec3 boundsMin;
+	int leftFirst; // nó interno: índice do filho esquerdo (o direito é o seguinte); folha: primeiro item
+	glm::vec3 boundsMax;
+	int count;     // itens da folha (0 em nós internos)
+};
+
+class InstanceBVH
+{
+public:
+	InstanceBVH();
+
+	// Constrói a árvore sobre n caixas em espaço de mundo; o item i é a caixa i
+	void build(const glm::vec3* boundsMin, const glm::vec3* boundsMax, int n);
+	// Novas caixas para os mesmos n itens, mantendo a topologia
+	void refit(const glm::vec3* boundsMin, const glm::vec3* boundsMax);
+	// Custo SAH atual passou de 'factor' vezes o da construção
+	bool needsRebuild(float factor = 1.5f) const { return cost > buildCost * factor; }
+
+	// Itens cuja caixa pode aparecer; subárvores inteiramente dentro do volume entram sem testes
+	int cull(const Frustum& frustum, std::vector<int>& visible);
+	// Item com a caixa atingida mais perto da origem do raio (-1 se nenhum); distance recebe a entrada na caixa
+	int intersectRay(const glm::vec3& origin, const glm::vec3& direction, float* distance = nullptr) const;
+
+	int getNbItems() const { return (int)itemMin.size(); }
+	int getNbNodes() const { return (int)nodes.size(); }
+	const std::vector<BVHNode>& getNodes() const { return nodes; }
+	// Itens na ordem das folhas: a folha cobre getItemOrder()[leftFirst .. leftFirst + count)
+	const std::vector<int>& getItemOrder() const { return items; }
+	float getCost() const { return cost; }
+	// Nós visitados pelo último cull
+	int getNbNodesTested() const { return nNodesTested; }
+
+private:
+	void updateBounds(int nodeIndex);
+	float findSplit(const BVHNode& node, int& axis, float& position) const;
+	float computeCost() const;
+
+	std::vector<BVHNode> nodes;
+	std::vector<int> items;          // índices dos itens na ordem das folhas
+	std::vector<glm::vec3> itemMin;  // caixas por item, na ordem original
+	std::vector<glm::vec3> itemMax;
+	std::vector<glm::vec3> centroids;
+	float cost;
+	float buildCost;
+	int nNodesTested;
+};
@@ -0,0 +1,60 @@
+// Mapeamento de arquivos em memória (somente leitura)
+// Evita copiar o conteúdo do arquivo para buffers intermediários: o sistema
+// operacional carrega as páginas sob demanda e o parser lê direto delas.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const char* path);
+	void close();
+
+	const char* data() const { return ptr; }
+	size_t size() const { return length; }
+	bool isOpen() const { return ptr != nullptr; }
+
+private:
+	// Um mapeamento é dono do recurso do sistema; não pode ser copiado
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const char* ptr;
+	size_t length;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fd;
+#endif
+};
+
+// Identificação de um arquivo de origem, gravada nos caches gerados a partir dele
+struct FileStamp
+{
+	uint64_t size;
+	int64_t time; // data de modificação
+	uint64_t hash;
+};
+
+// Preenche tamanho e data (sem ler o conteúdo; hash fica 0)
+bool getFileStamp(const std::string& path, FileStamp& stamp);
+
+// FNV-1a de 64 bits
+uint64_t hashBytes(const char* data, size_t size);
+bool hashFile(const std::string& path, uint64_t& hash);
+
+// O arquivo ainda é o registrado: mesmo tamanho e, além disso, mesma data ou mesmo conteúdo.
+// O hash só é calculado quando a data não confere.
+bool matchesFileStamp(const std::string& path, const FileStamp& recorded);
+
+// Grava em um arquivo temporário e renomeia, para nunca deixar um arquivo pela metade
+bool writeFileAtomically(const std::string& path, const char* data, size_t size);
@@ -0,0 +1,114 @@
+// Cache binário de malhas (.meshbin), gravado ao lado do OBJ na primeira leitura
+// O arquivo guarda vértices intercalados, índices (16 ou 32 bits), submalhas,
+// nomes de materiais e limites (caixa e esfera da malha e de cada submalha) já no formato da GPU. Nas próximas execuções ele
+// é só mapeado em memória e os ponteiros vão direto para glBufferData.
+// O cache é refeito quando o OBJ muda (tamanho e data de modificação, ou hash).
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MappedFile.h"
+#include "ObjLoader.h"
+
+// Formatos de vértice; os atributos ficam sempre nas posições 0 (posição), 1 (textura) e 2 (normal)
+enum MeshVertexFormat
+{
+	MESH_VERTEX_FLOAT = 0,    // posição, textura e normal em float: 32 bytes
+	MESH_VERTEX_QUANTIZED = 1 // posição em float, textura em half float, normal em 4 x snorm16: 24 bytes
+};
+
+// Bits de MeshCacheHeader::flags
+const uint32_t MESH_CACHE_COOKED = 1; // gerado pelo AssetCooker, com índices reordenados para o cache de vértices
+
+// Cabeçalho no início do arquivo .meshbin; as seções seguintes ficam alinhadas em 16 bytes
+struct MeshCacheHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t vertexStride;  // bytes por vértice
+	FileStamp source;       // identificação do OBJ que gerou o cache
+	uint32_t vertexFormat;
+	uint32_t flags;
+	uint32_t nVertices;
+	uint32_t nIndices;
+	uint32_t indexSize;     // 2 ou 4 bytes
+	uint32_t nSubMeshes;
+	uint32_t nMaterials;
+	uint32_t reserved;
+	float boundsMin[3];
+	float boundsMax[3];
+	float sphere[4];        // esfera envolvente: centro e raio
+	uint64_t verticesOffset;
+	uint64_t indicesOffset;
+	uint64_t subMeshesOffset;
+	uint64_t stringsOffset; // nome do mtllib e dos materiais, terminados em '\0'
+	uint64_t stringsSize;
+	uint64_t fileSize;
+};
+
+class MeshCache
+{
+public:
+	MeshCache();
+
+	// Usa o .meshbin se for válido; senão lê o OBJ e grava um cache novo.
+	// Se o OBJ não existir, um .meshbin presente é usado como está.
+	// Sem malha carregada os getters devolvem 0, nullptr ou limites nulos.
+	bool load(const std::string& objPath, int nThreads = 0);
+	void clear();
+
+	const void* getVertices() const { return header ? base + header->verticesOffset : nullptr; }
+	int getNbVertices() const { return header ? (int)header->nVertices : 0; }
+	int getVertexStride() const { return header ? (int)header->vertexStride : 0; }
+	MeshVertexFormat getVertexFormat() const { return header ? (MeshVertexFormat)header->vertexFormat : MESH_VERTEX_FLOAT; }
+	size_t getVerticesSize() const { return header ? (size_t)header->nVertices * header->vertexStride : 0; }
+
+	const void* getIndices() const { return header ? base + header->indicesOffset : nullptr; }
+	int getNbIndices() const { return header ? (int)header->nIndices : 0; }
+	int getIndexSize() const { return header ? (int)header->indexSize : 4; }
+	size_t getIndicesSize() const { return header ? (size_t)header->nIndices * header->indexSize : 0; }
+
+	const SubMesh* getSubMeshes() const { return header ? (const SubMesh*)(base + header->subMeshesOffset) : nullptr; }
+	int getNbSubMeshes() const { return header ? (int)header->nSubMeshes : 0; }
+
+	const std::string& getMtlFileName() const { return mtlFileName; }
+	const std::vector<std::string>& getMaterialNames() const { return materialNames; }
+	glm::vec3 getBoundsMin() const { return header ? glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]) : glm::vec3(0.0f); }
+	glm::vec3 getBoundsMax() const { return header ? glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]) : glm::vec3(0.0f); }
+	glm::vec4 getBoundingSphere() const { return header ? glm::vec4(header->sphere[0], header->sphere[1], header->sphere[2], header->sphere[3]) : glm::vec4(0.0f); }
+
+	// true se a última chamada de load usou o cache sem ler o OBJ
+	bool wasCacheHit() const { return cacheHit; }
+	bool isCooked() const { return header && (header->flags & MESH_CACHE_COOKED) != 0; }
+
+	// "modelo.obj" -> "modelo.meshbin"
+	static std::string getCachePath(const std::string& objPath);
+
+	// O .meshbin existe, corresponde ao OBJ atual e tem todos os bits de requiredFlags
+	static bool isUpToDate(const std::string& objPath, uint32_t requiredFlags = 0);
+
+	// Serializa a malha no formato do .meshbin (os vértices de MeshData estão sempre em 8 floats)
+	static void serialize(const MeshData& mesh, const FileStamp& source, MeshVertexFormat vertexFormat, uint32_t flags, std::vector<char>& blob);
+
+private:
+	MeshCache(const MeshCache&);
+	MeshCache& operator=(const MeshCache&);
+
+	bool openCache(const std::string& objPath, uint32_t requiredFlags);
+	bool attach(const char* data, size_t size);
+	void restamp(const std::string& objPath, int64_t time);
+
+	MappedFile file;
+	std::vector<char> memory; // usado quando o cache não pôde ser gravado em disco
+	const char* base;
+	const MeshCacheHeader* header;
+	std::string mtlFileName;
+	std::vector<std::string> materialNames;
+	bool cacheHit;
+};
@@ -0,0 +1,31 @@
+// Leitor de arquivos MTL (bibliotecas de materiais referenciadas pelos OBJ)
+// Cada bloco "newmtl" vira um Material; propriedades ausentes ficam com os valores padrão.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+struct Material
+{
+	std::string name;
+	glm::vec3 ka = glm::vec3(0.0f);
+	glm::vec3 kd = glm::vec3(0.7f); // mesmo coeficiente difuso usado antes de ler o Kd do arquivo
+	glm::vec3 ks = glm::vec3(0.0f);
+	glm::vec3 ke = glm::vec3(0.0f);
+	float ns = 1.0f;
+	float ni = 1.0f;
+	float d = 1.0f;
+	int illum = 2;
+	std::string mapKd; // caminho como escrito no MTL (relativo à pasta do arquivo)
+	unsigned int textureId = 0; // preenchido por quem carrega a textura de mapKd
+};
+
+// Acrescenta os materiais do arquivo ao vetor; retorna false se não abrir
+bool loadMtl(const std::string& path, std::vector<Material>& materials);
+
+// Posição do material com esse nome, ou -1
+int findMaterial(const std::vector<Material>& materials, const std::string& name);
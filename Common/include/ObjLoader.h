@@ -0,0 +1,87 @@
+// Leitor de arquivos OBJ compartilhado entre os módulos
+// O arquivo é mapeado em memória e os registros v/vt/vn/f são lidos por um
+// scanner próprio, sem std::string/istringstream por linha e sem alocações
+// além do crescimento dos vetores de saída.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+// Índices de um canto de face, já convertidos para base 0 (-1 quando ausente)
+struct ObjIndex
+{
+	int v;
+	int vt;
+	int vn;
+};
+
+// Trecho de faces a partir de um "usemtl"
+struct ObjGroup
+{
+	std::string material;
+	size_t firstCorner;
+};
+
+struct ObjData
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texCoords;
+	std::vector<glm::vec3> normals;
+	std::vector<ObjIndex> corners; // 3 cantos por triângulo (polígonos viram leques)
+	std::vector<ObjGroup> groups;
+	std::string mtlFileName;
+
+	void clear();
+	int getNbTriangles() const { return (int)(corners.size() / 3); }
+};
+
+// Lê o arquivo inteiro; retorna false se não abrir ou se houver índices inválidos.
+// nThreads = 1 lê de forma serial; nThreads <= 0 usa todas as threads de hardware.
+// Arquivos pequenos são sempre lidos de forma serial.
+bool loadObj(const std::string& path, ObjData& obj, int nThreads = 1);
+
+// Lê um trecho de texto OBJ já carregado em memória
+bool parseObj(const char* begin, const char* end, ObjData& obj);
+
+// Mesmo resultado de parseObj, dividindo o texto em blocos lidos em paralelo
+bool parseObjParallel(const char* begin, const char* end, ObjData& obj, int nThreads = 0);
+
+// Expande cada canto em 8 floats intercalados: posição (3), textura (2), normal (3)
+void expandVertices(const ObjData& obj, std::vector<float>& vertices);
+
+// Versão indexada: cada trinca (v, vt, vn) distinta vira um único vértice de 8 floats
+// e os cantos das faces viram índices para ele (para desenhar com glDrawElements)
+void buildIndexedMesh(const ObjData& obj, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+// Intervalo de índices desenhado com um mesmo material, com a caixa e a esfera envolventes
+// dos seus triângulos (em float, porque a estrutura é gravada como está no .meshbin)
+struct SubMesh
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	int materialIndex; // posição em MeshData::materialNames (-1 = sem material)
+	float boundsMin[3];
+	float boundsMax[3];
+	float sphere[4];   // centro (x, y, z) e raio
+};
+
+// Malha pronta para a GPU: vértices únicos intercalados, índices, submalhas e limites
+struct MeshData
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<SubMesh> subMeshes;
+	std::vector<std::string> materialNames;
+	std::string mtlFileName;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	glm::vec4 sphere; // centro e raio (w)
+};
+
+// Triângulos são agrupados por material: uma submalha por material (a sem material
+// primeiro), na ordem em que os materiais aparecem nos "usemtl"
+void buildMeshData(const ObjData& obj, MeshData& mesh);
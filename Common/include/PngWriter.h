@@ -0,0 +1,18 @@
+// Gravação de imagens PNG sem bibliotecas externas
+// Os dados vão em blocos deflate "stored" (sem compressão): o arquivo fica maior que o
+// de um compressor de verdade, mas a gravação é só cópia, CRC e Adler-32, e qualquer
+// visualizador abre. Serve para capturas e renders de referência, não para distribuição.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Monta o arquivo em memória; nChannels: 1 (cinza), 3 (RGB) ou 4 (RGBA), 8 bits por canal.
+// flipVertically grava a última linha primeiro (imagens lidas com glReadPixels)
+bool encodePng(int width, int height, int nChannels, const unsigned char* pixels, bool flipVertically,
+	std::vector<char>& file);
+
+// Grava o arquivo com writeFileAtomically; retorna false se não conseguir
+bool writePng(const std::string& path, int width, int height, int nChannels, const unsigned char* pixels,
+	bool flipVertically = false);
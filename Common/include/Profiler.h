@@ -0,0 +1,175 @@
+// Medição do tempo de quadro por escopos nomeados, na CPU e na GPU
+// Cada escopo mede a CPU com o relógio de alta resolução e, se pedido, a GPU com uma consulta
+// GL_TIME_ELAPSED. As consultas ficam num anel de alguns quadros: o resultado de um quadro só é
+// lido quando o anel dá a volta, e só se já estiver pronto, então a medição nunca espera a GPU.
+// Os tempos de cada quadro entram num histórico circular de onde saem mínimo, média e p99 por
+// escopo; ProfilerOverlay desenha esse resumo na tela e writeChromeTrace grava os eventos
+// capturados no formato JSON do chrome://tracing (e do Perfetto).
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "Shader.h"
+
+struct ProfilerStats
+{
+	float min;
+	float avg;
+	float p99;
+	float last;
+};
+
+class Profiler
+{
+public:
+	Profiler();
+	~Profiler();
+
+	// historyFrames: quantos quadros entram nas estatísticas; contexto OpenGL ativo se gpu
+	void initialize(int historyFrames = 240, bool gpu = true);
+	// Apaga as consultas de GPU; chamar antes de glfwTerminate, com o contexto ainda ativo
+	void release();
+
+	void beginFrame();
+	void endFrame();
+
+	// Escopos podem ser aninhados na CPU; a GPU mede um escopo por vez (GL_TIME_ELAPSED não
+	// aninha), então um escopo de GPU aberto dentro de outro mede só a CPU
+	void beginScope(const char* name, bool gpu = false);
+	void endScope();
+
+	// Grava os eventos dos próximos nFrames quadros e depois o arquivo em path
+	void captureTrace(const std::string& path, int nFrames = 120);
+	bool isCapturing() const { return captureFrames > 0; }
+	bool writeChromeTrace(const std::string& path) const;
+
+	// Escopos na ordem em que apareceram pela primeira vez; o índice 0 é o quadro inteiro
+	int getNbScopes() const { return (int)scopes.size(); }
+	const std::string& getScopeName(int scope) const { return scopes[scope].name; }
+	int getScopeDepth(int scope) const { return scopes[scope].depth; }
+	bool hasGpuTime(int scope) const { return scopes[scope].gpu; }
+	ProfilerStats getCpuStats(int scope) const;
+	ProfilerStats getGpuStats(int scope) const;
+	int getNbFrames() const { return nFrames; }
+	// Quadros cujo resultado de GPU ainda não estava pronto quando o anel deu a volta
+	int getNbDroppedGpuFrames() const { return nDroppedGpuFrames; }
+
+private:
+	Profiler(const Profiler&);
+	Profiler& operator=(const Profiler&);
+
+	// Quadros entre a emissão de uma consulta e a leitura do seu resultado
+	static const int queryLatency = 4;
+
+	struct Scope
+	{
+		std::string name;
+		int depth;
+		bool gpu;
+		bool ran;                     // apareceu no quadro atual
+		double cpuFrameMs;            // soma do quadro atual (um escopo pode rodar várias vezes)
+		std::vector<float> cpuHistory; // circulares, com historyFrames posições
+		std::vector<float> gpuHistory;
+		int cpuCount, cpuNext;
+		int gpuCount, gpuNext;
+	};
+
+	struct OpenScope
+	{
+		int scope;
+		double startMs;
+		bool gpu;
+	};
+
+	struct PendingQuery
+	{
+		GLuint query;
+		int scope;
+		double startMs; // início na CPU, para posicionar o evento no trace
+	};
+
+	struct FrameQueries
+	{
+		std::vector<PendingQuery> pending;
+		std::vector<GLuint> free;
+		long long frame;
+	};
+
+	struct TraceEvent
+	{
+		int scope;
+		bool gpu;
+		double startMs;
+		double durationMs;
+	};
+
+	double now() const;
+	int findScope(const char* name, int depth);
+	void collectGpu(FrameQueries& slot);
+	static ProfilerStats computeStats(const std::vector<float>& history, int count, int next);
+
+	std::chrono::steady_clock::time_point start;
+	std::vector<Scope> scopes;
+	std::vector<OpenScope> stack;
+	FrameQueries rings[queryLatency];
+	bool gpuEnabled;
+	bool gpuBusy;
+	int historyFrames;
+	int nFrames;
+	long long frameIndex;
+	int nDroppedGpuFrames;
+
+	std::vector<TraceEvent> trace;
+	std::string tracePath;
+	int captureFrames;
+};
+
+// Abre um escopo no construtor e fecha no destrutor
+class ProfileScope
+{
+public:
+	ProfileScope(Profiler& profiler, const char* name, bool gpu = false) : profiler(profiler) { profiler.beginScope(name, gpu); }
+	~ProfileScope() { profiler.endScope(); }
+
+private:
+	ProfileScope(const ProfileScope&);
+	ProfileScope& operator=(const ProfileScope&);
+
+	Profiler& profiler;
+};
+
+// Painel com uma linha por escopo (CPU e GPU: média, mínimo e p99) e uma barra da média,
+// desenhado por cima da cena com uma fonte de 3x5 pixels embutida
+class ProfilerOverlay
+{
+public:
+	ProfilerOverlay();
+	~ProfilerOverlay();
+
+	// Contexto OpenGL ativo; pixelSize: tamanho na tela de cada pixel da fonte
+	void initialize(int pixelSize = 2);
+	// Apaga shader e buffers; chamar antes de glfwTerminate, com o contexto ainda ativo
+	void release();
+	// Desenha no framebuffer atual; o estado alterado (programa, VAO, blend, profundidade) é restaurado
+	void draw(const Profiler& profiler, int width, int height);
+
+private:
+	ProfilerOverlay(const ProfilerOverlay&);
+	ProfilerOverlay& operator=(const ProfilerOverlay&);
+
+	void addRect(float x, float y, float w, float h, const float* color);
+	void addText(float x, float y, const char* text, const float* color);
+
+	Shader* shader;
+	GLuint VAO;
+	GLuint VBO;
+	size_t capacity;
+	int pixelSize;
+	std::vector<float> vertices; // x, y, r, g, b, a
+};
@@ -0,0 +1,87 @@
+// Fila de desenho ordenada por estado
+// Em vez de desenhar na hora, cada objeto coloca seus itens na fila; flush ordena os itens
+// pela chave de 64 bits (radix sort) e desenha na ordem, trocando programa, textura,
+// bloco de material e VAO só quando mudam de um item para o próximo.
+//
+// Bits da chave, do mais significativo para o menos:
+//   63..56  programa           (8 bits)
+//   55..44  textura            (12 bits)
+//   43..36  bloco de material  (8 bits)
+//   35..24  VAO                (12 bits)
+//   23..0   profundidade       (24 bits, mais perto primeiro)
+// Os IDs da OpenGL são truncados para caber; isso só afeta a ordem, não o que é desenhado.
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "Shader.h"
+#include "UniformBuffer.h"
+
+struct DrawItem
+{
+	Shader* shader;
+	GLuint vao;
+	GLuint texture;                 // ligada na unidade 0
+	UniformBuffer* materialBuffer;  // nullptr se o programa não usa bloco de material
+	int materialBlock;
+	const float* model;             // matriz 4x4 do uniform "model" (nullptr mantém a atual); deve valer até o flush
+	GLenum mode;
+	GLenum indexType;               // 0 desenha com glDrawArrays
+	int first;                      // primeiro índice (ou vértice)
+	int count;
+	int nInstances;
+	float depth;                    // distância até a câmera
+};
+
+// Trocas de estado do último flush
+struct RenderQueueStats
+{
+	int nDraws;
+	int programChanges;
+	int textureChanges;
+	int materialChanges;
+	int vaoChanges;
+	int avoided; // binds que um laço sem ordenação nem controle de estado faria a mais
+};
+
+class RenderQueue
+{
+public:
+	RenderQueue();
+
+	// Profundidade máxima usada para quantizar 'depth' na chave
+	void setMaxDepth(float maxDepth) { this->maxDepth = maxDepth; }
+
+	// Item com os valores padrão (triângulos, sem índices, 1 instância)
+	static DrawItem makeItem(Shader* shader, GLuint vao, int first, int count);
+
+	void add(const DrawItem& item);
+
+	// Ordena, desenha e esvazia a fila
+	void flush();
+
+	int getNbItems() const { return (int)items.size(); }
+	const RenderQueueStats& getStats() const { return stats; }
+	void printStats() const;
+
+private:
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t index;
+	};
+
+	uint64_t makeKey(const DrawItem& item) const;
+	void sort();
+
+	std::vector<DrawItem> items;
+	std::vector<SortEntry> entries;
+	std::vector<SortEntry> scratch;
+	float maxDepth;
+	RenderQueueStats stats;
+};
@@ -7,6 +7,11 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <cstring>
 
 //GLAD
 #include <glad/glad.h>
@@ -16,6 +21,104 @@
 
 using namespace std;
 
+// Estgios de tesselao (OpenGL 4.0); a GLAD do projeto vai at a 3.3
+#ifndef GL_TESS_CONTROL_SHADER
+#define GL_TESS_CONTROL_SHADER 0x8E88
+#endif
+#ifndef GL_TESS_EVALUATION_SHADER
+#define GL_TESS_EVALUATION_SHADER 0x8E87
+#endif
+
+// ltimo valor enviado a um uniform; um por localizao, compartilhado por todos os nomes
+// e handles que levam a ela
+struct UniformState
+{
+	GLint location;
+	bool valid; // value  o que est no programa
+	GLfloat value[16];
+};
+
+// Uniform j resolvido: no consulta glGetUniformLocation e s chama glUniform quando o
+// valor muda. Vale enquanto o Shader existir, com o programa em uso (glUseProgram), e supe
+// que o uniform no  alterado por glUniform direto, fora da classe Shader.
+class UniformHandle
+{
+public:
+	UniformHandle(UniformState* state = nullptr) : state(state) {}
+	bool isValid() const { return state && state->location >= 0; }
+	GLint getLocation() const { return state ? state->location : -1; }
+
+protected:
+	// Guarda o valor e responde se ele precisa ser enviado
+	bool changed(const void* data, size_t size)
+	{
+		if (!isValid() || (state->valid && memcmp(state->value, data, size) == 0))
+			return false;
+		memcpy(state->value, data, size);
+		state->valid = true;
+		return true;
+	}
+
+	UniformState* state;
+};
+
+class UniformInt : public UniformHandle
+{
+public:
+	UniformInt(UniformState* state = nullptr) : UniformHandle(state) {}
+	void set(int v) { if (changed(&v, sizeof(v))) glUniform1i(state->location, v); }
+};
+
+class UniformFloat : public UniformHandle
+{
+public:
+	UniformFloat(UniformState* state = nullptr) : UniformHandle(state) {}
+	void set(float v) { if (changed(&v, sizeof(v))) glUniform1f(state->location, v); }
+};
+
+class UniformVec2 : public UniformHandle
+{
+public:
+	UniformVec2(UniformState* state = nullptr) : UniformHandle(state) {}
+	void set(float v1, float v2)
+	{
+		GLfloat v[2] = { v1, v2 };
+		if (changed(v, sizeof(v)))
+			glUniform2fv(state->location, 1, v);
+	}
+};
+
+class UniformVec3 : public UniformHandle
+{
+public:
+	UniformVec3(UniformState* state = nullptr) : UniformHandle(state) {}
+	void set(float v1, float v2, float v3)
+	{
+		GLfloat v[3] = { v1, v2, v3 };
+		if (changed(v, sizeof(v)))
+			glUniform3fv(state->location, 1, v);
+	}
+};
+
+class UniformVec4 : public UniformHandle
+{
+public:
+	UniformVec4(UniformState* state = nullptr) : UniformHandle(state) {}
+	void set(float v1, float v2, float v3, float v4)
+	{
+		GLfloat v[4] = { v1, v2, v3, v4 };
+		if (changed(v, sizeof(v)))
+			glUniform4fv(state->location, 1, v);
+	}
+};
+
+class UniformMat4 : public UniformHandle
+{
+public:
+	UniformMat4(UniformState* state = nullptr) : UniformHandle(state) {}
+	void set(const float* v) { if (changed(v, 16 * sizeof(GLfloat))) glUniformMatrix4fv(state->location, 1, GL_FALSE, v); }
+};
+
 class Shader
 {
 public:
@@ -51,38 +154,137 @@ public:
 		{
 			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
 		}
-		const GLchar* vShaderCode = vertexCode.c_str();
-		const GLchar * fShaderCode = fragmentCode.c_str();
-		// 2. Compile shaders
-		GLuint vertex, fragment;
-		GLint success;
-		GLchar infoLog[512];
-		// Vertex Shader
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vShaderCode, NULL);
-		glCompileShader(vertex);
-		// Print compile errors if any
-		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-		if (!success)
+		compile(vertexCode.c_str(), fragmentCode.c_str());
+	}
+
+	// Com os estgios de controle e avaliao de tesselao (contexto 4.0 ou mais); o programa desenha GL_PATCHES
+	Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const GLchar* tessControlPath, const GLchar* tessEvaluationPath)
+	{
+		std::string vertexCode = readSource(vertexPath);
+		std::string fragmentCode = readSource(fragmentPath);
+		std::string tessControlCode = readSource(tessControlPath);
+		std::string tessEvaluationCode = readSource(tessEvaluationPath);
+		compile(vertexCode.c_str(), fragmentCode.c_str(), tessControlCode.c_str(), tessEvaluationCode.c_str());
+	}
+
+	// Programa a partir do cdigo j em memria (shaders embutidos no executvel, sem arquivos)
+	static Shader fromSource(const GLchar* vShaderCode, const GLchar* fShaderCode)
+	{
+		Shader shader;
+		shader.compile(vShaderCode, fShaderCode);
+		return shader;
+	}
+
+	// Uses the current shader
+	void Use()
+	{
+		glUseProgram(this->ID);
+	}
+
+	// Handle para o uniform; converte para o tipo certo, ex.: UniformMat4 model = shader.uniform("model");
+	UniformState* uniform(const std::string& name) const
+	{
+		std::unordered_map<std::string, UniformState*>::const_iterator it = uniforms->names.find(name);
+		if (it != uniforms->names.end())
+			return it->second;
+
+		// Nome fora da lista dos ativos (elemento de array, ou inexistente): pergunta uma nica vez
+		UniformState* state = findLocation(glGetUniformLocation(this->ID, name.c_str()));
+		uniforms->names[name] = state;
+		return state;
+	}
+
+	// Os set* usam os mesmos valores guardados dos handles: repetir um valor no chama glUniform
+	void setBool(const std::string& name, bool value) const
+	{
+		UniformInt(uniform(name)).set((int)value);
+	}
+	// ------------------------------------------------------------------------
+	void setInt(const std::string& name, int value) const
+	{
+		UniformInt(uniform(name)).set(value);
+	}
+	// ------------------------------------------------------------------------
+	void setFloat(const std::string& name, float value) const
+	{
+		UniformFloat(uniform(name)).set(value);
+	}
+	// ------------------------------------------------------------------------
+	void setVec2(const std::string& name, float v1, float v2) const
+	{
+		UniformVec2(uniform(name)).set(v1, v2);
+	}
+
+	void setVec3(const std::string& name, float v1, float v2, float v3) const
+	{
+		UniformVec3(uniform(name)).set(v1, v2, v3);
+	}
+
+	void setVec4(const std::string& name, float v1, float v2, float v3, float v4) const
+	{
+		UniformVec4(uniform(name)).set(v1, v2, v3, v4);
+	}
+
+	void setMat4(const std::string& name, const float *v) const
+	{
+		UniformMat4(uniform(name)).set(v);
+	}
+
+private:
+	Shader() : ID(0) {}
+
+	// Contedo do arquivo, ou vazio (com o erro no console) se no der para ler
+	static std::string readSource(const GLchar* path)
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
 		{
-			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+			return std::string();
 		}
-		// Fragment Shader
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fShaderCode, NULL);
-		glCompileShader(fragment);
+		std::stringstream stream;
+		stream << file.rdbuf();
+		return stream.str();
+	}
+
+	// Compila um estgio; os erros vo para o console com o nome do estgio
+	static GLuint compileStage(GLenum type, const GLchar* code, const char* stageName)
+	{
+		GLint success;
+		GLchar infoLog[512];
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &code, NULL);
+		glCompileShader(shader);
 		// Print compile errors if any
-		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 		if (!success)
 		{
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::" << stageName << "::COMPILATION_FAILED\n" << infoLog << std::endl;
 		}
+		return shader;
+	}
+
+	// Compila os estgios e faz o link; os erros vo para o console, como na leitura dos arquivos.
+	// Os estgios de tesselao so opcionais (nullptr: s vrtice e fragmento)
+	void compile(const GLchar* vShaderCode, const GLchar* fShaderCode,
+		const GLchar* tcShaderCode = nullptr, const GLchar* teShaderCode = nullptr)
+	{
+		// 2. Compile shaders
+		GLint success;
+		GLchar infoLog[512];
+		GLuint vertex = compileStage(GL_VERTEX_SHADER, vShaderCode, "VERTEX");
+		GLuint fragment = compileStage(GL_FRAGMENT_SHADER, fShaderCode, "FRAGMENT");
+		GLuint tessControl = tcShaderCode ? compileStage(GL_TESS_CONTROL_SHADER, tcShaderCode, "TESS_CONTROL") : 0;
+		GLuint tessEvaluation = teShaderCode ? compileStage(GL_TESS_EVALUATION_SHADER, teShaderCode, "TESS_EVALUATION") : 0;
 		// Shader Program
 		this->ID = glCreateProgram();
 		glAttachShader(this->ID, vertex);
 		glAttachShader(this->ID, fragment);
+		if (tessControl)
+			glAttachShader(this->ID, tessControl);
+		if (tessEvaluation)
+			glAttachShader(this->ID, tessEvaluation);
 		glLinkProgram(this->ID);
 		// Print linking errors if any
 		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
@@ -94,42 +296,58 @@ public:
 		// Delete the shaders as they're linked into our program now and no longer necessery
 		glDeleteShader(vertex);
 		glDeleteShader(fragment);
+		if (tessControl)
+			glDeleteShader(tessControl);
+		if (tessEvaluation)
+			glDeleteShader(tessEvaluation);
 
-	}
-	// Uses the current shader
-	void Use()
-	{
-		glUseProgram(this->ID);
+		loadUniforms();
 	}
 
-	void setBool(const std::string& name, bool value) const
-	{
-		glUniform1i(glGetUniformLocation(this->ID, name.c_str()), (int)value);
-	}
-	// ------------------------------------------------------------------------
-	void setInt(const std::string& name, int value) const
-	{
-		glUniform1i(glGetUniformLocation(this->ID, name.c_str()), value);
-	}
-	// ------------------------------------------------------------------------
-	void setFloat(const std::string& name, float value) const
-	{
-		glUniform1f(glGetUniformLocation(this->ID, name.c_str()), value);
-	}
-	// ------------------------------------------------------------------------
-	void setVec3(const std::string& name, float v1, float v2, float v3) const
+	// Uniforms do programa: nome -> estado, e um estado por localizao (-1 para os que no existem).
+	// Fica em shared_ptr para que cpias do Shader e handles vejam os mesmos valores.
+	struct UniformTable
 	{
-		glUniform3f(glGetUniformLocation(this->ID, name.c_str()), v1, v2, v3);
-	}
+		std::unordered_map<std::string, UniformState*> names;
+		std::map<GLint, UniformState> locations;
+	};
+	std::shared_ptr<UniformTable> uniforms;
 
-	void setVec4(const std::string& name, float v1, float v2, float v3, float v4) const
+	UniformState* findLocation(GLint location) const
 	{
-		glUniform4f(glGetUniformLocation(this->ID, name.c_str()), v1, v2, v3,v4);
+		UniformState& state = uniforms->locations[location];
+		state.location = location;
+		return &state;
 	}
 
-	void setMat4(const std::string& name, float *v) const
+	// L uma vez, depois do link, a localizao de todos os uniforms ativos
+	void loadUniforms()
 	{
-		glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, v);
+		uniforms = std::make_shared<UniformTable>();
+
+		GLint nUniforms = 0, maxLength = 0;
+		glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &nUniforms);
+		glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+		std::vector<GLchar> name(maxLength + 1);
+		for (GLint i = 0; i < nUniforms; i++)
+		{
+			GLsizei length = 0;
+			GLint size;
+			GLenum type;
+			glGetActiveUniform(this->ID, i, (GLsizei)name.size(), &length, &size, &type, name.data());
+			std::string uniformName(name.data(), length);
+
+			// Uniforms de blocos (UBO) no tm localizao
+			GLint location = glGetUniformLocation(this->ID, uniformName.c_str());
+			if (location < 0)
+				continue;
+			UniformState* state = findLocation(location);
+			uniforms->names[uniformName] = state;
+
+			// Arrays so listados como "nome[0]"; "nome" leva ao mesmo elemento
+			if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+				uniforms->names[uniformName.substr(0, uniformName.size() - 3)] = state;
+		}
 	}
 };
 
@@ -0,0 +1,67 @@
+// Buffer para dados que mudam todo quadro (pontos animados, linhas de depuração, sprites)
+// O buffer é dividido em 3 regiões, uma por quadro em andamento: a CPU escreve na região do
+// quadro atual enquanto a GPU ainda lê as dos dois anteriores, e uma fence no fim de cada quadro
+// diz quando a região pode ser reescrita. Dentro do quadro a região é um alocador linear: cada
+// escrita só avança um deslocamento, sem glBufferData nem buffers novos.
+// Com glBufferStorage (OpenGL 4.4 ou ARB_buffer_storage) o buffer fica mapeado o tempo todo
+// (persistente e coerente); sem ele, cada escrita mapeia só o seu trecho com
+// GL_MAP_UNSYNCHRONIZED_BIT, e a sincronização fica por conta das mesmas fences.
+
+#pragma once
+
+#include <cstddef>
+
+//GLAD
+#include <glad/glad.h>
+
+class StreamBuffer
+{
+public:
+	StreamBuffer();
+	~StreamBuffer();
+
+	// Contexto OpenGL ativo; frameSize: bytes disponíveis por quadro. Chamar de novo recria o buffer
+	void initialize(size_t frameSize);
+	// Apaga buffer e fences; chamar antes de glfwTerminate, com o contexto ainda ativo
+	void release();
+
+	// Passa para a região do próximo quadro, esperando a GPU terminar de lê-la se preciso
+	void beginFrame();
+	// Marca com uma fence o fim dos comandos que leem a região deste quadro
+	void endFrame();
+
+	// Reserva size bytes da região atual; offset é a posição no buffer, múltipla de alignment
+	// (com alignment igual ao tamanho do vértice, offset / alignment serve de 'first' no glDrawArrays).
+	// Retorna nullptr se a região do quadro não tem mais espaço. unmap antes de desenhar
+	void* map(size_t size, size_t alignment, GLintptr& offset);
+	void unmap();
+
+	// map, cópia e unmap; retorna o deslocamento no buffer ou -1 se não couber
+	GLintptr write(const void* data, size_t size, size_t alignment = 4);
+
+	GLuint getBuffer() const { return buffer; }
+	bool isPersistent() const { return persistent != nullptr; }
+	size_t getFrameSize() const { return regionSize; }
+	size_t getUsedBytes() const { return head; }
+	size_t getPeakBytes() const { return peakBytes; }
+	// Quadros em que a região ainda estava em uso pela GPU, e reservas recusadas por falta de espaço
+	int getNbWaits() const { return nWaits; }
+	int getNbOverflows() const { return nOverflows; }
+
+private:
+	StreamBuffer(const StreamBuffer&);
+	StreamBuffer& operator=(const StreamBuffer&);
+
+	static const int nRegions = 3;
+
+	GLuint buffer;
+	char* persistent; // mapeamento do buffer inteiro, ou nullptr sem glBufferStorage
+	bool mapped;      // um trecho está mapeado (só sem glBufferStorage)
+	GLsync fences[nRegions];
+	size_t regionSize;
+	int region;
+	size_t head;      // bytes usados na região atual
+	size_t peakBytes;
+	int nWaits;
+	int nOverflows;
+};
@@ -0,0 +1,97 @@
+// Gerenciador de texturas compartilhadas
+// Cada imagem é identificada pelo caminho canônico junto com tamanho e data do arquivo: pedir
+// o mesmo arquivo por caminhos diferentes devolve a mesma textura, e um arquivo alterado vira
+// uma textura nova. O hash do conteúdo vem da thread que decodifica: quando um arquivo se
+// revela igual a outro já carregado, os pedidos passam a receber a textura existente e a
+// cópia é apagada assim que os donos a trocam (rebind) ou a liberam.
+// As texturas têm contagem de referências; as que ninguém usa continuam
+// na GPU (e contam como acerto se forem pedidas de novo) até que a memória residente
+// passe do orçamento, quando as usadas há mais tempo são apagadas primeiro.
+
+#pragma once
+
+#include <string>
+#include <map>
+#include <cstdint>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "MappedFile.h"
+#include "AsyncTextureLoader.h"
+
+class TextureManager
+{
+public:
+	TextureManager();
+
+	// As texturas são carregadas pelo loader, que já deve estar inicializado
+	void initialize(AsyncTextureLoader* loader, size_t budgetBytes = 256 * 1024 * 1024);
+
+	// Devolve a textura da imagem e soma uma referência; 0 se o arquivo não existe
+	GLuint acquire(const std::string& path);
+
+	// Tira uma referência; sem referências a textura pode ser apagada quando faltar memória
+	void release(GLuint textureID);
+
+	// Se a textura se revelou cópia de outra, passa a referência para a original e devolve o
+	// ID dela; senão devolve o mesmo ID. Quem guarda IDs deve chamar depois de update().
+	GLuint rebind(GLuint textureID);
+
+	// Atualiza o tamanho e o conteúdo das texturas que terminaram de chegar e respeita o orçamento.
+	// Chamar uma vez por quadro, depois de AsyncTextureLoader::update.
+	void update();
+
+	// Apaga todas as texturas (precisa do contexto OpenGL ativo)
+	void clear();
+
+	void setBudget(size_t budgetBytes);
+	size_t getBudget() const { return budgetBytes; }
+	size_t getResidentBytes() const { return residentBytes; }
+	int getNbTextures() const { return (int)textures.size(); }
+	int getRefCount(GLuint textureID) const;
+
+	int getNbHits() const { return nHits; }
+	int getNbMisses() const { return nMisses; }
+	int getNbEvictions() const { return nEvictions; }
+	int getNbDuplicates() const { return nDuplicates; }
+	void printStats() const;
+
+	// Caminho absoluto, com '/' como separador (e em minúsculas no Windows)
+	static std::string getCanonicalPath(const std::string& path);
+
+private:
+	TextureManager(const TextureManager&);
+	TextureManager& operator=(const TextureManager&);
+
+	struct Entry
+	{
+		GLuint textureID;
+		std::string path; // caminho canônico
+		int refCount;
+		size_t bytes;     // 0 enquanto a imagem não foi decodificada
+		uint64_t lastUse;
+		uint64_t content; // hash do conteúdo, 0 enquanto a imagem não foi decodificada
+		GLuint original;  // textura com o mesmo conteúdo que substitui esta (0 se não é cópia)
+	};
+
+	// Chave de uma versão do arquivo: caminho canônico, tamanho e data de modificação
+	static uint64_t getKey(const std::string& canonical, const FileStamp& stamp);
+
+	void alias(GLuint copyID, GLuint originalID);
+	void erase(std::map<GLuint, Entry>::iterator it);
+	void evict();
+
+	AsyncTextureLoader* loader;
+	std::map<GLuint, Entry> textures;
+	std::map<uint64_t, GLuint> files;    // chave do arquivo (getKey) -> textura
+	std::map<uint64_t, GLuint> contents; // hash do conteúdo -> textura que o representa
+	size_t budgetBytes;
+	size_t residentBytes;
+	uint64_t useCounter;
+	int nHits;
+	int nMisses;
+	int nEvictions;
+	int nDuplicates;
+	bool overBudget;
+};
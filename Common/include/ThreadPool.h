@@ -0,0 +1,48 @@
+// Conjunto fixo de threads de trabalho
+// As tarefas são funções sem argumentos executadas na ordem em que chegam.
+// parallelFor divide um intervalo de índices entre as threads e a thread que
+// chamou também trabalha, então pode ser usado de dentro de outra tarefa.
+
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class ThreadPool
+{
+public:
+	// nThreads <= 0 usa todas as threads de hardware
+	explicit ThreadPool(int nThreads = 0);
+	~ThreadPool();
+
+	void submit(std::function<void()> task);
+
+	// Espera todas as tarefas enviadas com submit terminarem
+	void wait();
+
+	// Executa body(i) para i em [0, count), distribuído entre as threads
+	void parallelFor(int count, const std::function<void(int)>& body);
+
+	int getNbThreads() const { return (int)workers.size(); }
+
+	// Pool compartilhado pelos utilitários de Common (criado no primeiro uso)
+	static ThreadPool& shared();
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	void workerLoop();
+
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable taskAvailable;
+	std::condition_variable allDone;
+	int pending;
+	bool stopping;
+};
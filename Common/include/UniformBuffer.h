@@ -0,0 +1,95 @@
+// Uniform buffer objects (blocos std140) compartilhados entre programas
+// Cada bloco tem um ponto de ligação fixo; todos os programas que declaram o bloco leem
+// do mesmo buffer, então o estado comum (câmera, luz) é gravado uma vez por quadro com
+// uma única escrita, não uma vez por programa e por uniform. Um buffer pode guardar
+// várias cópias do bloco (uma por material, por exemplo); trocar de cópia é só mudar o
+// intervalo ligado com glBindBufferRange.
+
+#pragma once
+
+#include <cstddef>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+// Pontos de ligação usados pelos shaders
+enum UniformBlockBinding
+{
+	PER_FRAME_BINDING = 0,
+	PER_LIGHT_BINDING = 1,
+	PER_MATERIAL_BINDING = 2
+};
+
+// Mesmo layout std140 dos blocos em GLSL: vec3 ocupa 16 bytes, a não ser que um float venha logo depois
+struct PerFrameBlock
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 cameraPos;
+	float pad0;
+};
+
+struct PerLightBlock
+{
+	glm::vec3 lightPos;
+	float pad0;
+	glm::vec3 lightColor;
+	float pad1;
+};
+
+struct PerMaterialBlock
+{
+	glm::vec3 ka;
+	float q;
+	glm::vec3 kd;
+	float d;
+	glm::vec3 ks;
+	float pad0;
+	glm::vec3 ke;
+	float pad1;
+};
+
+static_assert(sizeof(PerFrameBlock) == 144, "PerFrameBlock deve seguir o layout std140");
+static_assert(sizeof(PerLightBlock) == 32, "PerLightBlock deve seguir o layout std140");
+static_assert(sizeof(PerMaterialBlock) == 64, "PerMaterialBlock deve seguir o layout std140");
+
+class UniformBuffer
+{
+public:
+	UniformBuffer();
+
+	// Cria o buffer com nBlocks cópias de blockSize bytes, alinhadas como a OpenGL exige,
+	// e liga a primeira ao ponto 'binding'
+	void initialize(GLuint binding, size_t blockSize, int nBlocks = 1);
+	// Apaga o buffer; chamar antes de glfwTerminate, com o contexto ainda ativo
+	void release();
+
+	// Liga o bloco 'blockName' do programa a este ponto; false se o programa não usa o bloco
+	bool bindToProgram(GLuint program, const char* blockName) const;
+
+	// Grava uma cópia inteira do bloco com uma única chamada
+	void update(const void* data, int block = 0);
+
+	// Passa a ler a cópia 'block' (não faz nada se ela já estiver ligada)
+	void bind(int block = 0);
+
+	GLuint getBinding() const { return binding; }
+	int getNbBlocks() const { return nBlocks; }
+	size_t getBlockStride() const { return blockStride; }
+	int getNbUpdates() const { return nUpdates; }
+
+private:
+	UniformBuffer(const UniformBuffer&);
+	UniformBuffer& operator=(const UniformBuffer&);
+
+	GLuint buffer;
+	GLuint binding;
+	size_t blockSize;
+	size_t blockStride;
+	int nBlocks;
+	int boundBlock;
+	int nUpdates;
+};
@@ -0,0 +1,326 @@
+#include "AsyncTextureLoader.h"
+
+#include <iostream>
+#include <cstring>
+
+#include "CookedTexture.h"
+#include "MappedFile.h"
+#include "stb_image.h"
+
+// Roda nas threads do pool: usa o .texbin se estiver atualizado, senão decodifica a imagem.
+// O arquivo original é lido uma vez só, para o hash do conteúdo e para o stb_image.
+static void decodeTexture(AsyncTextureLoader::Job& job)
+{
+	MappedFile file;
+	if (file.open(job.path.c_str()))
+		job.contentHash = hashBytes(file.data(), file.size());
+
+	CookedTexture cooked;
+	if (cooked.load(job.path))
+	{
+		for (int level = 0; level < cooked.getNbLevels(); level++)
+		{
+			const unsigned char* data = cooked.getLevel(level);
+			size_t size = (size_t)cooked.getWidth(level) * cooked.getHeight(level) * 4;
+			job.levels.push_back(std::vector<unsigned char>(data, data + size));
+			job.widths.push_back(cooked.getWidth(level));
+			job.heights.push_back(cooked.getHeight(level));
+		}
+		job.hasMipmaps = true;
+		return;
+	}
+
+	int width, height, nrChannels;
+	unsigned char* data = file.isOpen() ? stbi_load_from_memory((const stbi_uc*)file.data(), (int)file.size(), &width, &height, &nrChannels, 4) : nullptr;
+	if (!data)
+	{
+		job.failed = true;
+		return;
+	}
+
+	job.levels.push_back(std::vector<unsigned char>(data, data + (size_t)width * height * 4));
+	job.widths.push_back(width);
+	job.heights.push_back(height);
+	stbi_image_free(data);
+}
+
+AsyncTextureLoader::AsyncTextureLoader()
+	: pool(nullptr), pbo(0), bytesPerFrame(0), uploadedBytes(0), nPending(0)
+{
+	setPlaceholderColor(200, 200, 200);
+}
+
+void AsyncTextureLoader::release()
+{
+	if (pbo)
+		glDeleteBuffers(1, &pbo);
+	pbo = 0;
+	uploading.clear();
+	pending.clear();
+	textureBytes.clear();
+	contentHashes.clear();
+	nPending = 0;
+	// As tarefas ainda na fila do pool seguram a fila antiga e terminam nela
+	decoded.reset();
+}
+
+void AsyncTextureLoader::initialize(size_t bytesPerFrame, ThreadPool* pool)
+{
+	this->bytesPerFrame = bytesPerFrame;
+	this->pool = pool ? pool : &ThreadPool::shared();
+	decoded = std::make_shared<DecodedQueue>();
+	if (!pbo)
+		glGenBuffers(1, &pbo);
+}
+
+void AsyncTextureLoader::setPlaceholderColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
+{
+	placeholder[0] = r;
+	placeholder[1] = g;
+	placeholder[2] = b;
+	placeholder[3] = a;
+}
+
+GLuint AsyncTextureLoader::load(const std::string& path)
+{
+	GLuint textureID;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	Job* job = new Job();
+	job->textureID = textureID;
+	job->path = path;
+	job->failed = false;
+	job->hasMipmaps = false;
+	job->contentHash = 0;
+	job->level = 0;
+	job->row = 0;
+	pending.insert(textureID);
+	nPending++;
+
+	// A tarefa guarda a fila por shared_ptr: se o loader for destruído antes, o resultado é descartado
+	std::shared_ptr<DecodedQueue> queue = decoded;
+	pool->submit([queue, job] {
+		std::unique_ptr<Job> owned(job);
+		decodeTexture(*owned);
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->jobs.push_back(std::move(owned));
+	});
+
+	return textureID;
+}
+
+// Aloca os níveis no tamanho final e deixa a textura amostrando um nível 1x1 com a cor de espera
+void AsyncTextureLoader::beginUpload(Job& job)
+{
+	if (job.failed)
+		return;
+
+	int width = job.widths[0];
+	int height = job.heights[0];
+	int lastLevel = 0;
+	while ((width >> lastLevel) > 1 || (height >> lastLevel) > 1)
+		lastLevel++;
+
+	// Cadeia completa de mipmaps: cerca de 4/3 do nível 0
+	textureBytes[job.textureID] = (size_t)width * height * 4 * 4 / 3;
+
+	glBindTexture(GL_TEXTURE_2D, job.textureID);
+	for (size_t level = 0; level < job.levels.size(); level++)
+		glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA, job.widths[level], job.heights[level], 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	if (lastLevel > 0)
+	{
+		glTexImage2D(GL_TEXTURE_2D, lastLevel, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, lastLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, lastLevel);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void AsyncTextureLoader::finishUpload(Job& job)
+{
+	glBindTexture(GL_TEXTURE_2D, job.textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+	if (!job.hasMipmaps)
+		glGenerateMipmap(GL_TEXTURE_2D);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Trecho de linhas de um nível, copiado para o PBO em 'offset'
+struct UploadBand
+{
+	AsyncTextureLoader::Job* job;
+	int level;
+	int row;
+	int nRows;
+	size_t offset;
+};
+
+int AsyncTextureLoader::update()
+{
+	if (!decoded)
+		return 0;
+
+	{
+		std::lock_guard<std::mutex> lock(decoded->mutex);
+		while (!decoded->jobs.empty())
+		{
+			std::unique_ptr<Job> job = std::move(decoded->jobs.front());
+			decoded->jobs.pop_front();
+
+			// Descartada com unload enquanto era decodificada
+			if (!pending.count(job->textureID))
+				continue;
+			if (!job->failed && job->contentHash)
+				contentHashes[job->textureID] = job->contentHash;
+			uploading.push_back(std::move(job));
+			beginUpload(*uploading.back());
+		}
+	}
+
+	// Escolhe os trechos deste quadro: linhas inteiras até o limite de bytes
+	// (uma linha maior que o limite é enviada sozinha, para sempre haver progresso)
+	std::vector<UploadBand> bands;
+	size_t total = 0;
+	bool full = false;
+	for (size_t i = 0; i < uploading.size() && !full; i++)
+	{
+		Job& job = *uploading[i];
+		if (job.failed)
+			continue;
+
+		int level = job.level;
+		int row = job.row;
+		while (level < (int)job.levels.size() && !full)
+		{
+			size_t rowBytes = (size_t)job.widths[level] * 4;
+			int nRows = total < bytesPerFrame ? (int)((bytesPerFrame - total) / rowBytes) : 0;
+			if (nRows == 0)
+			{
+				if (!bands.empty())
+					break;
+				nRows = 1;
+			}
+			if (nRows > job.heights[level] - row)
+				nRows = job.heights[level] - row;
+
+			UploadBand band = { &job, level, row, nRows, total };
+			bands.push_back(band);
+			total += nRows * rowBytes;
+
+			row += nRows;
+			if (row == job.heights[level])
+			{
+				level++;
+				row = 0;
+			}
+			full = total >= bytesPerFrame;
+		}
+		if (level < (int)job.levels.size())
+			full = true;
+	}
+
+	if (!bands.empty())
+	{
+		// Buffer novo a cada quadro (orphaning): o driver não precisa esperar o envio anterior
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, total, nullptr, GL_STREAM_DRAW);
+		char* staging = (char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (staging)
+		{
+			for (size_t b = 0; b < bands.size(); b++)
+			{
+				const UploadBand& band = bands[b];
+				size_t rowBytes = (size_t)band.job->widths[band.level] * 4;
+				memcpy(staging + band.offset, band.job->levels[band.level].data() + band.row * rowBytes, band.nRows * rowBytes);
+			}
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+		else
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		for (size_t b = 0; b < bands.size(); b++)
+		{
+			const UploadBand& band = bands[b];
+			Job& job = *band.job;
+			size_t rowBytes = (size_t)job.widths[band.level] * 4;
+			const void* source = staging ? (const void*)band.offset : (const void*)(job.levels[band.level].data() + band.row * rowBytes);
+
+			glBindTexture(GL_TEXTURE_2D, job.textureID);
+			glTexSubImage2D(GL_TEXTURE_2D, band.level, 0, band.row, job.widths[band.level], band.nRows, GL_RGBA, GL_UNSIGNED_BYTE, source);
+
+			job.level = band.level;
+			job.row = band.row + band.nRows;
+			if (job.row == job.heights[band.level])
+			{
+				job.level++;
+				job.row = 0;
+			}
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		uploadedBytes += total;
+	}
+
+	// Texturas que terminaram (ou falharam) saem da fila
+	int nCompleted = 0;
+	for (size_t i = 0; i < uploading.size();)
+	{
+		Job& job = *uploading[i];
+		if (job.failed)
+			std::cout << "Failed to load texture " << job.path << std::endl;
+		else if (job.level < (int)job.levels.size())
+		{
+			i++;
+			continue;
+		}
+		else
+		{
+			finishUpload(job);
+			nCompleted++;
+		}
+
+		pending.erase(job.textureID);
+		uploading.erase(uploading.begin() + i);
+		nPending--;
+	}
+	return nCompleted;
+}
+
+void AsyncTextureLoader::unload(GLuint textureID)
+{
+	if (pending.erase(textureID))
+	{
+		nPending--;
+		for (size_t i = 0; i < uploading.size(); i++)
+			if (uploading[i]->textureID == textureID)
+			{
+				uploading.erase(uploading.begin() + i);
+				break;
+			}
+	}
+	textureBytes.erase(textureID);
+	contentHashes.erase(textureID);
+	glDeleteTextures(1, &textureID);
+}
+
+size_t AsyncTextureLoader::getTextureBytes(GLuint textureID) const
+{
+	std::map<GLuint, size_t>::const_iterator it = textureBytes.find(textureID);
+	return it != textureBytes.end() ? it->second : 0;
+}
+
+uint64_t AsyncTextureLoader::getContentHash(GLuint textureID) const
+{
+	std::map<GLuint, uint64_t>::const_iterator it = contentHashes.find(textureID);
+	return it != contentHashes.end() ? it->second : 0;
+}
@@ -0,0 +1,110 @@
+#include "CookedTexture.h"
+
+#include <cstring>
+
+static const char cookedTextureMagic[8] = { 'T', 'E', 'X', 'B', 'I', 'N', 0, 0 };
+static const uint32_t cookedTextureVersion = 1;
+
+static int levelSize(int size, int level)
+{
+	size >>= level;
+	return size > 0 ? size : 1;
+}
+
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + 15) & ~(uint64_t)15;
+}
+
+CookedTexture::CookedTexture()
+	: header(nullptr)
+{
+}
+
+void CookedTexture::clear()
+{
+	file.close();
+	header = nullptr;
+}
+
+int CookedTexture::getWidth(int level) const
+{
+	return levelSize((int)header->width, level);
+}
+
+int CookedTexture::getHeight(int level) const
+{
+	return levelSize((int)header->height, level);
+}
+
+std::string CookedTexture::getCachePath(const std::string& imagePath)
+{
+	return imagePath + ".texbin";
+}
+
+bool CookedTexture::load(const std::string& imagePath)
+{
+	clear();
+
+	if (!file.open(getCachePath(imagePath).c_str()) || file.size() < sizeof(CookedTextureHeader))
+	{
+		clear();
+		return false;
+	}
+
+	const CookedTextureHeader* h = (const CookedTextureHeader*)file.data();
+	bool valid = memcmp(h->magic, cookedTextureMagic, sizeof(h->magic)) == 0 && h->version == cookedTextureVersion
+		&& h->fileSize == file.size() && h->nLevels >= 1 && h->nLevels <= MAX_TEXTURE_LEVELS
+		&& h->width > 0 && h->height > 0;
+
+	for (uint32_t i = 0; valid && i < h->nLevels; i++)
+	{
+		uint64_t bytes = (uint64_t)levelSize((int)h->width, i) * levelSize((int)h->height, i) * 4;
+		valid = h->levelOffsets[i] + bytes <= h->fileSize;
+	}
+
+	// Sem a imagem original o arquivo cozido é usado como está
+	FileStamp current;
+	if (valid && getFileStamp(imagePath, current))
+		valid = matchesFileStamp(imagePath, h->source);
+
+	if (!valid)
+	{
+		clear();
+		return false;
+	}
+	header = h;
+	return true;
+}
+
+bool CookedTexture::isUpToDate(const std::string& imagePath)
+{
+	CookedTexture texture;
+	return texture.load(imagePath);
+}
+
+void CookedTexture::serialize(const std::vector<std::vector<unsigned char>>& levels, int width, int height,
+	const FileStamp& source, std::vector<char>& blob)
+{
+	CookedTextureHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, cookedTextureMagic, sizeof(h.magic));
+	h.version = cookedTextureVersion;
+	h.nLevels = (uint32_t)(levels.size() < (size_t)MAX_TEXTURE_LEVELS ? levels.size() : MAX_TEXTURE_LEVELS);
+	h.source = source;
+	h.width = (uint32_t)width;
+	h.height = (uint32_t)height;
+
+	uint64_t offset = alignOffset(sizeof(h));
+	for (uint32_t i = 0; i < h.nLevels; i++)
+	{
+		h.levelOffsets[i] = offset;
+		offset = alignOffset(offset + levels[i].size());
+	}
+	h.fileSize = offset;
+
+	blob.assign((size_t)h.fileSize, 0);
+	memcpy(blob.data(), &h, sizeof(h));
+	for (uint32_t i = 0; i < h.nLevels; i++)
+		memcpy(blob.data() + h.levelOffsets[i], levels[i].data(), levels[i].size());
+}
@@ -0,0 +1,87 @@
+#include "CurveEval.h"
+
+// SSE faz parte de todo alvo x64 (e do x86 com /arch:SSE ou mais); nos demais fica o laço escalar
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define CURVE_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+#ifdef CURVE_USE_SSE
+// Coeficientes de uma coordenada repetidos nas 4 posições
+struct CubicLanes
+{
+	__m128 a, b, c, d;
+
+	void load(const glm::mat4x3& coefficients, int axis)
+	{
+		a = _mm_set1_ps(coefficients[0][axis]);
+		b = _mm_set1_ps(coefficients[1][axis]);
+		c = _mm_set1_ps(coefficients[2][axis]);
+		d = _mm_set1_ps(coefficients[3][axis]);
+	}
+
+	__m128 evaluate(__m128 t) const
+	{
+		return _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(a, t), b), t), c), t), d);
+	}
+};
+
+// Quatro pontos em x, y e z separados para x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+static inline void storePoints(__m128 x, __m128 y, __m128 z, glm::vec3* out)
+{
+	__m128 xyLow = _mm_unpacklo_ps(x, y);                         // x0 y0 x1 y1
+	__m128 xyHigh = _mm_unpackhi_ps(x, y);                        // x2 y2 x3 y3
+	__m128 zx01 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));  // z0 z0 x1 x1
+	__m128 yz11 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));  // y1 y1 z1 z1
+	__m128 zx23 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));  // z2 z2 x3 x3
+	__m128 yz33 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));  // y3 y3 z3 z3
+
+	float* f = &out[0].x;
+	_mm_storeu_ps(f, _mm_shuffle_ps(xyLow, zx01, _MM_SHUFFLE(2, 0, 1, 0)));
+	_mm_storeu_ps(f + 4, _mm_shuffle_ps(yz11, xyHigh, _MM_SHUFFLE(1, 0, 2, 0)));
+	_mm_storeu_ps(f + 8, _mm_shuffle_ps(zx23, yz33, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+#endif
+
+void evaluateCubic(const glm::mat4x3& coefficients, const float* t, int n, glm::vec3* out)
+{
+	int i = 0;
+#ifdef CURVE_USE_SSE
+	CubicLanes x, y, z;
+	x.load(coefficients, 0);
+	y.load(coefficients, 1);
+	z.load(coefficients, 2);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 t4 = _mm_loadu_ps(t + i);
+		storePoints(x.evaluate(t4), y.evaluate(t4), z.evaluate(t4), out + i);
+	}
+#endif
+	for (; i < n; i++)
+		out[i] = evaluateCubic(coefficients, t[i]);
+}
+
+void evaluateCubicUniform(const glm::mat4x3& coefficients, int nSteps, glm::vec3* out)
+{
+	int n = nSteps + 1;
+	int i = 0;
+#ifdef CURVE_USE_SSE
+	CubicLanes x, y, z;
+	x.load(coefficients, 0);
+	y.load(coefficients, 1);
+	z.load(coefficients, 2);
+
+	// t = k / nSteps com k inteiro (sem acumular passos), como no laço escalar
+	const __m128 steps = _mm_set1_ps((float)nSteps);
+	const __m128 four = _mm_set1_ps(4.0f);
+	__m128 k = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 t4 = _mm_div_ps(k, steps);
+		storePoints(x.evaluate(t4), y.evaluate(t4), z.evaluate(t4), out + i);
+		k = _mm_add_ps(k, four);
+	}
+#endif
+	for (; i < n; i++)
+		out[i] = evaluateCubic(coefficients, i / (float)nSteps);
+}
@@ -0,0 +1,230 @@
+#include "DebugDraw.h"
+
+#include <algorithm>
+#include <cstddef>
+
+static const char* debugVertexShader =
+	"#version 330 core\n"
+	"layout (location = 0) in vec3 position;\n"
+	"layout (location = 1) in vec4 color;\n"
+	"uniform mat4 viewProjection;\n"
+	"out vec4 vColor;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_Position = viewProjection * vec4(position, 1.0);\n"
+	"	vColor = color;\n"
+	"}\n";
+
+static const char* debugFragmentShader =
+	"#version 330 core\n"
+	"in vec4 vColor;\n"
+	"out vec4 color;\n"
+	"void main()\n"
+	"{\n"
+	"	color = vColor;\n"
+	"}\n";
+
+// Cantos de uma caixa: o bit 0 escolhe x, o bit 1 y e o bit 2 z (0 = mínimo, 1 = máximo);
+// cada aresta liga dois cantos que diferem em um bit só
+static const int boxEdgeCorners[12][2] = {
+	{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+	{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+	{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+};
+
+DebugDraw::DebugDraw()
+	: shader(nullptr), viewProjectionLocation(-1), VAO(0), maxVertices(0), nDropped(0)
+{
+}
+
+DebugDraw::~DebugDraw()
+{
+	release();
+}
+
+void DebugDraw::release()
+{
+	if (VAO)
+		glDeleteVertexArrays(1, &VAO);
+	if (shader)
+	{
+		glDeleteProgram(shader->ID);
+		delete shader;
+	}
+	VAO = 0;
+	shader = nullptr;
+	viewProjectionLocation = -1;
+	stream.release();
+	lines.clear();
+	points.clear();
+}
+
+void DebugDraw::initialize(int maxVertices)
+{
+	this->maxVertices = maxVertices;
+	if (!shader)
+		shader = new Shader(Shader::fromSource(debugVertexShader, debugFragmentShader));
+	viewProjectionLocation = glGetUniformLocation(shader->ID, "viewProjection");
+
+	stream.initialize(maxVertices * sizeof(DebugVertex));
+
+	// O VAO aponta para o início do buffer; cada desenho escolhe o primeiro vértice
+	if (VAO)
+		glDeleteVertexArrays(1, &VAO);
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, stream.getBuffer());
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DebugVertex), (GLvoid*)offsetof(DebugVertex, color));
+	glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	lines.reserve(maxVertices);
+	points.reserve(maxVertices / 8);
+}
+
+GLuint DebugDraw::packColor(const glm::vec4& color)
+{
+	glm::vec4 c = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+	return (GLuint)c.r | ((GLuint)c.g << 8) | ((GLuint)c.b << 16) | ((GLuint)c.a << 24);
+}
+
+void DebugDraw::line(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color)
+{
+	GLuint packed = packColor(color);
+	DebugVertex va = { a, packed };
+	DebugVertex vb = { b, packed };
+	lines.push_back(va);
+	lines.push_back(vb);
+}
+
+void DebugDraw::lineStrip(const glm::vec3* points, int n, const glm::vec4& color)
+{
+	GLuint packed = packColor(color);
+	for (int i = 1; i < n; i++)
+	{
+		DebugVertex va = { points[i - 1], packed };
+		DebugVertex vb = { points[i], packed };
+		lines.push_back(va);
+		lines.push_back(vb);
+	}
+}
+
+void DebugDraw::point(const glm::vec3& p, const glm::vec4& color)
+{
+	DebugVertex v = { p, packColor(color) };
+	points.push_back(v);
+}
+
+void DebugDraw::cross(const glm::vec3& p, float size, const glm::vec4& color)
+{
+	float h = size * 0.5f;
+	line(p - glm::vec3(h, 0.0f, 0.0f), p + glm::vec3(h, 0.0f, 0.0f), color);
+	line(p - glm::vec3(0.0f, h, 0.0f), p + glm::vec3(0.0f, h, 0.0f), color);
+	line(p - glm::vec3(0.0f, 0.0f, h), p + glm::vec3(0.0f, 0.0f, h), color);
+}
+
+void DebugDraw::boxEdges(const glm::vec3* corners, GLuint color)
+{
+	for (int e = 0; e < 12; e++)
+	{
+		DebugVertex va = { corners[boxEdgeCorners[e][0]], color };
+		DebugVertex vb = { corners[boxEdgeCorners[e][1]], color };
+		lines.push_back(va);
+		lines.push_back(vb);
+	}
+}
+
+void DebugDraw::box(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec4& color)
+{
+	glm::vec3 corners[8];
+	for (int i = 0; i < 8; i++)
+		corners[i] = glm::vec3(i & 1 ? boundsMax.x : boundsMin.x, i & 2 ? boundsMax.y : boundsMin.y, i & 4 ? boundsMax.z : boundsMin.z);
+	boxEdges(corners, packColor(color));
+}
+
+void DebugDraw::frustum(const glm::mat4& viewProjection, const glm::vec4& color)
+{
+	glm::mat4 inverse = glm::inverse(viewProjection);
+	glm::vec3 corners[8];
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 p = inverse * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f);
+		corners[i] = glm::vec3(p) / p.w;
+	}
+	boxEdges(corners, packColor(color));
+}
+
+void DebugDraw::bvh(const InstanceBVH& bvh, const glm::vec4& color, const glm::vec4& leafColor, int maxDepth)
+{
+	const std::vector<BVHNode>& nodes = bvh.getNodes();
+	if (nodes.empty())
+		return;
+
+	// Pilha de pares (nó, profundidade)
+	stack.clear();
+	stack.push_back(0);
+	stack.push_back(0);
+	while (!stack.empty())
+	{
+		int depth = stack.back();
+		stack.pop_back();
+		const BVHNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		box(node.boundsMin, node.boundsMax, node.count > 0 ? leafColor : color);
+		if (node.count > 0 || depth == maxDepth)
+			continue;
+		stack.push_back(node.leftFirst);
+		stack.push_back(depth + 1);
+		stack.push_back(node.leftFirst + 1);
+		stack.push_back(depth + 1);
+	}
+}
+
+void DebugDraw::flush(const glm::mat4& viewProjection)
+{
+	// O que não cabe na região do quadro fica de fora; as linhas têm prioridade e vão em pares
+	int nLineVertices = std::min((int)lines.size(), maxVertices) & ~1;
+	int nPointVertices = std::min((int)points.size(), maxVertices - nLineVertices);
+	nDropped = (int)(lines.size() + points.size()) - nLineVertices - nPointVertices;
+	if (nLineVertices + nPointVertices == 0 || !shader)
+	{
+		lines.clear();
+		points.clear();
+		return;
+	}
+
+	// Linhas e pontos em sequência no mesmo trecho: o deslocamento em vértices é o 'first' de cada desenho
+	stream.beginFrame();
+	GLintptr offset;
+	DebugVertex* vertices = (DebugVertex*)stream.map((nLineVertices + nPointVertices) * sizeof(DebugVertex), sizeof(DebugVertex), offset);
+	if (vertices)
+	{
+		std::copy(lines.begin(), lines.begin() + nLineVertices, vertices);
+		std::copy(points.begin(), points.begin() + nPointVertices, vertices + nLineVertices);
+		stream.unmap();
+
+		GLint program = 0, vertexArray = 0;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+
+		glUseProgram(shader->ID);
+		glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, &viewProjection[0][0]);
+		glBindVertexArray(VAO);
+		GLint first = (GLint)(offset / sizeof(DebugVertex));
+		if (nLineVertices > 0)
+			glDrawArrays(GL_LINES, first, nLineVertices);
+		if (nPointVertices > 0)
+			glDrawArrays(GL_POINTS, first + nLineVertices, nPointVertices);
+
+		glBindVertexArray(vertexArray);
+		glUseProgram(program);
+	}
+	stream.endFrame();
+
+	lines.clear();
+	points.clear();
+}
@@ -0,0 +1,219 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+// SSE faz parte de todo alvo x64 (e do x86 com /arch:SSE ou mais); nos demais fica o laço escalar
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define FRUSTUM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+void transformBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model,
+	glm::vec3& worldMin, glm::vec3& worldMax)
+{
+	// Método de Arvo: o centro é transformado e a meia extensão passa pelos valores absolutos da parte 3x3
+	glm::vec3 center = glm::vec3(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+	glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+	glm::vec3 worldExtent;
+	for (int i = 0; i < 3; i++)
+		worldExtent[i] = std::fabs(model[0][i]) * extent.x + std::fabs(model[1][i]) * extent.y + std::fabs(model[2][i]) * extent.z;
+	worldMin = center - worldExtent;
+	worldMax = center + worldExtent;
+}
+
+// ---------------------------------------------------------------------------
+// BoxList
+
+BoxList::BoxList()
+	: nBoxes(0)
+{
+}
+
+void BoxList::reserve(int nBoxes)
+{
+	size_t capacity = ((size_t)nBoxes + 3) & ~(size_t)3;
+	cx.reserve(capacity);
+	cy.reserve(capacity);
+	cz.reserve(capacity);
+	ex.reserve(capacity);
+	ey.reserve(capacity);
+	ez.reserve(capacity);
+}
+
+void BoxList::push(const glm::vec3& center, const glm::vec3& extent)
+{
+	// Os arrays crescem em blocos de 4 caixas vazias, para o laço SIMD nunca ler além do fim
+	if ((size_t)nBoxes == cx.size())
+	{
+		size_t size = cx.size() + 4;
+		cx.resize(size, 0.0f);
+		cy.resize(size, 0.0f);
+		cz.resize(size, 0.0f);
+		ex.resize(size, 0.0f);
+		ey.resize(size, 0.0f);
+		ez.resize(size, 0.0f);
+	}
+
+	cx[nBoxes] = center.x;
+	cy[nBoxes] = center.y;
+	cz[nBoxes] = center.z;
+	ex[nBoxes] = extent.x;
+	ey[nBoxes] = extent.y;
+	ez[nBoxes] = extent.z;
+	nBoxes++;
+}
+
+void BoxList::add(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	push((boundsMin + boundsMax) * 0.5f, (boundsMax - boundsMin) * 0.5f);
+}
+
+void BoxList::add(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model)
+{
+	glm::vec3 worldMin, worldMax;
+	transformBounds(boundsMin, boundsMax, model, worldMin, worldMax);
+	add(worldMin, worldMax);
+}
+
+// ---------------------------------------------------------------------------
+// Frustum
+
+Frustum::Frustum()
+	: nVisible(0), nCulled(0)
+{
+	for (int i = 0; i < FRUSTUM_NB_PLANES; i++)
+		planes[i] = glm::vec4(0.0f);
+}
+
+void Frustum::extract(const glm::mat4& viewProjection)
+{
+	// Linhas da matriz (a GLM guarda por colunas); o volume de recorte é -w <= x, y, z <= w
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	planes[FRUSTUM_LEFT] = rows[3] + rows[0];
+	planes[FRUSTUM_RIGHT] = rows[3] - rows[0];
+	planes[FRUSTUM_BOTTOM] = rows[3] + rows[1];
+	planes[FRUSTUM_TOP] = rows[3] - rows[1];
+	planes[FRUSTUM_NEAR] = rows[3] + rows[2];
+	planes[FRUSTUM_FAR] = rows[3] - rows[2];
+
+	// Normais unitárias: assim a distância ao plano pode ser comparada com raios e extensões
+	for (int i = 0; i < FRUSTUM_NB_PLANES; i++)
+	{
+		float length = glm::length(glm::vec3(planes[i]));
+		if (length > 0.0f)
+			planes[i] /= length;
+	}
+}
+
+bool Frustum::isSphereVisible(const glm::vec3& center, float radius) const
+{
+	for (int i = 0; i < FRUSTUM_NB_PLANES; i++)
+		if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+			return false;
+	return true;
+}
+
+bool Frustum::isBoxVisible(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+	for (int i = 0; i < FRUSTUM_NB_PLANES; i++)
+	{
+		glm::vec3 normal(planes[i]);
+		float radius = glm::dot(glm::abs(normal), extent);
+		if (glm::dot(normal, center) + planes[i].w < -radius)
+			return false;
+	}
+	return true;
+}
+
+FrustumTest Frustum::classifyBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+	FrustumTest result = FRUSTUM_INSIDE;
+	for (int i = 0; i < FRUSTUM_NB_PLANES; i++)
+	{
+		glm::vec3 normal(planes[i]);
+		float radius = glm::dot(glm::abs(normal), extent);
+		float distance = glm::dot(normal, center) + planes[i].w;
+		if (distance < -radius)
+			return FRUSTUM_OUTSIDE;
+		if (distance < radius)
+			result = FRUSTUM_INTERSECTS;
+	}
+	return result;
+}
+
+int Frustum::cull(const BoxList& boxes, std::vector<unsigned char>& visible)
+{
+	int n = boxes.size();
+	visible.resize(n);
+	int nInside = 0;
+
+#ifdef FRUSTUM_USE_SSE
+	// Componentes dos planos repetidos nas 4 posições; as normais também em valor absoluto
+	__m128 nx[FRUSTUM_NB_PLANES], ny[FRUSTUM_NB_PLANES], nz[FRUSTUM_NB_PLANES], d[FRUSTUM_NB_PLANES];
+	__m128 ax[FRUSTUM_NB_PLANES], ay[FRUSTUM_NB_PLANES], az[FRUSTUM_NB_PLANES];
+	for (int p = 0; p < FRUSTUM_NB_PLANES; p++)
+	{
+		nx[p] = _mm_set1_ps(planes[p].x);
+		ny[p] = _mm_set1_ps(planes[p].y);
+		nz[p] = _mm_set1_ps(planes[p].z);
+		d[p] = _mm_set1_ps(planes[p].w);
+		ax[p] = _mm_set1_ps(std::fabs(planes[p].x));
+		ay[p] = _mm_set1_ps(std::fabs(planes[p].y));
+		az[p] = _mm_set1_ps(std::fabs(planes[p].z));
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int i = 0; i < n; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&boxes.cx[i]);
+		__m128 cy = _mm_loadu_ps(&boxes.cy[i]);
+		__m128 cz = _mm_loadu_ps(&boxes.cz[i]);
+		__m128 ex = _mm_loadu_ps(&boxes.ex[i]);
+		__m128 ey = _mm_loadu_ps(&boxes.ey[i]);
+		__m128 ez = _mm_loadu_ps(&boxes.ez[i]);
+
+		__m128 outside = zero;
+		for (int p = 0; p < FRUSTUM_NB_PLANES; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+				_mm_add_ps(_mm_mul_ps(nz[p], cz), d[p]));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+		}
+
+		// Um bit por caixa; as posições além de n são só enchimento
+		int mask = _mm_movemask_ps(outside);
+		int last = n - i < 4 ? n - i : 4;
+		for (int k = 0; k < last; k++)
+		{
+			visible[i + k] = (mask >> k) & 1 ? 0 : 1;
+			nInside += visible[i + k];
+		}
+	}
+#else
+	for (int i = 0; i < n; i++)
+	{
+		bool inside = true;
+		for (int p = 0; p < FRUSTUM_NB_PLANES && inside; p++)
+		{
+			const glm::vec4& plane = planes[p];
+			float distance = plane.x * boxes.cx[i] + plane.y * boxes.cy[i] + plane.z * boxes.cz[i] + plane.w;
+			float radius = std::fabs(plane.x) * boxes.ex[i] + std::fabs(plane.y) * boxes.ey[i] + std::fabs(plane.z) * boxes.ez[i];
+			inside = distance + radius >= 0.0f;
+		}
+		visible[i] = inside ? 1 : 0;
+		nInside += visible[i];
+	}
+#endif
+
+	nVisible += nInside;
+	nCulled += n - nInside;
+	return nInside;
+}
@@ -0,0 +1,192 @@
+#include "HeadlessCapture.h"
+#include "PngWriter.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+static double nowMs()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void printHeadlessUsage()
+{
+	std::cout << "Modo sem janela: --headless [--frames N] [--out pasta] [--context native|egl|osmesa]" << std::endl;
+}
+
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--headless")
+			options.enabled = true;
+		else if (arg == "--frames" || arg == "--out" || arg == "--context")
+		{
+			if (i + 1 >= argc)
+			{
+				printHeadlessUsage();
+				return false;
+			}
+			std::string value = argv[++i];
+			if (arg == "--frames")
+				options.nFrames = atoi(value.c_str());
+			else if (arg == "--out")
+				options.outDir = value;
+			else
+				options.context = value;
+		}
+	}
+
+	if (options.nFrames <= 0 || (options.context != "native" && options.context != "egl" && options.context != "osmesa"))
+	{
+		printHeadlessUsage();
+		return false;
+	}
+	return true;
+}
+
+void setHeadlessWindowHints(const HeadlessOptions& options)
+{
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	if (options.context == "egl")
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+	else if (options.context == "osmesa")
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+	else
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_NATIVE_CONTEXT_API);
+}
+
+HeadlessCapture::HeadlessCapture()
+	: framebuffer(0), colorBuffer(0), depthBuffer(0), query(0), width(0), height(0), nFrames(0), frame(0),
+	frameTime(0.0), cpuStart(0.0), nFailed(0)
+{
+}
+
+void HeadlessCapture::release()
+{
+	if (query)
+		glDeleteQueries(1, &query);
+	if (depthBuffer)
+		glDeleteRenderbuffers(1, &depthBuffer);
+	if (colorBuffer)
+		glDeleteRenderbuffers(1, &colorBuffer);
+	if (framebuffer)
+		glDeleteFramebuffers(1, &framebuffer);
+	query = depthBuffer = colorBuffer = framebuffer = 0;
+}
+
+bool HeadlessCapture::initialize(const HeadlessOptions& options, int width, int height)
+{
+	this->width = width;
+	this->height = height;
+	nFrames = options.nFrames;
+	frameTime = options.frameTime;
+	outDir = options.outDir;
+	frame = 0;
+	nFailed = 0;
+	cpuMs.clear();
+	gpuMs.clear();
+	pixels.resize((size_t)width * height * 4);
+
+	// Só o último nível da pasta é criado; se já existir, o erro é ignorado
+	if (!outDir.empty() && outDir.back() != '/' && outDir.back() != '\\')
+		outDir += '/';
+#ifdef _WIN32
+	_mkdir(outDir.c_str());
+#else
+	mkdir(outDir.c_str(), 0755);
+#endif
+
+	glGenFramebuffers(1, &framebuffer);
+	glGenRenderbuffers(1, &colorBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Framebuffer do modo sem janela incompleto (0x" << std::hex << status << std::dec << ")" << std::endl;
+		return false;
+	}
+
+	// GL_TIME_ELAPSED é do núcleo desde a 3.3
+	glGenQueries(1, &query);
+
+	std::cout << "Modo sem janela: " << nFrames << " quadros de " << width << "x" << height << " em " << outDir << std::endl;
+	return true;
+}
+
+void HeadlessCapture::beginFrame()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, width, height);
+	cpuStart = nowMs();
+	glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void HeadlessCapture::endFrame()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	double cpu = nowMs() - cpuStart;
+
+	// A leitura espera a GPU terminar; o resultado da consulta já está disponível depois dela
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	GLuint64 elapsed = 0;
+	glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+	double gpu = elapsed / 1.0e6;
+	cpuMs.push_back(cpu);
+	gpuMs.push_back(gpu);
+
+	// A OpenGL lê de baixo para cima
+	char name[32];
+	snprintf(name, sizeof(name), "frame_%04d.png", frame);
+	bool written = writePng(outDir + name, width, height, 4, pixels.data(), true);
+	if (!written)
+		nFailed++;
+
+	printf("Quadro %d: CPU %.3f ms, GPU %.3f ms%s\n", frame, cpu, gpu, written ? "" : " (nao gravado)");
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	frame++;
+}
+
+static void printTimes(const char* label, std::vector<double> times)
+{
+	if (times.empty())
+		return;
+	std::sort(times.begin(), times.end());
+	double total = 0.0;
+	for (double t : times)
+		total += t;
+	printf("%s: media %.3f ms, minimo %.3f ms, mediana %.3f ms, maximo %.3f ms\n", label, total / times.size(),
+		times.front(), times[times.size() / 2], times.back());
+}
+
+int HeadlessCapture::finish()
+{
+	printf("%d quadros em %s (%d nao gravados)\n", frame, outDir.c_str(), nFailed);
+	printTimes("CPU", cpuMs);
+	printTimes("GPU", gpuMs);
+	return nFailed > 0 || frame < nFrames ? 1 : 0;
+}
@@ -0,0 +1,337 @@
+#include "InstanceBVH.h"
+
+#include <algorithm>
+#include <cfloat>
+
+static_assert(sizeof(BVHNode) == 32, "BVHNode deve ocupar meia linha de cache");
+
+// Faixas por eixo na busca da melhor divisão
+static const int bvhBins = 12;
+
+static float surfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	glm::vec3 e = boundsMax - boundsMin;
+	return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+// Distância de entrada na caixa pelo método das placas, ou FLT_MAX se o raio não a atinge antes de maxT
+static float intersectBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax, float maxT)
+{
+	glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+	glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+	float tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+	float tExit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+	return tEnter <= tExit && tEnter < maxT ? tEnter : FLT_MAX;
+}
+
+InstanceBVH::InstanceBVH()
+	: cost(0.0f), buildCost(0.0f), nNodesTested(0)
+{
+}
+
+void InstanceBVH::updateBounds(int nodeIndex)
+{
+	BVHNode& node = nodes[nodeIndex];
+	if (node.count == 0)
+	{
+		const BVHNode& left = nodes[node.leftFirst];
+		const BVHNode& right = nodes[node.leftFirst + 1];
+		node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+		node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+		return;
+	}
+
+	node.boundsMin = glm::vec3(FLT_MAX);
+	node.boundsMax = glm::vec3(-FLT_MAX);
+	for (int i = 0; i < node.count; i++)
+	{
+		int item = items[node.leftFirst + i];
+		node.boundsMin = glm::min(node.boundsMin, itemMin[item]);
+		node.boundsMax = glm::max(node.boundsMax, itemMax[item]);
+	}
+}
+
+// Melhor plano de divisão da folha: custo SAH (área x itens de cada lado) em bvhBins faixas dos centros
+float InstanceBVH::findSplit(const BVHNode& node, int& axis, float& position) const
+{
+	float bestCost = FLT_MAX;
+	glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+	for (int i = 0; i < node.count; i++)
+	{
+		const glm::vec3& c = centroids[items[node.leftFirst + i]];
+		centroidMin = glm::min(centroidMin, c);
+		centroidMax = glm::max(centroidMax, c);
+	}
+
+	for (int a = 0; a < 3; a++)
+	{
+		if (centroidMax[a] <= centroidMin[a])
+			continue;
+
+		glm::vec3 binMin[bvhBins], binMax[bvhBins];
+		int binCount[bvhBins];
+		for (int b = 0; b < bvhBins; b++)
+		{
+			binMin[b] = glm::vec3(FLT_MAX);
+			binMax[b] = glm::vec3(-FLT_MAX);
+			binCount[b] = 0;
+		}
+
+		float scale = bvhBins / (centroidMax[a] - centroidMin[a]);
+		for (int i = 0; i < node.count; i++)
+		{
+			int item = items[node.leftFirst + i];
+			int b = std::min(bvhBins - 1, (int)((centroids[item][a] - centroidMin[a]) * scale));
+			binCount[b]++;
+			binMin[b] = glm::min(binMin[b], itemMin[item]);
+			binMax[b] = glm::max(binMax[b], itemMax[item]);
+		}
+
+		// Varredura da esquerda e da direita: área e itens de cada lado de cada um dos bvhBins - 1 planos
+		float leftArea[bvhBins - 1], rightArea[bvhBins - 1];
+		int leftCount[bvhBins - 1], rightCount[bvhBins - 1];
+		glm::vec3 leftMin(FLT_MAX), leftMax(-FLT_MAX), rightMin(FLT_MAX), rightMax(-FLT_MAX);
+		int leftSum = 0, rightSum = 0;
+		for (int b = 0; b < bvhBins - 1; b++)
+		{
+			leftSum += binCount[b];
+			leftCount[b] = leftSum;
+			leftMin = glm::min(leftMin, binMin[b]);
+			leftMax = glm::max(leftMax, binMax[b]);
+			leftArea[b] = leftSum ? surfaceArea(leftMin, leftMax) : 0.0f;
+
+			int r = bvhBins - 1 - b;
+			rightSum += binCount[r];
+			rightCount[r - 1] = rightSum;
+			rightMin = glm::min(rightMin, binMin[r]);
+			rightMax = glm::max(rightMax, binMax[r]);
+			rightArea[r - 1] = rightSum ? surfaceArea(rightMin, rightMax) : 0.0f;
+		}
+
+		for (int b = 0; b < bvhBins - 1; b++)
+		{
+			float planeCost = leftCount[b] * leftArea[b] + rightCount[b] * rightArea[b];
+			if (leftCount[b] > 0 && rightCount[b] > 0 && planeCost < bestCost)
+			{
+				bestCost = planeCost;
+				axis = a;
+				position = centroidMin[a] + (b + 1) / scale;
+			}
+		}
+	}
+	return bestCost;
+}
+
+void InstanceBVH::build(const glm::vec3* boundsMin, const glm::vec3* boundsMax, int n)
+{
+	nodes.clear();
+	items.resize(n);
+	itemMin.assign(boundsMin, boundsMin + n);
+	itemMax.assign(boundsMax, boundsMax + n);
+	centroids.resize(n);
+	for (int i = 0; i < n; i++)
+	{
+		items[i] = i;
+		centroids[i] = (boundsMin[i] + boundsMax[i]) * 0.5f;
+	}
+	cost = buildCost = 0.0f;
+	if (n == 0)
+		return;
+
+	// Uma árvore binária com n folhas tem no máximo 2n - 1 nós: o array não realoca durante a construção
+	nodes.reserve(2 * n - 1);
+	BVHNode root;
+	root.leftFirst = 0;
+	root.count = n;
+	nodes.push_back(root);
+	updateBounds(0);
+
+	// Pilha explícita: uma cena degenerada não estoura a pilha de chamadas
+	std::vector<int> stack(1, 0);
+	while (!stack.empty())
+	{
+		int nodeIndex = stack.back();
+		stack.pop_back();
+		BVHNode node = nodes[nodeIndex];
+		if (node.count <= 1)
+			continue;
+
+		// Divide só se visitar o nó interno e os dois filhos sair mais barato que testar todos os itens da folha
+		int axis = 0;
+		float position = 0.0f;
+		float area = surfaceArea(node.boundsMin, node.boundsMax);
+		float splitCost = findSplit(node, axis, position);
+		if (splitCost + area >= node.count * area)
+			continue;
+
+		int* first = &items[node.leftFirst];
+		int* middle = std::partition(first, first + node.count,
+			[this, axis, position](int item) { return centroids[item][axis] < position; });
+		int leftCount = (int)(middle - first);
+		if (leftCount == 0 || leftCount == node.count)
+			continue;
+
+		int leftIndex = (int)nodes.size();
+		BVHNode left, right;
+		left.leftFirst = node.leftFirst;
+		left.count = leftCount;
+		right.leftFirst = node.leftFirst + leftCount;
+		right.count = node.count - leftCount;
+		nodes.push_back(left);
+		nodes.push_back(right);
+		nodes[nodeIndex].leftFirst = leftIndex;
+		nodes[nodeIndex].count = 0;
+		updateBounds(leftIndex);
+		updateBounds(leftIndex + 1);
+		stack.push_back(leftIndex);
+		stack.push_back(leftIndex + 1);
+	}
+
+	cost = buildCost = computeCost();
+}
+
+void InstanceBVH::refit(const glm::vec3* boundsMin, const glm::vec3* boundsMax)
+{
+	int n = (int)itemMin.size();
+	std::copy(boundsMin, boundsMin + n, itemMin.begin());
+	std::copy(boundsMax, boundsMax + n, itemMax.begin());
+	for (int i = 0; i < n; i++)
+		centroids[i] = (boundsMin[i] + boundsMax[i]) * 0.5f;
+
+	// Os filhos ficam depois do pai: percorrer o array de trás para frente já é de baixo para cima
+	for (int i = (int)nodes.size() - 1; i >= 0; i--)
+		updateBounds(i);
+	cost = computeCost();
+}
+
+// Custo SAH relativo à raiz: área de cada nó interno mais área x itens de cada folha
+float InstanceBVH::computeCost() const
+{
+	if (nodes.empty())
+		return 0.0f;
+	float rootArea = surfaceArea(nodes[0].boundsMin, nodes[0].boundsMax);
+	if (rootArea <= 0.0f)
+		return 0.0f;
+
+	float total = 0.0f;
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		float area = surfaceArea(nodes[i].boundsMin, nodes[i].boundsMax);
+		total += nodes[i].count ? area * nodes[i].count : area;
+	}
+	return total / rootArea;
+}
+
+int InstanceBVH::cull(const Frustum& frustum, std::vector<int>& visible)
+{
+	visible.clear();
+	nNodesTested = 0;
+	if (nodes.empty())
+		return 0;
+
+	// Cada entrada guarda o nó e se ele já está inteiramente dentro (nesse caso nada abaixo é testado)
+	struct Entry
+	{
+		int node;
+		bool inside;
+	};
+	std::vector<Entry> stack;
+	stack.reserve(64);
+	Entry root = { 0, false };
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		Entry entry = stack.back();
+		stack.pop_back();
+
+		const BVHNode& node = nodes[entry.node];
+		bool inside = entry.inside;
+		if (!inside)
+		{
+			nNodesTested++;
+			FrustumTest test = frustum.classifyBox(node.boundsMin, node.boundsMax);
+			if (test == FRUSTUM_OUTSIDE)
+				continue;
+			inside = test == FRUSTUM_INSIDE;
+		}
+
+		if (node.count > 0)
+		{
+			// Numa folha cortada pelo volume, cada item ainda é testado
+			for (int i = 0; i < node.count; i++)
+			{
+				int item = items[node.leftFirst + i];
+				if (inside || node.count == 1 || frustum.isBoxVisible(itemMin[item], itemMax[item]))
+					visible.push_back(item);
+			}
+			continue;
+		}
+
+		Entry left = { node.leftFirst, inside };
+		Entry right = { node.leftFirst + 1, inside };
+		stack.push_back(right);
+		stack.push_back(left);
+	}
+	return (int)visible.size();
+}
+
+int InstanceBVH::intersectRay(const glm::vec3& origin, const glm::vec3& direction, float* distance) const
+{
+	if (nodes.empty())
+		return -1;
+
+	// Componentes nulas viram infinito: as placas paralelas ao raio ficam sem limite
+	glm::vec3 inverseDirection;
+	for (int i = 0; i < 3; i++)
+		inverseDirection[i] = direction[i] != 0.0f ? 1.0f / direction[i] : FLT_MAX;
+
+	float best = FLT_MAX;
+	int bestItem = -1;
+	std::vector<int> stack;
+	stack.reserve(64);
+	if (intersectBox(origin, inverseDirection, nodes[0].boundsMin, nodes[0].boundsMax, best) != FLT_MAX)
+		stack.push_back(0);
+
+	while (!stack.empty())
+	{
+		const BVHNode& node = nodes[stack.back()];
+		stack.pop_back();
+
+		if (node.count > 0)
+		{
+			for (int i = 0; i < node.count; i++)
+			{
+				int item = items[node.leftFirst + i];
+				float t = intersectBox(origin, inverseDirection, itemMin[item], itemMax[item], best);
+				if (t < best)
+				{
+					best = t;
+					bestItem = item;
+				}
+			}
+			continue;
+		}
+
+		// O filho mais próximo é visitado primeiro, e um nó que começa depois do melhor acerto é descartado
+		int nearChild = node.leftFirst;
+		int farChild = node.leftFirst + 1;
+		float tNear = intersectBox(origin, inverseDirection, nodes[nearChild].boundsMin, nodes[nearChild].boundsMax, best);
+		float tFar = intersectBox(origin, inverseDirection, nodes[farChild].boundsMin, nodes[farChild].boundsMax, best);
+		if (tFar < tNear)
+		{
+			std::swap(nearChild, farChild);
+			std::swap(tNear, tFar);
+		}
+		if (tFar != FLT_MAX)
+			stack.push_back(farChild);
+		if (tNear != FLT_MAX)
+			stack.push_back(nearChild);
+	}
+
+	if (distance && bestItem >= 0)
+		*distance = best;
+	return bestItem;
+}
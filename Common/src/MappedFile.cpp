@@ -0,0 +1,211 @@
+#include "MappedFile.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Arquivos vazios não podem ser mapeados; usamos este buffer no lugar
+static const char emptyFile[1] = { 0 };
+
+MappedFile::MappedFile()
+	: ptr(nullptr), length(0)
+#ifdef _WIN32
+	, fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#else
+	, fd(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char* path)
+{
+	close();
+
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		close();
+		return false;
+	}
+
+	length = (size_t)fileSize.QuadPart;
+	if (length == 0)
+	{
+		ptr = emptyFile;
+		return true;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	ptr = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (ptr == nullptr)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (ptr != nullptr && ptr != emptyFile)
+		UnmapViewOfFile(ptr);
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+
+	ptr = nullptr;
+	length = 0;
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const char* path)
+{
+	close();
+
+	fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close();
+		return false;
+	}
+
+	length = (size_t)st.st_size;
+	if (length == 0)
+	{
+		ptr = emptyFile;
+		return true;
+	}
+
+	void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+	madvise(p, length, MADV_SEQUENTIAL);
+	ptr = (const char*)p;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (ptr != nullptr && ptr != emptyFile)
+		munmap((void*)ptr, length);
+	if (fd >= 0)
+		::close(fd);
+
+	ptr = nullptr;
+	length = 0;
+	fd = -1;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Identificação de arquivos
+
+bool getFileStamp(const std::string& path, FileStamp& stamp)
+{
+#ifdef _WIN32
+	struct _stat64 st;
+	if (_stat64(path.c_str(), &st) != 0)
+		return false;
+#else
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0)
+		return false;
+#endif
+	stamp.size = (uint64_t)st.st_size;
+	stamp.time = (int64_t)st.st_mtime;
+	stamp.hash = 0;
+	return true;
+}
+
+uint64_t hashBytes(const char* data, size_t size)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool hashFile(const std::string& path, uint64_t& hash)
+{
+	MappedFile file;
+	if (!file.open(path.c_str()))
+		return false;
+	hash = hashBytes(file.data(), file.size());
+	return true;
+}
+
+bool matchesFileStamp(const std::string& path, const FileStamp& recorded)
+{
+	FileStamp current;
+	if (!getFileStamp(path, current) || current.size != recorded.size)
+		return false;
+	if (current.time == recorded.time)
+		return true;
+
+	uint64_t hash;
+	return hashFile(path, hash) && hash == recorded.hash;
+}
+
+bool writeFileAtomically(const std::string& path, const char* data, size_t size)
+{
+	std::string tempPath = path + ".tmp";
+	FILE* f = fopen(tempPath.c_str(), "wb");
+	if (!f)
+		return false;
+
+	bool ok = fwrite(data, 1, size, f) == size;
+	ok = (fclose(f) == 0) && ok;
+
+#ifdef _WIN32
+	ok = ok && MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	ok = ok && rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+	if (!ok)
+		remove(tempPath.c_str());
+	return ok;
+}
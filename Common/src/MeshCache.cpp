@@ -0,0 +1,269 @@
+#include "MeshCache.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+
+//GLM
+#include <glm/gtc/packing.hpp>
+
+static const char meshCacheMagic[8] = { 'M', 'E', 'S', 'H', 'B', 'I', 'N', 0 };
+static const uint32_t meshCacheVersion = 4;
+
+static_assert(sizeof(SubMesh) == 52, "SubMesh é gravado diretamente no .meshbin");
+
+// ---------------------------------------------------------------------------
+// Escrita
+
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + 15) & ~(uint64_t)15;
+}
+
+static uint32_t getStride(uint32_t vertexFormat)
+{
+	return vertexFormat == MESH_VERTEX_QUANTIZED ? 24 : 8 * sizeof(float);
+}
+
+void MeshCache::serialize(const MeshData& mesh, const FileStamp& source, MeshVertexFormat vertexFormat, uint32_t flags, std::vector<char>& blob)
+{
+	MeshCacheHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, meshCacheMagic, sizeof(h.magic));
+	h.version = meshCacheVersion;
+	h.vertexStride = getStride(vertexFormat);
+	h.source = source;
+	h.vertexFormat = vertexFormat;
+	h.flags = flags;
+	h.nVertices = (uint32_t)(mesh.vertices.size() / 8);
+	h.nIndices = (uint32_t)mesh.indices.size();
+	h.indexSize = h.nVertices <= 65536 ? 2 : 4;
+	h.nSubMeshes = (uint32_t)mesh.subMeshes.size();
+	h.nMaterials = (uint32_t)mesh.materialNames.size();
+	for (int i = 0; i < 3; i++)
+	{
+		h.boundsMin[i] = mesh.boundsMin[i];
+		h.boundsMax[i] = mesh.boundsMax[i];
+	}
+	for (int i = 0; i < 4; i++)
+		h.sphere[i] = mesh.sphere[i];
+
+	std::string strings = mesh.mtlFileName;
+	strings.push_back('\0');
+	for (size_t i = 0; i < mesh.materialNames.size(); i++)
+	{
+		strings += mesh.materialNames[i];
+		strings.push_back('\0');
+	}
+
+	h.verticesOffset = alignOffset(sizeof(MeshCacheHeader));
+	h.indicesOffset = alignOffset(h.verticesOffset + (uint64_t)h.nVertices * h.vertexStride);
+	h.subMeshesOffset = alignOffset(h.indicesOffset + (uint64_t)h.nIndices * h.indexSize);
+	h.stringsOffset = alignOffset(h.subMeshesOffset + (uint64_t)h.nSubMeshes * sizeof(SubMesh));
+	h.stringsSize = strings.size();
+	h.fileSize = h.stringsOffset + h.stringsSize;
+
+	blob.assign((size_t)h.fileSize, 0);
+	char* out = blob.data();
+	memcpy(out, &h, sizeof(h));
+	if (vertexFormat == MESH_VERTEX_QUANTIZED)
+	{
+		// Textura em half float (2 x 16 bits) e normal em snorm16 (4 x 16 bits, o último sem uso)
+		char* vertex = out + h.verticesOffset;
+		for (size_t i = 0; i < mesh.vertices.size(); i += 8, vertex += h.vertexStride)
+		{
+			const float* v = &mesh.vertices[i];
+			uint32_t uv = glm::packHalf2x16(glm::vec2(v[3], v[4]));
+			uint64_t normal = glm::packSnorm4x16(glm::vec4(v[5], v[6], v[7], 0.0f));
+			memcpy(vertex, v, 3 * sizeof(float));
+			memcpy(vertex + 12, &uv, sizeof(uv));
+			memcpy(vertex + 16, &normal, sizeof(normal));
+		}
+	}
+	else
+		memcpy(out + h.verticesOffset, mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+
+	if (h.indexSize == 2)
+	{
+		uint16_t* shortIndices = (uint16_t*)(out + h.indicesOffset);
+		for (size_t i = 0; i < mesh.indices.size(); i++)
+			shortIndices[i] = (uint16_t)mesh.indices[i];
+	}
+	else
+		memcpy(out + h.indicesOffset, mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+
+	if (!mesh.subMeshes.empty())
+		memcpy(out + h.subMeshesOffset, mesh.subMeshes.data(), mesh.subMeshes.size() * sizeof(SubMesh));
+	memcpy(out + h.stringsOffset, strings.data(), strings.size());
+}
+
+// ---------------------------------------------------------------------------
+// Leitura
+
+MeshCache::MeshCache()
+	: base(nullptr), header(nullptr), cacheHit(false)
+{
+}
+
+void MeshCache::clear()
+{
+	file.close();
+	memory.clear();
+	base = nullptr;
+	header = nullptr;
+	mtlFileName.clear();
+	materialNames.clear();
+	cacheHit = false;
+}
+
+std::string MeshCache::getCachePath(const std::string& objPath)
+{
+	size_t slash = objPath.find_last_of("/\\");
+	size_t dot = objPath.find_last_of('.');
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		return objPath + ".meshbin";
+	return objPath.substr(0, dot) + ".meshbin";
+}
+
+// Confere o cabeçalho e os limites de cada seção antes de expor os ponteiros
+bool MeshCache::attach(const char* data, size_t size)
+{
+	base = nullptr;
+	header = nullptr;
+	mtlFileName.clear();
+	materialNames.clear();
+
+	if (size < sizeof(MeshCacheHeader))
+		return false;
+
+	const MeshCacheHeader* h = (const MeshCacheHeader*)data;
+	if (memcmp(h->magic, meshCacheMagic, sizeof(h->magic)) != 0 || h->version != meshCacheVersion)
+		return false;
+	if (h->fileSize != size || h->vertexFormat > MESH_VERTEX_QUANTIZED || h->vertexStride != getStride(h->vertexFormat)
+		|| (h->indexSize != 2 && h->indexSize != 4))
+		return false;
+	if (h->verticesOffset + (uint64_t)h->nVertices * h->vertexStride > size
+		|| h->indicesOffset + (uint64_t)h->nIndices * h->indexSize > size
+		|| h->subMeshesOffset + (uint64_t)h->nSubMeshes * sizeof(SubMesh) > size
+		|| h->stringsOffset + h->stringsSize > size)
+		return false;
+
+	// Submalhas e índices vão direto para glDrawElements: nada pode sair dos buffers
+	const SubMesh* subMeshes = (const SubMesh*)(data + h->subMeshesOffset);
+	for (uint32_t i = 0; i < h->nSubMeshes; i++)
+	{
+		if ((uint64_t)subMeshes[i].firstIndex + subMeshes[i].indexCount > h->nIndices
+			|| subMeshes[i].materialIndex < -1 || subMeshes[i].materialIndex >= (int64_t)h->nMaterials)
+			return false;
+	}
+	if (h->indexSize == 2)
+	{
+		const uint16_t* indices = (const uint16_t*)(data + h->indicesOffset);
+		for (uint32_t i = 0; i < h->nIndices; i++)
+			if (indices[i] >= h->nVertices)
+				return false;
+	}
+	else
+	{
+		const uint32_t* indices = (const uint32_t*)(data + h->indicesOffset);
+		for (uint32_t i = 0; i < h->nIndices; i++)
+			if (indices[i] >= h->nVertices)
+				return false;
+	}
+
+	// Strings: mtllib seguido de nMaterials nomes
+	const char* p = data + h->stringsOffset;
+	const char* end = p + h->stringsSize;
+	for (uint32_t i = 0; i <= h->nMaterials; i++)
+	{
+		const char* nameEnd = (const char*)memchr(p, 0, end - p);
+		if (nameEnd == nullptr)
+			return false;
+		if (i == 0)
+			mtlFileName.assign(p, nameEnd);
+		else
+			materialNames.push_back(std::string(p, nameEnd));
+		p = nameEnd + 1;
+	}
+
+	base = data;
+	header = h;
+	return true;
+}
+
+// Mapeia o .meshbin e confere se ainda corresponde ao OBJ
+bool MeshCache::openCache(const std::string& objPath, uint32_t requiredFlags)
+{
+	if (!file.open(getCachePath(objPath).c_str()) || !attach(file.data(), file.size()))
+		return false;
+	if ((header->flags & requiredFlags) != requiredFlags)
+		return false;
+
+	// Sem o OBJ o cache é usado como está (por exemplo, só os arquivos cozidos foram distribuídos)
+	FileStamp current;
+	if (!getFileStamp(objPath, current))
+		return true;
+	if (current.time == header->source.time)
+		return current.size == header->source.size;
+	if (!matchesFileStamp(objPath, header->source))
+		return false;
+
+	// Só a data mudou: grava a nova no .meshbin para não calcular o hash do OBJ a cada execução
+	restamp(objPath, current.time);
+	return file.open(getCachePath(objPath).c_str()) && attach(file.data(), file.size());
+}
+
+// Troca a data em MeshCacheHeader::source direto no arquivo. O mapeamento é fechado antes,
+// porque no Windows um arquivo mapeado não pode ser aberto para escrita.
+void MeshCache::restamp(const std::string& objPath, int64_t time)
+{
+	file.close();
+	base = nullptr;
+	header = nullptr;
+
+	std::string cachePath = getCachePath(objPath);
+	FILE* f = fopen(cachePath.c_str(), "r+b");
+	if (!f)
+		return;
+	long offset = (long)(offsetof(MeshCacheHeader, source) + offsetof(FileStamp, time));
+	if (fseek(f, offset, SEEK_SET) != 0 || fwrite(&time, sizeof(time), 1, f) != 1)
+		std::cout << "Nao foi possivel atualizar o cache " << cachePath << std::endl;
+	fclose(f);
+}
+
+bool MeshCache::isUpToDate(const std::string& objPath, uint32_t requiredFlags)
+{
+	MeshCache cache;
+	return cache.openCache(objPath, requiredFlags);
+}
+
+bool MeshCache::load(const std::string& objPath, int nThreads)
+{
+	clear();
+
+	if (openCache(objPath, 0))
+	{
+		cacheHit = true;
+		return true;
+	}
+	clear();
+
+	ObjData obj;
+	if (!loadObj(objPath, obj, nThreads))
+		return false;
+
+	MeshData mesh;
+	buildMeshData(obj, mesh);
+
+	FileStamp source;
+	getFileStamp(objPath, source);
+	hashFile(objPath, source.hash);
+
+	serialize(mesh, source, MESH_VERTEX_FLOAT, 0, memory);
+	std::string cachePath = getCachePath(objPath);
+	if (!writeFileAtomically(cachePath, memory.data(), memory.size()))
+		std::cout << "Nao foi possivel gravar o cache " << cachePath << std::endl;
+
+	return attach(memory.data(), memory.size());
+}
@@ -0,0 +1,82 @@
+#include "MtlLoader.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+bool loadMtl(const std::string& path, std::vector<Material>& materials)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+	{
+		std::cout << "Failed to open the file " << path << std::endl;
+		return false;
+	}
+
+	// Propriedades antes do primeiro newmtl valem para um material sem nome
+	Material* current = nullptr;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream iss(line);
+		std::string prefix;
+		if (!(iss >> prefix) || prefix[0] == '#')
+			continue;
+
+		if (prefix == "newmtl")
+		{
+			materials.push_back(Material());
+			current = &materials.back();
+			std::getline(iss >> std::ws, current->name);
+			while (!current->name.empty() && (current->name.back() == '\r' || current->name.back() == ' '))
+				current->name.pop_back();
+			continue;
+		}
+
+		if (current == nullptr)
+		{
+			materials.push_back(Material());
+			current = &materials.back();
+		}
+
+		if (prefix == "Ka")
+			iss >> current->ka.x >> current->ka.y >> current->ka.z;
+		else if (prefix == "Kd")
+			iss >> current->kd.x >> current->kd.y >> current->kd.z;
+		else if (prefix == "Ks")
+			iss >> current->ks.x >> current->ks.y >> current->ks.z;
+		else if (prefix == "Ke")
+			iss >> current->ke.x >> current->ke.y >> current->ke.z;
+		else if (prefix == "Ns")
+			iss >> current->ns;
+		else if (prefix == "Ni")
+			iss >> current->ni;
+		else if (prefix == "d")
+			iss >> current->d;
+		else if (prefix == "Tr")
+		{
+			float tr;
+			if (iss >> tr)
+				current->d = 1.0f - tr;
+		}
+		else if (prefix == "illum")
+			iss >> current->illum;
+		else if (prefix == "map_Kd")
+		{
+			// O nome do arquivo pode ter espaços; é o resto da linha
+			std::getline(iss >> std::ws, current->mapKd);
+			while (!current->mapKd.empty() && (current->mapKd.back() == '\r' || current->mapKd.back() == ' '))
+				current->mapKd.pop_back();
+		}
+	}
+
+	return true;
+}
+
+int findMaterial(const std::vector<Material>& materials, const std::string& name)
+{
+	for (size_t i = 0; i < materials.size(); i++)
+		if (materials[i].name == name)
+			return (int)i;
+	return -1;
+}
@@ -0,0 +1,718 @@
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+void ObjData::clear()
+{
+	positions.clear();
+	texCoords.clear();
+	normals.clear();
+	corners.clear();
+	groups.clear();
+	mtlFileName.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Scanner de números: trabalha direto sobre o texto mapeado
+
+static inline bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static inline const char* skipBlanks(const char* p, const char* end)
+{
+	while (p < end && isBlank(*p))
+		++p;
+	return p;
+}
+
+static inline const char* skipLine(const char* p, const char* end)
+{
+	while (p < end && *p != '\n')
+		++p;
+	return p < end ? p + 1 : p;
+}
+
+static const double powersOf10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+	1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const char* parseFloat(const char* p, const char* end, float& out)
+{
+	p = skipBlanks(p, end);
+
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		++p;
+	}
+
+	// Até 19 dígitos significativos cabem em 64 bits; o resto só ajusta o expoente
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+
+	while (p < end && isDigit(*p))
+	{
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+			if (mantissa != 0)
+				++digits;
+		}
+		else
+		{
+			++exponent;
+		}
+		++p;
+	}
+
+	if (p < end && *p == '.')
+	{
+		++p;
+		while (p < end && isDigit(*p))
+		{
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				--exponent;
+				if (mantissa != 0)
+					++digits;
+			}
+			++p;
+		}
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		++p;
+		bool negativeExp = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			negativeExp = (*p == '-');
+			++p;
+		}
+		int e = 0;
+		while (p < end && isDigit(*p))
+		{
+			if (e < 10000)
+				e = e * 10 + (*p - '0');
+			++p;
+		}
+		exponent += negativeExp ? -e : e;
+	}
+
+	double value = (double)mantissa;
+	if (mantissa != 0)
+	{
+		while (exponent > 22)
+		{
+			value *= powersOf10[22];
+			exponent -= 22;
+		}
+		while (exponent < -22)
+		{
+			value /= powersOf10[22];
+			exponent += 22;
+		}
+		if (exponent >= 0)
+			value *= powersOf10[exponent];
+		else
+			value /= powersOf10[-exponent];
+	}
+
+	out = (float)(negative ? -value : value);
+	return p;
+}
+
+static const char* parseInt(const char* p, const char* end, int& out)
+{
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		++p;
+	}
+
+	int value = 0;
+	bool overflow = false;
+	while (p < end && isDigit(*p))
+	{
+		int digit = *p - '0';
+		if (value > (INT_MAX - digit) / 10)
+			overflow = true;
+		else
+			value = value * 10 + digit;
+		++p;
+	}
+
+	// Índice que não cabe em int: INT_MIN nunca resolve para um índice válido,
+	// então validateIndices rejeita o arquivo
+	out = overflow ? INT_MIN : (negative ? -value : value);
+	return p;
+}
+
+// Índices OBJ começam em 1; negativos são relativos ao fim da lista atual
+static inline int resolveIndex(int index, size_t count)
+{
+	if (index > 0)
+		return index - 1;
+	if (index < 0)
+		return (int)count + index;
+	return -1;
+}
+
+// Na leitura em blocos, um índice negativo só é conhecido em relação ao próprio
+// bloco; guardamos quais cantos precisam somar o deslocamento do bloco na junção
+enum RelativeMask
+{
+	RELATIVE_V = 1,
+	RELATIVE_VT = 2,
+	RELATIVE_VN = 4
+};
+
+struct RelativeIndex
+{
+	size_t corner;
+	int mask;
+};
+
+// Lê um canto "v", "v/vt", "v//vn" ou "v/vt/vn"
+static const char* parseCorner(const char* p, const char* end, const ObjData& obj, ObjIndex& corner, int& relativeMask)
+{
+	int v = 0, vt = 0, vn = 0;
+
+	p = parseInt(p, end, v);
+	if (p < end && *p == '/')
+	{
+		++p;
+		if (p < end && *p != '/')
+			p = parseInt(p, end, vt);
+		if (p < end && *p == '/')
+		{
+			++p;
+			p = parseInt(p, end, vn);
+		}
+	}
+
+	corner.v = resolveIndex(v, obj.positions.size());
+	corner.vt = resolveIndex(vt, obj.texCoords.size());
+	corner.vn = resolveIndex(vn, obj.normals.size());
+
+	relativeMask = (v < 0 ? RELATIVE_V : 0) | (vt < 0 ? RELATIVE_VT : 0) | (vn < 0 ? RELATIVE_VN : 0);
+	return p;
+}
+
+static inline void pushCorner(ObjData& obj, const ObjIndex& corner, int mask, std::vector<RelativeIndex>* relative)
+{
+	if (mask != 0 && relative != nullptr)
+	{
+		RelativeIndex r = { obj.corners.size(), mask };
+		relative->push_back(r);
+	}
+	obj.corners.push_back(corner);
+}
+
+static const char* parseFace(const char* p, const char* end, ObjData& obj, std::vector<RelativeIndex>* relative)
+{
+	ObjIndex first, previous, current;
+	int firstMask = 0, previousMask = 0, currentMask = 0;
+	int nCorners = 0;
+
+	p = skipBlanks(p, end);
+	while (p < end && *p != '\n' && *p != '#')
+	{
+		const char* start = p;
+		p = parseCorner(p, end, obj, current, currentMask);
+		if (p == start)
+			break; // token inesperado: ignora o resto da linha
+
+		// Polígonos com mais de 3 cantos são triangulados em leque
+		if (nCorners == 0)
+		{
+			first = current;
+			firstMask = currentMask;
+		}
+		else if (nCorners >= 2)
+		{
+			pushCorner(obj, first, firstMask, relative);
+			pushCorner(obj, previous, previousMask, relative);
+			pushCorner(obj, current, currentMask, relative);
+		}
+		previous = current;
+		previousMask = currentMask;
+		++nCorners;
+
+		p = skipBlanks(p, end);
+	}
+	return p;
+}
+
+static bool startsWith(const char* p, const char* end, const char* word)
+{
+	while (*word)
+	{
+		if (p >= end || *p != *word)
+			return false;
+		++p;
+		++word;
+	}
+	return true;
+}
+
+// Lê o resto da linha (sem espaços nas pontas), para nomes de arquivo e material
+static const char* readName(const char* p, const char* end, std::string& name)
+{
+	const char* nameBegin = skipBlanks(p, end);
+	const char* nameEnd = nameBegin;
+	while (nameEnd < end && *nameEnd != '\n')
+		++nameEnd;
+	while (nameEnd > nameBegin && isBlank(nameEnd[-1]))
+		--nameEnd;
+	name.assign(nameBegin, nameEnd);
+	return nameEnd;
+}
+
+static void parseObjRange(const char* begin, const char* end, ObjData& obj, std::vector<RelativeIndex>* relative)
+{
+	const char* p = begin;
+
+	while (p < end)
+	{
+		p = skipBlanks(p, end);
+		if (p >= end)
+			break;
+
+		if (p[0] == 'v' && p + 1 < end)
+		{
+			if (isBlank(p[1]))
+			{
+				glm::vec3 v;
+				p = parseFloat(p + 2, end, v.x);
+				p = parseFloat(p, end, v.y);
+				p = parseFloat(p, end, v.z);
+				obj.positions.push_back(v);
+			}
+			else if (p[1] == 't' && p + 2 < end && isBlank(p[2]))
+			{
+				glm::vec2 vt;
+				p = parseFloat(p + 3, end, vt.x);
+				p = parseFloat(p, end, vt.y);
+				obj.texCoords.push_back(vt);
+			}
+			else if (p[1] == 'n' && p + 2 < end && isBlank(p[2]))
+			{
+				glm::vec3 vn;
+				p = parseFloat(p + 3, end, vn.x);
+				p = parseFloat(p, end, vn.y);
+				p = parseFloat(p, end, vn.z);
+				obj.normals.push_back(vn);
+			}
+		}
+		else if (p[0] == 'f' && p + 1 < end && isBlank(p[1]))
+		{
+			p = parseFace(p + 2, end, obj, relative);
+		}
+		else if (startsWith(p, end, "mtllib") && p + 6 < end && isBlank(p[6]))
+		{
+			std::string name;
+			p = readName(p + 6, end, name);
+			obj.mtlFileName = name;
+		}
+		else if (startsWith(p, end, "usemtl") && p + 6 < end && isBlank(p[6]))
+		{
+			ObjGroup group;
+			p = readName(p + 6, end, group.material);
+			group.firstCorner = obj.corners.size();
+			obj.groups.push_back(group);
+		}
+
+		p = skipLine(p, end);
+	}
+}
+
+bool parseObj(const char* begin, const char* end, ObjData& obj)
+{
+	parseObjRange(begin, end, obj, nullptr);
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// Leitura paralela: o texto é dividido em blocos terminados em fim de linha,
+// cada bloco é lido em uma thread e os resultados são concatenados em ordem,
+// com deslocamentos calculados por soma de prefixos. O resultado é idêntico
+// ao da leitura serial.
+
+struct ObjChunk
+{
+	ObjData data;
+	std::vector<RelativeIndex> relative;
+
+	size_t positionOffset;
+	size_t texCoordOffset;
+	size_t normalOffset;
+	size_t cornerOffset;
+};
+
+// Abaixo disso o custo de criar os blocos não compensa
+static const size_t minBytesPerChunk = 256 * 1024;
+
+template <typename T>
+static void copyRange(std::vector<T>& dst, size_t offset, const std::vector<T>& src)
+{
+	if (!src.empty())
+		memcpy(&dst[offset], src.data(), src.size() * sizeof(T));
+}
+
+bool parseObjParallel(const char* begin, const char* end, ObjData& obj, int nThreads)
+{
+	size_t size = (size_t)(end - begin);
+	if (nThreads <= 0)
+		nThreads = (int)std::thread::hardware_concurrency();
+
+	int nChunks = nThreads;
+	if ((size_t)nChunks > size / minBytesPerChunk)
+		nChunks = (int)(size / minBytesPerChunk);
+	if (nChunks <= 1)
+		return parseObj(begin, end, obj);
+
+	// Fronteiras sempre logo após um '\n'
+	std::vector<const char*> bounds(nChunks + 1);
+	bounds[0] = begin;
+	bounds[nChunks] = end;
+	for (int i = 1; i < nChunks; i++)
+	{
+		const char* p = begin + size * i / nChunks;
+		if (p < bounds[i - 1])
+			p = bounds[i - 1];
+		while (p < end && p[-1] != '\n')
+			++p;
+		bounds[i] = p;
+	}
+
+	std::vector<ObjChunk> chunks(nChunks);
+	ThreadPool& pool = ThreadPool::shared();
+
+	pool.parallelFor(nChunks, [&](int i) {
+		parseObjRange(bounds[i], bounds[i + 1], chunks[i].data, &chunks[i].relative);
+	});
+
+	// Soma de prefixos: onde cada bloco começa nos vetores finais
+	size_t nPositions = 0, nTexCoords = 0, nNormals = 0, nCorners = 0;
+	for (int i = 0; i < nChunks; i++)
+	{
+		ObjChunk& c = chunks[i];
+		c.positionOffset = nPositions;
+		c.texCoordOffset = nTexCoords;
+		c.normalOffset = nNormals;
+		c.cornerOffset = nCorners;
+		nPositions += c.data.positions.size();
+		nTexCoords += c.data.texCoords.size();
+		nNormals += c.data.normals.size();
+		nCorners += c.data.corners.size();
+
+		// Como na leitura serial, vale o último mtllib do arquivo
+		if (!c.data.mtlFileName.empty())
+			obj.mtlFileName = c.data.mtlFileName;
+
+		for (size_t g = 0; g < c.data.groups.size(); g++)
+		{
+			obj.groups.push_back(c.data.groups[g]);
+			obj.groups.back().firstCorner += c.cornerOffset;
+		}
+	}
+
+	obj.positions.resize(nPositions);
+	obj.texCoords.resize(nTexCoords);
+	obj.normals.resize(nNormals);
+	obj.corners.resize(nCorners);
+
+	pool.parallelFor(nChunks, [&](int i) {
+		ObjChunk& c = chunks[i];
+		copyRange(obj.positions, c.positionOffset, c.data.positions);
+		copyRange(obj.texCoords, c.texCoordOffset, c.data.texCoords);
+		copyRange(obj.normals, c.normalOffset, c.data.normals);
+		copyRange(obj.corners, c.cornerOffset, c.data.corners);
+
+		for (size_t r = 0; r < c.relative.size(); r++)
+		{
+			ObjIndex& corner = obj.corners[c.cornerOffset + c.relative[r].corner];
+			if (c.relative[r].mask & RELATIVE_V)
+				corner.v += (int)c.positionOffset;
+			if (c.relative[r].mask & RELATIVE_VT)
+				corner.vt += (int)c.texCoordOffset;
+			if (c.relative[r].mask & RELATIVE_VN)
+				corner.vn += (int)c.normalOffset;
+		}
+	});
+
+	return true;
+}
+
+static bool validateIndices(const ObjData& obj)
+{
+	const int nPositions = (int)obj.positions.size();
+	const int nTexCoords = (int)obj.texCoords.size();
+	const int nNormals = (int)obj.normals.size();
+
+	for (size_t i = 0; i < obj.corners.size(); i++)
+	{
+		const ObjIndex& c = obj.corners[i];
+		if (c.v < 0 || c.v >= nPositions || c.vt >= nTexCoords || c.vn >= nNormals || c.vt < -1 || c.vn < -1)
+		{
+			std::cerr << "Index out of bounds in OBJ file at face " << (i / 3) << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool loadObj(const std::string& path, ObjData& obj, int nThreads)
+{
+	obj.clear();
+
+	MappedFile file;
+	if (!file.open(path.c_str()))
+	{
+		std::cout << "Failed to open the file." << std::endl;
+		return false;
+	}
+
+	bool parsed = (nThreads == 1)
+		? parseObj(file.data(), file.data() + file.size(), obj)
+		: parseObjParallel(file.data(), file.data() + file.size(), obj, nThreads);
+	if (!parsed)
+		return false;
+
+	return validateIndices(obj);
+}
+
+void expandVertices(const ObjData& obj, std::vector<float>& vertices)
+{
+	vertices.clear();
+	vertices.resize(obj.corners.size() * 8);
+
+	float* out = vertices.data();
+	for (size_t i = 0; i < obj.corners.size(); i++)
+	{
+		const ObjIndex& c = obj.corners[i];
+
+		const glm::vec3& v = obj.positions[c.v];
+		out[0] = v.x;
+		out[1] = v.y;
+		out[2] = v.z;
+
+		if (c.vt >= 0)
+		{
+			out[3] = obj.texCoords[c.vt].x;
+			out[4] = obj.texCoords[c.vt].y;
+		}
+		else
+		{
+			out[3] = out[4] = 0.0f;
+		}
+
+		if (c.vn >= 0)
+		{
+			out[5] = obj.normals[c.vn].x;
+			out[6] = obj.normals[c.vn].y;
+			out[7] = obj.normals[c.vn].z;
+		}
+		else
+		{
+			out[5] = out[6] = out[7] = 0.0f;
+		}
+
+		out += 8;
+	}
+}
+
+// ---------------------------------------------------------------------------
+// Deduplicação de vértices: tabela hash de endereçamento aberto indexada pela
+// trinca (v, vt, vn); cada entrada guarda o índice do vértice único
+
+static inline unsigned int hashCorner(const ObjIndex& c)
+{
+	unsigned int h = (unsigned int)c.v * 73856093u;
+	h ^= (unsigned int)c.vt * 19349663u;
+	h ^= (unsigned int)c.vn * 83492791u;
+	return h ^ (h >> 16);
+}
+
+static inline bool sameCorner(const ObjIndex& a, const ObjIndex& b)
+{
+	return a.v == b.v && a.vt == b.vt && a.vn == b.vn;
+}
+
+void buildIndexedMesh(const ObjData& obj, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+	const size_t nCorners = obj.corners.size();
+
+	vertices.clear();
+	indices.resize(nCorners);
+
+	// Capacidade potência de 2 com folga para manter as sondagens curtas
+	size_t capacity = 16;
+	while (capacity < nCorners * 2)
+		capacity *= 2;
+	const size_t mask = capacity - 1;
+	std::vector<int> table(capacity, -1);
+	std::vector<ObjIndex> uniqueCorners;
+	uniqueCorners.reserve(nCorners / 4 + 16);
+
+	for (size_t i = 0; i < nCorners; i++)
+	{
+		const ObjIndex& c = obj.corners[i];
+		size_t slot = hashCorner(c) & mask;
+
+		while (table[slot] >= 0 && !sameCorner(uniqueCorners[table[slot]], c))
+			slot = (slot + 1) & mask;
+
+		if (table[slot] < 0)
+		{
+			table[slot] = (int)uniqueCorners.size();
+			uniqueCorners.push_back(c);
+		}
+		indices[i] = (unsigned int)table[slot];
+	}
+
+	// Monta os vértices únicos no mesmo formato de expandVertices
+	vertices.resize(uniqueCorners.size() * 8);
+	float* out = vertices.data();
+	for (size_t i = 0; i < uniqueCorners.size(); i++)
+	{
+		const ObjIndex& c = uniqueCorners[i];
+
+		const glm::vec3& v = obj.positions[c.v];
+		glm::vec2 vt = c.vt >= 0 ? obj.texCoords[c.vt] : glm::vec2(0.0f);
+		glm::vec3 vn = c.vn >= 0 ? obj.normals[c.vn] : glm::vec3(0.0f);
+
+		out[0] = v.x;
+		out[1] = v.y;
+		out[2] = v.z;
+		out[3] = vt.x;
+		out[4] = vt.y;
+		out[5] = vn.x;
+		out[6] = vn.y;
+		out[7] = vn.z;
+		out += 8;
+	}
+}
+
+// ---------------------------------------------------------------------------
+// Malha completa: índices, submalhas por "usemtl" e caixa envolvente
+
+// Caixa dos vértices usados pelos índices e esfera centrada nela, com o raio até o vértice mais distante
+static void computeBounds(const std::vector<float>& vertices, const unsigned int* indices, size_t nIndices,
+	glm::vec3& boundsMin, glm::vec3& boundsMax, glm::vec4& sphere)
+{
+	boundsMin = glm::vec3(0.0f);
+	boundsMax = glm::vec3(0.0f);
+	for (size_t i = 0; i < nIndices; i++)
+	{
+		glm::vec3 p(vertices[indices[i] * 8], vertices[indices[i] * 8 + 1], vertices[indices[i] * 8 + 2]);
+		boundsMin = i == 0 ? p : glm::min(boundsMin, p);
+		boundsMax = i == 0 ? p : glm::max(boundsMax, p);
+	}
+
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	float radius2 = 0.0f;
+	for (size_t i = 0; i < nIndices; i++)
+	{
+		glm::vec3 d = glm::vec3(vertices[indices[i] * 8], vertices[indices[i] * 8 + 1], vertices[indices[i] * 8 + 2]) - center;
+		radius2 = std::max(radius2, glm::dot(d, d));
+	}
+	sphere = glm::vec4(center, std::sqrt(radius2));
+}
+
+static int findOrAddMaterial(std::vector<std::string>& names, const std::string& name)
+{
+	for (size_t i = 0; i < names.size(); i++)
+		if (names[i] == name)
+			return (int)i;
+	names.push_back(name);
+	return (int)names.size() - 1;
+}
+
+void buildMeshData(const ObjData& obj, MeshData& mesh)
+{
+	std::vector<unsigned int> indices;
+	buildIndexedMesh(obj, mesh.vertices, indices);
+	mesh.mtlFileName = obj.mtlFileName;
+	mesh.subMeshes.clear();
+	mesh.materialNames.clear();
+
+	// Material de cada triângulo; faces antes do primeiro usemtl ficam sem material (-1)
+	size_t nTriangles = indices.size() / 3;
+	std::vector<int> triangleMaterial(nTriangles, -1);
+	for (size_t g = 0; g < obj.groups.size(); g++)
+	{
+		size_t first = obj.groups[g].firstCorner / 3;
+		size_t last = (g + 1 < obj.groups.size()) ? obj.groups[g + 1].firstCorner / 3 : nTriangles;
+		if (last <= first)
+			continue;
+		int material = findOrAddMaterial(mesh.materialNames, obj.groups[g].material);
+		for (size_t t = first; t < last; t++)
+			triangleMaterial[t] = material;
+	}
+
+	// Triângulos agrupados por material (ordenação por contagem, estável), para que cada
+	// material vire um único intervalo de índices e seja ativado uma vez por desenho
+	int nMaterials = (int)mesh.materialNames.size();
+	std::vector<size_t> start(nMaterials + 2, 0);
+	for (size_t t = 0; t < nTriangles; t++)
+		start[triangleMaterial[t] + 2]++;
+	for (int m = 1; m < nMaterials + 2; m++)
+		start[m] += start[m - 1];
+
+	mesh.indices.resize(nTriangles * 3);
+	for (size_t t = 0; t < nTriangles; t++)
+	{
+		size_t position = start[triangleMaterial[t] + 1]++;
+		for (int k = 0; k < 3; k++)
+			mesh.indices[position * 3 + k] = indices[t * 3 + k];
+	}
+
+	size_t first = 0;
+	for (int m = -1; m < nMaterials; m++)
+	{
+		size_t last = start[m + 1];
+		if (last > first)
+		{
+			SubMesh subMesh = {};
+			subMesh.firstIndex = (unsigned int)(first * 3);
+			subMesh.indexCount = (unsigned int)((last - first) * 3);
+			subMesh.materialIndex = m;
+			glm::vec3 boundsMin, boundsMax;
+			glm::vec4 sphere;
+			computeBounds(mesh.vertices, &mesh.indices[first * 3], (last - first) * 3, boundsMin, boundsMax, sphere);
+			for (int k = 0; k < 3; k++)
+			{
+				subMesh.boundsMin[k] = boundsMin[k];
+				subMesh.boundsMax[k] = boundsMax[k];
+				subMesh.sphere[k] = sphere[k];
+			}
+			subMesh.sphere[3] = sphere.w;
+			mesh.subMeshes.push_back(subMesh);
+		}
+		first = last;
+	}
+
+	computeBounds(mesh.vertices, mesh.indices.data(), mesh.indices.size(), mesh.boundsMin, mesh.boundsMax, mesh.sphere);
+}
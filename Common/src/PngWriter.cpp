@@ -0,0 +1,122 @@
+#include "PngWriter.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstring>
+
+// Maior bloco stored do deflate
+static const size_t maxStoredBlock = 65535;
+
+// Tabela do CRC-32 do PNG, montada no primeiro uso (a inicialização de estáticos locais é segura entre threads)
+struct CrcTable
+{
+	uint32_t values[256];
+
+	CrcTable()
+	{
+		for (uint32_t n = 0; n < 256; n++)
+		{
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			values[n] = c;
+		}
+	}
+};
+
+static uint32_t updateCrc(uint32_t crc, const char* data, size_t size)
+{
+	static const CrcTable table;
+	for (size_t i = 0; i < size; i++)
+		crc = table.values[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+	return crc;
+}
+
+static void putBigEndian(std::vector<char>& out, uint32_t value)
+{
+	out.push_back((char)(value >> 24));
+	out.push_back((char)(value >> 16));
+	out.push_back((char)(value >> 8));
+	out.push_back((char)value);
+}
+
+// Tamanho, tipo, dados e CRC (do tipo e dos dados)
+static void putChunk(std::vector<char>& out, const char* type, const std::vector<char>& data)
+{
+	putBigEndian(out, (uint32_t)data.size());
+	size_t start = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data.begin(), data.end());
+	uint32_t crc = updateCrc(0xFFFFFFFFu, &out[start], out.size() - start);
+	putBigEndian(out, crc ^ 0xFFFFFFFFu);
+}
+
+bool encodePng(int width, int height, int nChannels, const unsigned char* pixels, bool flipVertically,
+	std::vector<char>& file)
+{
+	static const unsigned char colorTypes[5] = { 0, 0, 0, 2, 6 };
+	if (width <= 0 || height <= 0 || nChannels < 1 || nChannels > 4 || nChannels == 2 || !pixels)
+		return false;
+
+	// Cada linha começa com o byte de filtro (0 = nenhum)
+	size_t rowBytes = (size_t)width * nChannels;
+	size_t rawSize = (rowBytes + 1) * height;
+	std::vector<char> raw(rawSize);
+	for (int y = 0; y < height; y++)
+	{
+		int source = flipVertically ? height - 1 - y : y;
+		char* row = &raw[(rowBytes + 1) * y];
+		row[0] = 0;
+		memcpy(row + 1, pixels + rowBytes * source, rowBytes);
+	}
+
+	// Fluxo zlib: cabeçalho, blocos stored (tamanho e complemento em little endian) e Adler-32
+	size_t nBlocks = (rawSize + maxStoredBlock - 1) / maxStoredBlock;
+	std::vector<char> idat;
+	idat.reserve(2 + rawSize + nBlocks * 5 + 4);
+	idat.push_back(0x78);
+	idat.push_back(0x01);
+	uint32_t a = 1, b = 0;
+	for (size_t offset = 0; offset < rawSize; offset += maxStoredBlock)
+	{
+		size_t size = rawSize - offset < maxStoredBlock ? rawSize - offset : maxStoredBlock;
+		bool last = offset + size == rawSize;
+		idat.push_back(last ? 1 : 0);
+		idat.push_back((char)(size & 0xFF));
+		idat.push_back((char)(size >> 8));
+		idat.push_back((char)(~size & 0xFF));
+		idat.push_back((char)((~size >> 8) & 0xFF));
+		idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + size);
+
+		for (size_t i = offset; i < offset + size; i++)
+		{
+			a = (a + (unsigned char)raw[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+	}
+	putBigEndian(idat, (b << 16) | a);
+
+	std::vector<char> header;
+	putBigEndian(header, (uint32_t)width);
+	putBigEndian(header, (uint32_t)height);
+	header.push_back(8);                      // bits por canal
+	header.push_back(colorTypes[nChannels]);
+	header.push_back(0);                      // compressão deflate
+	header.push_back(0);                      // filtros adaptativos
+	header.push_back(0);                      // sem entrelaçamento
+
+	static const char signature[8] = { (char)0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.assign(signature, signature + 8);
+	putChunk(file, "IHDR", header);
+	putChunk(file, "IDAT", idat);
+	putChunk(file, "IEND", std::vector<char>());
+	return true;
+}
+
+bool writePng(const std::string& path, int width, int height, int nChannels, const unsigned char* pixels, bool flipVertically)
+{
+	std::vector<char> file;
+	if (!encodePng(width, height, nChannels, pixels, flipVertically, file))
+		return false;
+	return writeFileAtomically(path, file.data(), file.size());
+}
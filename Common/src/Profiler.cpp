@@ -0,0 +1,497 @@
+#include "Profiler.h"
+#include "MappedFile.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cctype>
+
+Profiler::Profiler()
+	: gpuEnabled(false), gpuBusy(false), historyFrames(0), nFrames(0), frameIndex(-1), nDroppedGpuFrames(0), captureFrames(0)
+{
+	for (int i = 0; i < queryLatency; i++)
+		rings[i].frame = -1;
+}
+
+Profiler::~Profiler()
+{
+	release();
+}
+
+void Profiler::release()
+{
+	if (!gpuEnabled)
+		return;
+	for (int i = 0; i < queryLatency; i++)
+	{
+		for (const PendingQuery& pending : rings[i].pending)
+			glDeleteQueries(1, &pending.query);
+		if (!rings[i].free.empty())
+			glDeleteQueries((GLsizei)rings[i].free.size(), rings[i].free.data());
+		rings[i].pending.clear();
+		rings[i].free.clear();
+		rings[i].frame = -1;
+	}
+	gpuEnabled = false;
+	gpuBusy = false;
+}
+
+void Profiler::initialize(int historyFrames, bool gpu)
+{
+	this->historyFrames = std::max(historyFrames, 1);
+	gpuEnabled = gpu;
+	start = std::chrono::steady_clock::now();
+	scopes.clear();
+	stack.clear();
+	nFrames = 0;
+	frameIndex = -1;
+
+	// O quadro inteiro é sempre o escopo 0; o tempo de GPU dele é a soma dos escopos de GPU
+	findScope("Quadro", 0);
+	scopes[0].gpu = gpu;
+}
+
+double Profiler::now() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int Profiler::findScope(const char* name, int depth)
+{
+	for (size_t i = 0; i < scopes.size(); i++)
+		if (scopes[i].name == name)
+			return (int)i;
+
+	Scope scope;
+	scope.name = name;
+	scope.depth = depth;
+	scope.gpu = false;
+	scope.ran = false;
+	scope.cpuFrameMs = 0.0;
+	scope.cpuHistory.assign(historyFrames, 0.0f);
+	scope.gpuHistory.assign(historyFrames, 0.0f);
+	scope.cpuCount = scope.cpuNext = 0;
+	scope.gpuCount = scope.gpuNext = 0;
+	scopes.push_back(scope);
+	return (int)scopes.size() - 1;
+}
+
+void Profiler::beginFrame()
+{
+	frameIndex++;
+
+	// A posição do anel volta a este quadro depois de queryLatency quadros: o resultado antigo já deve estar pronto
+	FrameQueries& slot = rings[frameIndex % queryLatency];
+	collectGpu(slot);
+	slot.frame = frameIndex;
+
+	for (Scope& scope : scopes)
+	{
+		scope.cpuFrameMs = 0.0;
+		scope.ran = false;
+	}
+	beginScope("Quadro");
+}
+
+void Profiler::endFrame()
+{
+	if (stack.size() > 1)
+		std::cout << "Profiler: " << stack.size() - 1 << " escopos abertos no fim do quadro" << std::endl;
+	while (!stack.empty())
+		endScope();
+
+	for (Scope& scope : scopes)
+	{
+		if (!scope.ran)
+			continue;
+		scope.cpuHistory[scope.cpuNext] = (float)scope.cpuFrameMs;
+		scope.cpuNext = (scope.cpuNext + 1) % historyFrames;
+		scope.cpuCount = std::min(scope.cpuCount + 1, historyFrames);
+	}
+	nFrames++;
+
+	if (captureFrames > 0 && --captureFrames == 0)
+	{
+		if (writeChromeTrace(tracePath))
+			std::cout << "Trace gravado em " << tracePath << " (" << trace.size() << " eventos)" << std::endl;
+		else
+			std::cout << "Nao foi possivel gravar " << tracePath << std::endl;
+		trace.clear();
+	}
+}
+
+void Profiler::beginScope(const char* name, bool gpu)
+{
+	OpenScope open;
+	open.scope = findScope(name, (int)stack.size());
+	open.gpu = gpu && gpuEnabled && !gpuBusy && frameIndex >= 0;
+	scopes[open.scope].ran = true;
+
+	if (open.gpu)
+	{
+		FrameQueries& slot = rings[frameIndex % queryLatency];
+		GLuint query;
+		if (slot.free.empty())
+			glGenQueries(1, &query);
+		else
+		{
+			query = slot.free.back();
+			slot.free.pop_back();
+		}
+		open.startMs = now();
+		PendingQuery pending = { query, open.scope, open.startMs };
+		slot.pending.push_back(pending);
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		scopes[open.scope].gpu = true;
+		gpuBusy = true;
+	}
+	else
+		open.startMs = now();
+	stack.push_back(open);
+}
+
+void Profiler::endScope()
+{
+	if (stack.empty())
+		return;
+	OpenScope open = stack.back();
+	stack.pop_back();
+
+	if (open.gpu)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		gpuBusy = false;
+	}
+	double durationMs = now() - open.startMs;
+	scopes[open.scope].cpuFrameMs += durationMs;
+
+	if (captureFrames > 0)
+	{
+		TraceEvent event = { open.scope, false, open.startMs, durationMs };
+		trace.push_back(event);
+	}
+}
+
+void Profiler::collectGpu(FrameQueries& slot)
+{
+	if (slot.pending.empty())
+		return;
+
+	// As consultas terminam em ordem: se a última está pronta, todas estão
+	GLint available = 0;
+	glGetQueryObjectiv(slot.pending.back().query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		nDroppedGpuFrames++;
+	else
+	{
+		std::vector<double> frameMs(scopes.size(), -1.0);
+		double totalMs = 0.0;
+		for (const PendingQuery& pending : slot.pending)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &elapsed);
+			double ms = elapsed / 1.0e6;
+			frameMs[pending.scope] = std::max(frameMs[pending.scope], 0.0) + ms;
+			totalMs += ms;
+
+			if (captureFrames > 0)
+			{
+				TraceEvent event = { pending.scope, true, pending.startMs, ms };
+				trace.push_back(event);
+			}
+		}
+		frameMs[0] = totalMs;
+
+		for (size_t i = 0; i < scopes.size(); i++)
+		{
+			if (frameMs[i] < 0.0)
+				continue;
+			Scope& scope = scopes[i];
+			scope.gpuHistory[scope.gpuNext] = (float)frameMs[i];
+			scope.gpuNext = (scope.gpuNext + 1) % historyFrames;
+			scope.gpuCount = std::min(scope.gpuCount + 1, historyFrames);
+		}
+	}
+
+	// Pronto ou não, as consultas voltam a ser usadas neste quadro
+	for (const PendingQuery& pending : slot.pending)
+		slot.free.push_back(pending.query);
+	slot.pending.clear();
+}
+
+ProfilerStats Profiler::computeStats(const std::vector<float>& history, int count, int next)
+{
+	ProfilerStats stats = { 0.0f, 0.0f, 0.0f, 0.0f };
+	if (count == 0)
+		return stats;
+
+	// As amostras mais recentes ocupam as 'count' posições antes de next
+	int size = (int)history.size();
+	std::vector<float> samples(count);
+	for (int i = 0; i < count; i++)
+		samples[i] = history[(next - count + i + size) % size];
+	stats.last = samples.back();
+
+	float total = 0.0f;
+	for (float s : samples)
+		total += s;
+	stats.avg = total / count;
+	stats.min = *std::min_element(samples.begin(), samples.end());
+
+	size_t rank = std::min((size_t)(count * 0.99f), samples.size() - 1);
+	std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+	stats.p99 = samples[rank];
+	return stats;
+}
+
+ProfilerStats Profiler::getCpuStats(int scope) const
+{
+	return computeStats(scopes[scope].cpuHistory, scopes[scope].cpuCount, scopes[scope].cpuNext);
+}
+
+ProfilerStats Profiler::getGpuStats(int scope) const
+{
+	return computeStats(scopes[scope].gpuHistory, scopes[scope].gpuCount, scopes[scope].gpuNext);
+}
+
+void Profiler::captureTrace(const std::string& path, int nFrames)
+{
+	tracePath = path;
+	captureFrames = std::max(nFrames, 1);
+	trace.clear();
+	std::cout << "Capturando " << captureFrames << " quadros para " << path << std::endl;
+}
+
+static void appendEscaped(std::string& out, const std::string& text)
+{
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+			out += '\\';
+		out += c;
+	}
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const
+{
+	// Eventos completos ("X") em microssegundos; CPU e GPU como duas threads do mesmo processo.
+	// A GPU só informa a duração: o evento começa no instante em que o escopo começou na CPU
+	std::string json = "{\"traceEvents\":[\n";
+	json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+	char buffer[128];
+	for (const TraceEvent& event : trace)
+	{
+		json += ",\n{\"name\":\"";
+		appendEscaped(json, scopes[event.scope].name);
+		snprintf(buffer, sizeof(buffer), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			event.gpu ? 2 : 1, event.startMs * 1000.0, event.durationMs * 1000.0);
+		json += buffer;
+	}
+	json += "\n]}\n";
+	return writeFileAtomically(path, json.data(), json.size());
+}
+
+// ---------------------------------------------------------------------------
+// Painel
+
+// Fonte de 3x5 pixels para os caracteres ASCII 32 a 95 (minúsculas viram maiúsculas):
+// 15 bits por caractere, linha de cima nos bits mais altos, 3 bits por linha
+static const unsigned short font3x5[64] = {
+	0x0000, 0x2482, 0x5A00, 0x5F7D, 0x7282, 0x52A5, 0x7282, 0x2400,
+	0x1491, 0x4494, 0x5540, 0x05D0, 0x0014, 0x01C0, 0x0002, 0x12A4,
+	0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249,
+	0x7BEF, 0x7BCF, 0x0410, 0x7282, 0x1511, 0x0E38, 0x4454, 0x7282,
+	0x7282, 0x2BED, 0x6BAE, 0x3923, 0x6B6E, 0x79A7, 0x79A4, 0x396B,
+	0x5BED, 0x7497, 0x126A, 0x5BAD, 0x4927, 0x5FED, 0x6B6D, 0x2B6A,
+	0x6BA4, 0x2B7B, 0x6BAD, 0x388E, 0x7492, 0x5B6F, 0x5B52, 0x5BFD,
+	0x5AAD, 0x5A92, 0x72A7, 0x6926, 0x7282, 0x324B, 0x7282, 0x0007,
+};
+
+static const char* overlayVertexShader =
+	"#version 330 core\n"
+	"layout (location = 0) in vec2 position;\n"
+	"layout (location = 1) in vec4 color;\n"
+	"uniform vec2 screenSize;\n"
+	"out vec4 vColor;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_Position = vec4(position.x / screenSize.x * 2.0 - 1.0, 1.0 - position.y / screenSize.y * 2.0, 0.0, 1.0);\n"
+	"	vColor = color;\n"
+	"}\n";
+
+static const char* overlayFragmentShader =
+	"#version 330 core\n"
+	"in vec4 vColor;\n"
+	"out vec4 color;\n"
+	"void main()\n"
+	"{\n"
+	"	color = vColor;\n"
+	"}\n";
+
+// Orçamento de um quadro a 60 Hz: a barra cheia
+static const float frameBudgetMs = 1000.0f / 60.0f;
+
+ProfilerOverlay::ProfilerOverlay()
+	: shader(nullptr), VAO(0), VBO(0), capacity(0), pixelSize(2)
+{
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+	release();
+}
+
+void ProfilerOverlay::release()
+{
+	if (VBO)
+		glDeleteBuffers(1, &VBO);
+	if (VAO)
+		glDeleteVertexArrays(1, &VAO);
+	if (shader)
+	{
+		glDeleteProgram(shader->ID);
+		delete shader;
+	}
+	VBO = 0;
+	VAO = 0;
+	shader = nullptr;
+	capacity = 0;
+}
+
+void ProfilerOverlay::initialize(int pixelSize)
+{
+	this->pixelSize = std::max(pixelSize, 1);
+	if (!shader)
+		shader = new Shader(Shader::fromSource(overlayVertexShader, overlayFragmentShader));
+	if (VAO)
+		return;
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(2 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void ProfilerOverlay::addRect(float x, float y, float w, float h, const float* color)
+{
+	const float corners[6][2] = { { x, y }, { x + w, y }, { x + w, y + h }, { x, y }, { x + w, y + h }, { x, y + h } };
+	for (int i = 0; i < 6; i++)
+	{
+		vertices.push_back(corners[i][0]);
+		vertices.push_back(corners[i][1]);
+		vertices.insert(vertices.end(), color, color + 4);
+	}
+}
+
+void ProfilerOverlay::addText(float x, float y, const char* text, const float* color)
+{
+	float size = (float)pixelSize;
+	for (; *text; text++, x += 4 * size)
+	{
+		int c = toupper((unsigned char)*text);
+		if (c < 32 || c >= 96)
+			c = '?';
+		unsigned short glyph = font3x5[c - 32];
+		for (int row = 0; row < 5; row++)
+			for (int col = 0; col < 3; col++)
+				if (glyph & (1 << (14 - row * 3 - col)))
+					addRect(x + col * size, y + row * size, size, size, color);
+	}
+}
+
+void ProfilerOverlay::draw(const Profiler& profiler, int width, int height)
+{
+	if (!shader)
+		return;
+
+	static const float panelColor[4] = { 0.0f, 0.0f, 0.0f, 0.6f };
+	static const float textColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	static const float cpuColor[4] = { 0.3f, 0.7f, 1.0f, 0.9f };
+	static const float gpuColor[4] = { 1.0f, 0.6f, 0.2f, 0.9f };
+
+	float size = (float)pixelSize;
+	float lineHeight = 7 * size;
+	float charWidth = 4 * size;
+	float margin = 4 * size;
+	float barWidth = 30 * charWidth;
+	const int textColumns = 56;
+
+	// Fundo primeiro, para o texto e as barras ficarem por cima
+	vertices.clear();
+	int nLines = profiler.getNbScopes() + 2;
+	addRect(0.0f, 0.0f, margin * 2 + textColumns * charWidth + barWidth, margin * 2 + nLines * lineHeight, panelColor);
+
+	char line[128];
+	float y = margin;
+	snprintf(line, sizeof(line), "%-22s %-16s %-16s", "ESCOPO (MS)", "CPU MED MIN P99", "GPU MED MIN P99");
+	addText(margin, y, line, textColor);
+	y += lineHeight;
+
+	for (int i = 0; i < profiler.getNbScopes(); i++, y += lineHeight)
+	{
+		ProfilerStats cpu = profiler.getCpuStats(i);
+		ProfilerStats gpu = profiler.getGpuStats(i);
+		std::string name = std::string(profiler.getScopeDepth(i) * 2, ' ') + profiler.getScopeName(i);
+		if (profiler.hasGpuTime(i))
+			snprintf(line, sizeof(line), "%-22.22s %5.2f %4.1f %5.2f  %5.2f %4.1f %5.2f", name.c_str(),
+				cpu.avg, cpu.min, cpu.p99, gpu.avg, gpu.min, gpu.p99);
+		else
+			snprintf(line, sizeof(line), "%-22.22s %5.2f %4.1f %5.2f", name.c_str(), cpu.avg, cpu.min, cpu.p99);
+		addText(margin, y, line, textColor);
+
+		// Barras da média de CPU (em cima) e de GPU (embaixo), cheias em um quadro de 60 Hz
+		float barX = margin + textColumns * charWidth;
+		addRect(barX, y, std::min(cpu.avg / frameBudgetMs, 1.0f) * barWidth, 2 * size, cpuColor);
+		if (profiler.hasGpuTime(i))
+			addRect(barX, y + 3 * size, std::min(gpu.avg / frameBudgetMs, 1.0f) * barWidth, 2 * size, gpuColor);
+	}
+
+	snprintf(line, sizeof(line), "%d quadros, %d sem resultado de GPU", profiler.getNbFrames(), profiler.getNbDroppedGpuFrames());
+	addText(margin, y, line, textColor);
+
+	// Estado atual guardado para não interferir no desenho da cena
+	GLint program = 0, vertexArray = 0, blendSrc = 0, blendDst = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+	glGetIntegerv(GL_BLEND_SRC_RGB, &blendSrc);
+	glGetIntegerv(GL_BLEND_DST_RGB, &blendDst);
+	GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+	GLboolean blend = glIsEnabled(GL_BLEND);
+	GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glUseProgram(shader->ID);
+	glUniform2f(glGetUniformLocation(shader->ID, "screenSize"), (float)width, (float)height);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	size_t bytes = vertices.size() * sizeof(float);
+	if (bytes > capacity)
+	{
+		capacity = bytes * 2;
+		glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+	}
+	glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(vertices.size() / 6));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindVertexArray(vertexArray);
+	glUseProgram(program);
+	glBlendFunc(blendSrc, blendDst);
+	if (depthTest)
+		glEnable(GL_DEPTH_TEST);
+	if (!blend)
+		glDisable(GL_BLEND);
+	if (cullFace)
+		glEnable(GL_CULL_FACE);
+}
@@ -0,0 +1,158 @@
+#include "RenderQueue.h"
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+RenderQueue::RenderQueue()
+	: maxDepth(100.0f)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+DrawItem RenderQueue::makeItem(Shader* shader, GLuint vao, int first, int count)
+{
+	DrawItem item;
+	item.shader = shader;
+	item.vao = vao;
+	item.texture = 0;
+	item.materialBuffer = nullptr;
+	item.materialBlock = 0;
+	item.model = nullptr;
+	item.mode = GL_TRIANGLES;
+	item.indexType = 0;
+	item.first = first;
+	item.count = count;
+	item.nInstances = 1;
+	item.depth = 0.0f;
+	return item;
+}
+
+uint64_t RenderQueue::makeKey(const DrawItem& item) const
+{
+	float depth = std::min(std::max(item.depth / maxDepth, 0.0f), 1.0f);
+	uint64_t key = (uint64_t)(item.shader->ID & 0xFF) << 56;
+	key |= (uint64_t)(item.texture & 0xFFF) << 44;
+	key |= (uint64_t)(item.materialBlock & 0xFF) << 36;
+	key |= (uint64_t)(item.vao & 0xFFF) << 24;
+	key |= (uint64_t)(depth * 0xFFFFFF);
+	return key;
+}
+
+void RenderQueue::add(const DrawItem& item)
+{
+	SortEntry entry = { makeKey(item), (uint32_t)items.size() };
+	entries.push_back(entry);
+	items.push_back(item);
+}
+
+// Radix sort LSD de 8 bits por passada; passadas em que todos os itens têm o mesmo byte são puladas
+void RenderQueue::sort()
+{
+	size_t n = entries.size();
+	scratch.resize(n);
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256] = {};
+		for (size_t i = 0; i < n; i++)
+			counts[(entries[i].key >> shift) & 0xFF]++;
+		if (counts[(entries[0].key >> shift) & 0xFF] == n)
+			continue;
+
+		size_t offset = 0;
+		for (int b = 0; b < 256; b++)
+		{
+			size_t count = counts[b];
+			counts[b] = offset;
+			offset += count;
+		}
+		for (size_t i = 0; i < n; i++)
+			scratch[counts[(entries[i].key >> shift) & 0xFF]++] = entries[i];
+		entries.swap(scratch);
+	}
+}
+
+void RenderQueue::flush()
+{
+	memset(&stats, 0, sizeof(stats));
+	if (items.empty())
+		return;
+
+	sort();
+
+	// O estado é conferido só dentro do flush: fora dele outro código pode ter mudado tudo
+	GLuint program = 0, texture = 0, vao = 0;
+	const UniformBuffer* materialBuffer = nullptr;
+	int materialBlock = -1;
+	bool first = true;
+	UniformMat4 modelUniform; // resolvido a cada troca de programa, não a cada item
+	glActiveTexture(GL_TEXTURE0);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const DrawItem& item = items[entries[i].index];
+
+		if (first || item.shader->ID != program)
+		{
+			glUseProgram(item.shader->ID);
+			program = item.shader->ID;
+			modelUniform = item.shader->uniform("model");
+			stats.programChanges++;
+		}
+		if (first || item.texture != texture)
+		{
+			glBindTexture(GL_TEXTURE_2D, item.texture);
+			texture = item.texture;
+			stats.textureChanges++;
+		}
+		if (item.materialBuffer && (item.materialBuffer != materialBuffer || item.materialBlock != materialBlock))
+		{
+			item.materialBuffer->bind(item.materialBlock);
+			materialBuffer = item.materialBuffer;
+			materialBlock = item.materialBlock;
+			stats.materialChanges++;
+		}
+		if (first || item.vao != vao)
+		{
+			glBindVertexArray(item.vao);
+			vao = item.vao;
+			stats.vaoChanges++;
+		}
+		if (item.model)
+			modelUniform.set(item.model);
+		first = false;
+
+		if (item.indexType)
+		{
+			size_t indexSize = item.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+			const void* offset = (const void*)(item.first * indexSize);
+			if (item.nInstances > 1)
+				glDrawElementsInstanced(item.mode, item.count, item.indexType, offset, item.nInstances);
+			else
+				glDrawElements(item.mode, item.count, item.indexType, offset);
+		}
+		else if (item.nInstances > 1)
+			glDrawArraysInstanced(item.mode, item.first, item.count, item.nInstances);
+		else
+			glDrawArrays(item.mode, item.first, item.count);
+		stats.nDraws++;
+	}
+	glBindVertexArray(0);
+
+	// Um laço ingênuo liga programa, textura, VAO e material (quando há) em todo draw
+	int nMaterialItems = 0;
+	for (size_t i = 0; i < items.size(); i++)
+		if (items[i].materialBuffer)
+			nMaterialItems++;
+	stats.avoided = 3 * stats.nDraws + nMaterialItems
+		- (stats.programChanges + stats.textureChanges + stats.vaoChanges + stats.materialChanges);
+
+	items.clear();
+	entries.clear();
+}
+
+void RenderQueue::printStats() const
+{
+	std::cout << "Fila de desenho: " << stats.nDraws << " draws, trocas de programa " << stats.programChanges
+		<< ", textura " << stats.textureChanges << ", material " << stats.materialChanges << ", VAO " << stats.vaoChanges
+		<< " (" << stats.avoided << " binds evitados)" << std::endl;
+}
@@ -0,0 +1,185 @@
+#include "StreamBuffer.h"
+
+#include <iostream>
+#include <cstring>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+// A GLAD do projeto vai até a OpenGL 3.3: glBufferStorage e suas constantes vêm daqui
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+static BufferStorageProc loadBufferStorage()
+{
+	bool supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4) ||
+		glfwExtensionSupported("GL_ARB_buffer_storage");
+	return supported ? (BufferStorageProc)glfwGetProcAddress("glBufferStorage") : nullptr;
+}
+
+// Todas as operações usam GL_COPY_WRITE_BUFFER: ligar o buffer ali não mexe no VAO atual
+// (GL_ELEMENT_ARRAY_BUFFER mexeria) nem no GL_ARRAY_BUFFER de quem está montando um VAO
+static const GLenum streamTarget = GL_COPY_WRITE_BUFFER;
+
+StreamBuffer::StreamBuffer()
+	: buffer(0), persistent(nullptr), mapped(false), regionSize(0), region(0), head(0), peakBytes(0), nWaits(0), nOverflows(0)
+{
+	for (int i = 0; i < nRegions; i++)
+		fences[i] = 0;
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	release();
+}
+
+void StreamBuffer::release()
+{
+	for (int i = 0; i < nRegions; i++)
+	{
+		if (fences[i])
+			glDeleteSync(fences[i]);
+		fences[i] = 0;
+	}
+	if (buffer)
+	{
+		if (persistent || mapped)
+		{
+			glBindBuffer(streamTarget, buffer);
+			glUnmapBuffer(streamTarget);
+			glBindBuffer(streamTarget, 0);
+		}
+		glDeleteBuffers(1, &buffer);
+	}
+	buffer = 0;
+	persistent = nullptr;
+	mapped = false;
+	regionSize = 0;
+	head = 0;
+}
+
+void StreamBuffer::initialize(size_t frameSize)
+{
+	release();
+
+	// Regiões em múltiplos de 256 bytes, o maior alinhamento que os drivers costumam pedir
+	regionSize = (frameSize + 255) / 256 * 256;
+	region = nRegions - 1;
+	head = 0;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(streamTarget, buffer);
+
+	static BufferStorageProc bufferStorage = loadBufferStorage();
+	if (bufferStorage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		bufferStorage(streamTarget, regionSize * nRegions, nullptr, flags);
+		persistent = (char*)glMapBufferRange(streamTarget, 0, regionSize * nRegions, flags);
+	}
+	if (!persistent)
+	{
+		// Sem armazenamento imutável (ou se o mapeamento falhou) o buffer é recriado do jeito 3.3;
+		// o nome antigo pode ter virado imutável, então um novo é gerado
+		if (bufferStorage)
+		{
+			glDeleteBuffers(1, &buffer);
+			glGenBuffers(1, &buffer);
+			glBindBuffer(streamTarget, buffer);
+		}
+		glBufferData(streamTarget, regionSize * nRegions, nullptr, GL_STREAM_DRAW);
+		std::cout << "StreamBuffer: sem glBufferStorage, mapeando cada escrita" << std::endl;
+	}
+	glBindBuffer(streamTarget, 0);
+}
+
+void StreamBuffer::beginFrame()
+{
+	region = (region + 1) % nRegions;
+	head = 0;
+
+	GLsync fence = fences[region];
+	if (!fence)
+		return;
+
+	// Normalmente a GPU terminou esta região dois quadros atrás e a espera retorna na hora
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		nWaits++;
+		do
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		while (result == GL_TIMEOUT_EXPIRED);
+	}
+	glDeleteSync(fence);
+	fences[region] = 0;
+}
+
+void StreamBuffer::endFrame()
+{
+	if (mapped)
+		unmap();
+	if (fences[region])
+		glDeleteSync(fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void* StreamBuffer::map(size_t size, size_t alignment, GLintptr& offset)
+{
+	if (mapped)
+		unmap();
+
+	// O alinhamento vale para a posição no buffer inteiro, não dentro da região
+	size_t base = region * regionSize;
+	if (alignment == 0)
+		alignment = 1;
+	size_t start = (base + head + alignment - 1) / alignment * alignment;
+	if (start + size > base + regionSize)
+	{
+		nOverflows++;
+		return nullptr;
+	}
+	head = start + size - base;
+	if (head > peakBytes)
+		peakBytes = head;
+	offset = (GLintptr)start;
+
+	if (persistent)
+		return persistent + start;
+
+	// A fence do beginFrame já garantiu que a GPU não lê este trecho: o driver não precisa esperar
+	glBindBuffer(streamTarget, buffer);
+	void* pointer = glMapBufferRange(streamTarget, start, size,
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+	glBindBuffer(streamTarget, 0);
+	mapped = pointer != nullptr;
+	return pointer;
+}
+
+void StreamBuffer::unmap()
+{
+	// Mapeamento persistente e coerente: as escritas já são visíveis para os próximos comandos
+	if (!mapped)
+		return;
+	glBindBuffer(streamTarget, buffer);
+	glUnmapBuffer(streamTarget);
+	glBindBuffer(streamTarget, 0);
+	mapped = false;
+}
+
+GLintptr StreamBuffer::write(const void* data, size_t size, size_t alignment)
+{
+	GLintptr offset;
+	void* pointer = map(size, alignment, offset);
+	if (!pointer)
+		return -1;
+	memcpy(pointer, data, size);
+	unmap();
+	return offset;
+}
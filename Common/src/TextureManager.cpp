@@ -0,0 +1,247 @@
+#include "TextureManager.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cctype>
+#include <vector>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <climits>
+#endif
+
+TextureManager::TextureManager()
+	: loader(nullptr), budgetBytes(0), residentBytes(0), useCounter(0),
+	nHits(0), nMisses(0), nEvictions(0), nDuplicates(0), overBudget(false)
+{
+}
+
+void TextureManager::initialize(AsyncTextureLoader* loader, size_t budgetBytes)
+{
+	this->loader = loader;
+	this->budgetBytes = budgetBytes;
+}
+
+std::string TextureManager::getCanonicalPath(const std::string& path)
+{
+	std::string canonical = path;
+#ifdef _WIN32
+	char buffer[_MAX_PATH];
+	if (_fullpath(buffer, path.c_str(), _MAX_PATH))
+		canonical = buffer;
+	for (size_t i = 0; i < canonical.size(); i++)
+	{
+		if (canonical[i] == '\\')
+			canonical[i] = '/';
+		else
+			canonical[i] = (char)tolower((unsigned char)canonical[i]);
+	}
+#else
+	char buffer[PATH_MAX];
+	if (realpath(path.c_str(), buffer))
+		canonical = buffer;
+#endif
+	return canonical;
+}
+
+uint64_t TextureManager::getKey(const std::string& canonical, const FileStamp& stamp)
+{
+	std::string id = canonical;
+	id.push_back('\0');
+	id.append((const char*)&stamp.size, sizeof(stamp.size));
+	id.append((const char*)&stamp.time, sizeof(stamp.time));
+	return hashBytes(id.data(), id.size());
+}
+
+GLuint TextureManager::acquire(const std::string& path)
+{
+	std::string canonical = getCanonicalPath(path);
+
+	// Só consulta tamanho e data: ler o arquivo inteiro aqui travaria a thread de renderização
+	// justamente nas texturas grandes que o loader assíncrono deveria esconder
+	FileStamp stamp;
+	if (!getFileStamp(canonical, stamp))
+	{
+		std::cout << "Textura nao encontrada: " << path << std::endl;
+		return 0;
+	}
+
+	uint64_t key = getKey(canonical, stamp);
+	std::map<uint64_t, GLuint>::iterator file = files.find(key);
+	if (file != files.end())
+		nHits++;
+	else
+	{
+		nMisses++;
+		Entry entry;
+		entry.textureID = loader->load(canonical);
+		entry.path = canonical;
+		entry.refCount = 0;
+		entry.bytes = 0;
+		entry.lastUse = 0;
+		entry.content = 0;
+		entry.original = 0;
+		textures[entry.textureID] = entry;
+		file = files.insert(std::make_pair(key, entry.textureID)).first;
+	}
+
+	Entry& entry = textures[file->second];
+	entry.refCount++;
+	entry.lastUse = ++useCounter;
+	return entry.textureID;
+}
+
+void TextureManager::release(GLuint textureID)
+{
+	std::map<GLuint, Entry>::iterator it = textures.find(textureID);
+	if (it == textures.end())
+		return;
+
+	// A referência de uma cópia também conta na original
+	if (it->second.original)
+	{
+		release(it->second.original);
+		if (--it->second.refCount == 0)
+			erase(it);
+		return;
+	}
+
+	Entry& entry = it->second;
+	if (entry.refCount > 0)
+		entry.refCount--;
+	entry.lastUse = ++useCounter;
+	evict();
+}
+
+GLuint TextureManager::rebind(GLuint textureID)
+{
+	std::map<GLuint, Entry>::iterator it = textures.find(textureID);
+	if (it == textures.end() || !it->second.original)
+		return textureID;
+
+	GLuint original = it->second.original;
+	if (--it->second.refCount == 0)
+		erase(it);
+	return original;
+}
+
+int TextureManager::getRefCount(GLuint textureID) const
+{
+	std::map<GLuint, Entry>::const_iterator it = textures.find(textureID);
+	return it != textures.end() ? it->second.refCount : 0;
+}
+
+void TextureManager::setBudget(size_t budgetBytes)
+{
+	this->budgetBytes = budgetBytes;
+	overBudget = false;
+	evict();
+}
+
+void TextureManager::update()
+{
+	std::vector<GLuint> copies;
+	for (std::map<GLuint, Entry>::iterator it = textures.begin(); it != textures.end(); ++it)
+	{
+		Entry& entry = it->second;
+		if (entry.bytes == 0 && (entry.bytes = loader->getTextureBytes(entry.textureID)) != 0)
+			residentBytes += entry.bytes;
+
+		if (entry.content != 0 || (entry.content = loader->getContentHash(entry.textureID)) == 0)
+			continue;
+		std::map<uint64_t, GLuint>::iterator content = contents.find(entry.content);
+		if (content == contents.end())
+			contents[entry.content] = entry.textureID;
+		else
+			copies.push_back(entry.textureID);
+	}
+
+	for (size_t i = 0; i < copies.size(); i++)
+		alias(copies[i], contents[textures[copies[i]].content]);
+	evict();
+}
+
+// Os arquivos que levavam à cópia passam a levar à original, que herda as referências;
+// a cópia fica viva só enquanto alguém ainda guarda o ID dela
+void TextureManager::alias(GLuint copyID, GLuint originalID)
+{
+	std::map<GLuint, Entry>::iterator copy = textures.find(copyID);
+	Entry& original = textures[originalID];
+
+	for (std::map<uint64_t, GLuint>::iterator it = files.begin(); it != files.end(); ++it)
+		if (it->second == copyID)
+			it->second = originalID;
+
+	original.refCount += copy->second.refCount;
+	original.lastUse = std::max(original.lastUse, copy->second.lastUse);
+	copy->second.original = originalID;
+	nDuplicates++;
+
+	if (copy->second.refCount == 0)
+		erase(copy);
+}
+
+void TextureManager::erase(std::map<GLuint, Entry>::iterator it)
+{
+	Entry& entry = it->second;
+	residentBytes -= entry.bytes;
+	loader->unload(entry.textureID);
+
+	for (std::map<uint64_t, GLuint>::iterator file = files.begin(); file != files.end();)
+	{
+		if (file->second == entry.textureID)
+			file = files.erase(file);
+		else
+			++file;
+	}
+	std::map<uint64_t, GLuint>::iterator content = contents.find(entry.content);
+	if (content != contents.end() && content->second == entry.textureID)
+		contents.erase(content);
+
+	textures.erase(it);
+}
+
+// Apaga as texturas sem referências, da usada há mais tempo para a mais recente,
+// até a memória residente caber no orçamento
+void TextureManager::evict()
+{
+	while (residentBytes > budgetBytes)
+	{
+		std::map<GLuint, Entry>::iterator oldest = textures.end();
+		for (std::map<GLuint, Entry>::iterator it = textures.begin(); it != textures.end(); ++it)
+			if (it->second.refCount == 0 && (oldest == textures.end() || it->second.lastUse < oldest->second.lastUse))
+				oldest = it;
+
+		if (oldest == textures.end())
+		{
+			// Tudo o que está na GPU ainda é usado; avisa uma vez e segue acima do orçamento
+			if (!overBudget)
+				std::cout << "Texturas em uso ocupam " << residentBytes / (1024 * 1024) << " MB, acima do limite de "
+					<< budgetBytes / (1024 * 1024) << " MB" << std::endl;
+			overBudget = true;
+			return;
+		}
+
+		erase(oldest);
+		nEvictions++;
+	}
+	overBudget = false;
+}
+
+void TextureManager::clear()
+{
+	for (std::map<GLuint, Entry>::iterator it = textures.begin(); it != textures.end(); ++it)
+		loader->unload(it->second.textureID);
+	textures.clear();
+	files.clear();
+	contents.clear();
+	residentBytes = 0;
+	overBudget = false;
+}
+
+void TextureManager::printStats() const
+{
+	std::cout << "Texturas: " << textures.size() << " residentes (" << residentBytes / (1024.0 * 1024.0) << " MB de "
+		<< budgetBytes / (1024.0 * 1024.0) << " MB), " << nHits << " acertos, " << nMisses << " faltas, "
+		<< nEvictions << " descartadas, " << nDuplicates << " repetidas" << std::endl;
+}
@@ -0,0 +1,150 @@
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(int nThreads)
+	: pending(0), stopping(false)
+{
+	if (nThreads <= 0)
+		nThreads = (int)std::thread::hardware_concurrency();
+	if (nThreads <= 0)
+		nThreads = 1;
+
+	for (int i = 0; i < nThreads; i++)
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	taskAvailable.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push(std::move(task));
+		pending++;
+	}
+	taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	allDone.wait(lock, [this] { return pending == 0; });
+}
+
+void ThreadPool::workerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+			if (stopping && tasks.empty())
+				return;
+			task = std::move(tasks.front());
+			tasks.pop();
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending--;
+			if (pending == 0)
+				allDone.notify_all();
+		}
+	}
+}
+
+// Estado de um parallelFor; compartilhado com as tarefas auxiliares, que podem
+// começar a executar depois que a chamada já terminou
+struct ParallelForState
+{
+	std::atomic<int> next;
+	int count;
+	const std::function<void(int)>* body;
+
+	std::mutex mutex;
+	std::condition_variable finished;
+	int active;
+	bool closed;
+};
+
+static void runParallelForItems(ParallelForState& state)
+{
+	for (;;)
+	{
+		int i = state.next.fetch_add(1);
+		if (i >= state.count)
+			break;
+		(*state.body)(i);
+	}
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& body)
+{
+	if (count <= 0)
+		return;
+	if (count == 1 || workers.size() <= 1)
+	{
+		for (int i = 0; i < count; i++)
+			body(i);
+		return;
+	}
+
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->next = 0;
+	state->count = count;
+	state->body = &body;
+	state->active = 0;
+	state->closed = false;
+
+	int nHelpers = (int)workers.size();
+	if (nHelpers > count - 1)
+		nHelpers = count - 1;
+
+	for (int h = 0; h < nHelpers; h++)
+	{
+		submit([state] {
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				if (state->closed)
+					return;
+				state->active++;
+			}
+			runParallelForItems(*state);
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->active--;
+				if (state->active == 0)
+					state->finished.notify_all();
+			}
+		});
+	}
+
+	// A thread que chamou também consome índices
+	runParallelForItems(*state);
+
+	// Auxiliares que ainda não começaram não precisam mais rodar
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->closed = true;
+	state->finished.wait(lock, [&state] { return state->active == 0; });
+}
+
+ThreadPool& ThreadPool::shared()
+{
+	static ThreadPool pool;
+	return pool;
+}
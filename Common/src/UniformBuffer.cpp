@@ -0,0 +1,69 @@
+#include "UniformBuffer.h"
+
+#include <iostream>
+
+UniformBuffer::UniformBuffer()
+	: buffer(0), binding(0), blockSize(0), blockStride(0), nBlocks(0), boundBlock(-1), nUpdates(0)
+{
+}
+
+void UniformBuffer::release()
+{
+	if (buffer)
+		glDeleteBuffers(1, &buffer);
+	buffer = 0;
+	nBlocks = 0;
+	boundBlock = -1;
+}
+
+void UniformBuffer::initialize(GLuint binding, size_t blockSize, int nBlocks)
+{
+	this->binding = binding;
+	this->blockSize = blockSize;
+	this->nBlocks = nBlocks;
+
+	// O início de cada cópia precisa ser múltiplo do alinhamento de glBindBufferRange
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	blockStride = (blockSize + alignment - 1) / alignment * alignment;
+
+	if (!buffer)
+		glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, blockStride * nBlocks, nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	boundBlock = -1;
+	bind(0);
+}
+
+bool UniformBuffer::bindToProgram(GLuint program, const char* blockName) const
+{
+	GLuint index = glGetUniformBlockIndex(program, blockName);
+	if (index == GL_INVALID_INDEX)
+		return false;
+
+	GLint size = 0;
+	glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+	if ((size_t)size > blockSize)
+		std::cout << "Bloco " << blockName << " tem " << size << " bytes no shader e " << blockSize << " no programa" << std::endl;
+
+	glUniformBlockBinding(program, index, binding);
+	return true;
+}
+
+void UniformBuffer::update(const void* data, int block)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, block * blockStride, blockSize, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	nUpdates++;
+}
+
+void UniformBuffer::bind(int block)
+{
+	if (block == boundBlock)
+		return;
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, block * blockStride, blockSize);
+	boundBlock = block;
+}
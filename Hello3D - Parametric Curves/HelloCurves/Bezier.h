@@ -5,6 +5,6 @@ class Bezier :
 {
 public:
     Bezier();
-    void generateCurve(int pointsPerSegment);
+protected:
+    glm::mat4x3 getSegmentGeometry(int segment) const;
 };
-
@@ -5,6 +5,6 @@ class CatmullRom :
 {
 public:
     CatmullRom();
-    void generateCurve(int pointsPerSegment);
+protected:
+    glm::mat4x3 getSegmentGeometry(int segment) const;
 };
-
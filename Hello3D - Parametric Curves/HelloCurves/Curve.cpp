@@ -1,4 +1,67 @@
 #include "Curve.h"
+#include "CurveEval.h"
+
+#include <algorithm>
+
+// Tesselao  da OpenGL 4.0; a GLAD do projeto vai at a 3.3
+#ifndef GL_PATCHES
+#define GL_PATCHES 0x000E
+#endif
+#ifndef GL_PATCH_VERTICES
+#define GL_PATCH_VERTICES 0x8E72
+#endif
+
+typedef void (APIENTRYP PatchParameteriProc)(GLenum pname, GLint value);
+
+static PatchParameteriProc patchParameteri()
+{
+	static PatchParameteriProc proc = GLVersion.major >= 4 ? (PatchParameteriProc)glfwGetProcAddress("glPatchParameteri") : nullptr;
+	return proc;
+}
+
+void Curve::release()
+{
+	if (VAO)
+		glDeleteVertexArrays(1, &VAO);
+	if (VBO)
+		glDeleteBuffers(1, &VBO);
+	if (patchVAO)
+		glDeleteVertexArrays(1, &patchVAO);
+	if (patchVBO)
+		glDeleteBuffers(1, &patchVBO);
+	VAO = VBO = patchVAO = patchVBO = 0;
+	nPatchVertices = 0;
+}
+
+void Curve::setControlPoints(const vector <glm::vec3>& controlPoints)
+{
+	this->controlPoints = controlPoints;
+	segmentDirty.assign(getNbSegments(), 0);
+	dirtySegments.clear();
+	// A curva antiga no corresponde mais aos pontos: updateCurve s volta a valer depois de gerar de novo
+	segmentOffsets.clear();
+	arcLengths.clear();
+	arcCoefficients.clear();
+}
+
+void Curve::moveControlPoint(int i, const glm::vec3& p)
+{
+	if (i < 0 || i >= (int)controlPoints.size())
+		return;
+	controlPoints[i] = p;
+
+	// O segmento s usa os pontos 3s a 3s + 3
+	int first = glm::max((i - 1) / 3, 0);
+	int last = glm::min(i / 3, getNbSegments() - 1);
+	for (int segment = first; segment <= last; segment++)
+	{
+		if (!segmentDirty[segment])
+		{
+			segmentDirty[segment] = 1;
+			dirtySegments.push_back(segment);
+		}
+	}
+}
 
 void Curve::setShader(Shader* shader)
 {
@@ -6,6 +69,369 @@ void Curve::setShader(Shader* shader)
 	shader->Use();
 }
 
+glm::mat4x3 Curve::getSegmentCoefficients(int segment) const
+{
+	return cubicCoefficients(getSegmentGeometry(segment), M);
+}
+
+glm::vec3 Curve::evaluate(int segment, float t) const
+{
+	return evaluateCubic(getSegmentCoefficients(segment), t);
+}
+
+void Curve::generateCurve(int pointsPerSegment)
+{
+	// Todos os pontos escritos direto no vetor, j do tamanho final
+	int n = pointsPerSegment + 1;
+	curvePoints.resize(getNbSegments() * n);
+	segmentOffsets.resize(getNbSegments() + 1);
+	this->pointsPerSegment = pointsPerSegment;
+
+	for (int segment = 0; segment < getNbSegments(); segment++)
+	{
+		segmentOffsets[segment] = segment * n;
+		evaluateCubicUniform(getSegmentCoefficients(segment), pointsPerSegment, &curvePoints[segment * n]);
+	}
+	segmentOffsets[getNbSegments()] = (int)curvePoints.size();
+
+	uploadCurve();
+}
+
+// Distncia de p at a reta que passa por a e b (ou at a, se a e b coincidem)
+static float distanceToChord(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b)
+{
+	glm::vec3 chord = b - a;
+	float length = glm::length(chord);
+	if (length < 1e-12f)
+		return glm::length(p - a);
+	return glm::length(glm::cross(p - a, chord)) / length;
+}
+
+void Curve::generateCurveAdaptive(float tolerance, int maxDepth)
+{
+	curvePoints.clear();
+	segmentOffsets.resize(getNbSegments() + 1);
+	pointsPerSegment = 0;
+	adaptiveTolerance = tolerance;
+	adaptiveMaxDepth = maxDepth;
+
+	for (int segment = 0; segment < getNbSegments(); segment++)
+	{
+		segmentOffsets[segment] = (int)curvePoints.size();
+		tessellateSegment(segment, curvePoints);
+	}
+	segmentOffsets[getNbSegments()] = (int)curvePoints.size();
+
+	uploadCurve();
+}
+
+void Curve::tessellateSegment(int segment, vector <glm::vec3>& points)
+{
+	glm::mat4x3 C = getSegmentCoefficients(segment);
+	if (pointsPerSegment > 0)
+	{
+		size_t first = points.size();
+		points.resize(first + pointsPerSegment + 1);
+		evaluateCubicUniform(C, pointsPerSegment, &points[first]);
+		return;
+	}
+
+	// Coeficientes do polinmio do segmento (t, t, t e 1)
+	// convertidos para os 4 pontos de controle de Bzier do mesmo segmento
+	glm::vec3 b[4];
+	b[0] = C[3];
+	b[1] = C[3] + C[2] / 3.0f;
+	b[2] = C[3] + C[2] * (2.0f / 3.0f) + C[1] / 3.0f;
+	b[3] = C[0] + C[1] + C[2] + C[3];
+
+	points.push_back(b[0]);
+	subdivide(b, adaptiveTolerance, adaptiveMaxDepth, points);
+}
+
+void Curve::subdivide(const glm::vec3* b, float tolerance, int depth, vector <glm::vec3>& points)
+{
+	// A curva fica dentro do fecho convexo do polgono de controle: se os pontos internos
+	// esto perto da corda, a curva tambm est
+	float flatness = glm::max(distanceToChord(b[1], b[0], b[3]), distanceToChord(b[2], b[0], b[3]));
+	if (flatness <= tolerance || depth == 0)
+	{
+		points.push_back(b[3]);
+		return;
+	}
+
+	// De Casteljau em t = 0.5: duas metades, cada uma com o seu polgono de controle
+	glm::vec3 b01 = (b[0] + b[1]) * 0.5f;
+	glm::vec3 b12 = (b[1] + b[2]) * 0.5f;
+	glm::vec3 b23 = (b[2] + b[3]) * 0.5f;
+	glm::vec3 b012 = (b01 + b12) * 0.5f;
+	glm::vec3 b123 = (b12 + b23) * 0.5f;
+	glm::vec3 middle = (b012 + b123) * 0.5f;
+
+	glm::vec3 left[4] = { b[0], b01, b012, middle };
+	glm::vec3 right[4] = { middle, b123, b23, b[3] };
+	subdivide(left, tolerance, depth - 1, points);
+	subdivide(right, tolerance, depth - 1, points);
+}
+
+void Curve::updateCurve()
+{
+	if (dirtySegments.empty())
+		return;
+	std::sort(dirtySegments.begin(), dirtySegments.end());
+
+	// Pontos da curva: cada segmento marcado  gerado de novo no lugar; se o nmero de pontos
+	// mudou (s no passo adaptativo), os segmentos seguintes andam e o VBO inteiro  reenviado
+	bool hasCurve = (int)segmentOffsets.size() == getNbSegments() + 1;
+	bool resized = false;
+	if (hasCurve)
+	{
+		for (int segment : dirtySegments)
+		{
+			segmentPoints.clear();
+			tessellateSegment(segment, segmentPoints);
+
+			int begin = segmentOffsets[segment];
+			int oldCount = segmentOffsets[segment + 1] - begin;
+			int delta = (int)segmentPoints.size() - oldCount;
+			if (delta > 0)
+				curvePoints.insert(curvePoints.begin() + begin + oldCount, delta, glm::vec3(0.0f));
+			else if (delta < 0)
+				curvePoints.erase(curvePoints.begin() + begin + oldCount + delta, curvePoints.begin() + begin + oldCount);
+			std::copy(segmentPoints.begin(), segmentPoints.end(), curvePoints.begin() + begin);
+
+			if (delta != 0)
+			{
+				for (int s = segment + 1; s <= getNbSegments(); s++)
+					segmentOffsets[s] += delta;
+				resized = true;
+			}
+		}
+
+		if (resized)
+			uploadCurve();
+		else
+		{
+			// Segmentos vizinhos marcados viram um trecho s
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			for (size_t k = 0; k < dirtySegments.size(); )
+			{
+				size_t end = k + 1;
+				while (end < dirtySegments.size() && dirtySegments[end] == dirtySegments[end - 1] + 1)
+					end++;
+				int first = segmentOffsets[dirtySegments[k]];
+				int count = segmentOffsets[dirtySegments[end - 1] + 1] - first;
+				glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(GLfloat) * 3, count * sizeof(GLfloat) * 3, &curvePoints[first]);
+				k = end;
+			}
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+	}
+
+	// Patches: tamanho fixo, 4 vrtices por segmento
+	if (patchVAO)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, patchVBO);
+		for (int segment : dirtySegments)
+		{
+			glm::mat4x3 G = getSegmentGeometry(segment);
+			glm::vec3 patch[4] = { G[0], G[1], G[2], G[3] };
+			glBufferSubData(GL_ARRAY_BUFFER, segment * 4 * sizeof(GLfloat) * 3, sizeof(patch), patch);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	if (!arcLengths.empty())
+	{
+		for (int segment : dirtySegments)
+			updateArcLengthSegment(segment);
+	}
+
+	for (int segment : dirtySegments)
+		segmentDirty[segment] = 0;
+	dirtySegments.clear();
+}
+
+void Curve::uploadCurve()
+{
+	if (!VAO)
+	{
+		//Gerao do identificador do VBO
+		glGenBuffers(1, &VBO);
+
+		//Gerao do identificador do VAO (Vertex Array Object)
+		glGenVertexArrays(1, &VAO);
+
+		// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vrtices
+		// e os ponteiros para os atributos 
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+		//Atributo posio (x, y, z)
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+
+		// Desvincula o VAO ( uma boa prtica desvincular qualquer buffer ou array para evitar bugs medonhos)
+		glBindVertexArray(0);
+	}
+
+	//Envia os dados do array de floats para o buffer da OpenGl (a curva gerada de novo substitui a anterior)
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(GLfloat) * 3, curvePoints.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Gauss-Legendre de 5 pontos em [-1, 1]: exato para polinmios at o grau 9; |p'(t)| no 
+// polinmio, mas  suave dentro de um trecho e o erro cai rpido com mais amostras
+static const float gaussNodes[5] = { -0.9061798459f, -0.5384693101f, 0.0f, 0.5384693101f, 0.9061798459f };
+static const float gaussWeights[5] = { 0.2369268851f, 0.4786286705f, 0.5688888889f, 0.4786286705f, 0.2369268851f };
+
+float Curve::arcLength(const glm::mat4x3& coefficients, float t0, float t1)
+{
+	float halfLength = (t1 - t0) * 0.5f;
+	float middle = (t0 + t1) * 0.5f;
+	float length = 0.0f;
+	for (int i = 0; i < 5; i++)
+		length += gaussWeights[i] * glm::length(evaluateCubicDerivative(coefficients, middle + halfLength * gaussNodes[i]));
+	return length * halfLength;
+}
+
+void Curve::buildArcLengthTable(int samplesPerSegment)
+{
+	int nSegments = getNbSegments();
+	arcSamplesPerSegment = samplesPerSegment;
+	arcCoefficients.resize(nSegments);
+	arcLengths.resize(nSegments * samplesPerSegment + 1);
+	arcLengths[0] = 0.0f;
+
+	float step = 1.0f / samplesPerSegment;
+	for (int segment = 0; segment < nSegments; segment++)
+	{
+		arcCoefficients[segment] = getSegmentCoefficients(segment);
+		for (int k = 0; k < samplesPerSegment; k++)
+		{
+			int j = segment * samplesPerSegment + k;
+			arcLengths[j + 1] = arcLengths[j] + arcLength(arcCoefficients[segment], k * step, (k + 1) * step);
+		}
+	}
+}
+
+void Curve::updateArcLengthSegment(int segment)
+{
+	int n = arcSamplesPerSegment;
+	float step = 1.0f / n;
+	int first = segment * n;
+	float oldEnd = arcLengths[first + n];
+
+	arcCoefficients[segment] = getSegmentCoefficients(segment);
+	for (int k = 0; k < n; k++)
+		arcLengths[first + k + 1] = arcLengths[first + k] + arcLength(arcCoefficients[segment], k * step, (k + 1) * step);
+
+	float delta = arcLengths[first + n] - oldEnd;
+	for (int j = first + n + 1; j < (int)arcLengths.size(); j++)
+		arcLengths[j] += delta;
+}
+
+float Curve::parameterAtDistance(float s, int& segment) const
+{
+	segment = 0;
+	if (arcLengths.size() < 2)
+		return 0.0f;
+
+	// ltima amostra com comprimento <= s; o trecho j vai da amostra j at a j + 1
+	s = glm::clamp(s, 0.0f, arcLengths.back());
+	int j = (int)(std::upper_bound(arcLengths.begin(), arcLengths.end(), s) - arcLengths.begin()) - 1;
+	j = glm::clamp(j, 0, (int)arcLengths.size() - 2);
+
+	segment = j / arcSamplesPerSegment;
+	float step = 1.0f / arcSamplesPerSegment;
+	float t0 = (j % arcSamplesPerSegment) * step;
+
+	// Interpolao linear dentro do trecho e um passo de Newton em L(t) - s, com L'(t) = |p'(t)|
+	float interval = arcLengths[j + 1] - arcLengths[j];
+	float t = interval > 0.0f ? t0 + step * (s - arcLengths[j]) / interval : t0;
+	const glm::mat4x3& coefficients = arcCoefficients[segment];
+	float speed = glm::length(evaluateCubicDerivative(coefficients, t));
+	if (speed > 1e-12f)
+		t = glm::clamp(t - (arcLengths[j] + arcLength(coefficients, t0, t) - s) / speed, t0, t0 + step);
+	return t;
+}
+
+glm::vec3 Curve::pointAtDistance(float s) const
+{
+	if (arcCoefficients.empty())
+		return glm::vec3(0.0f);
+	int segment;
+	float t = parameterAtDistance(s, segment);
+	return evaluateCubic(arcCoefficients[segment], t);
+}
+
+glm::vec3 Curve::tangentAtDistance(float s) const
+{
+	if (arcCoefficients.empty())
+		return glm::vec3(0.0f);
+	int segment;
+	float t = parameterAtDistance(s, segment);
+	glm::vec3 derivative = evaluateCubicDerivative(arcCoefficients[segment], t);
+	float length = glm::length(derivative);
+	return length > 1e-12f ? derivative / length : glm::vec3(0.0f);
+}
+
+bool Curve::isTessellationSupported()
+{
+	return patchParameteri() != nullptr;
+}
+
+void Curve::uploadPatches()
+{
+	// As colunas de G de cada segmento, em sequncia: o patch s so os vrtices 4s a 4s + 3
+	vector <glm::vec3> patches(getNbSegments() * 4);
+	for (int segment = 0; segment < getNbSegments(); segment++)
+	{
+		glm::mat4x3 G = getSegmentGeometry(segment);
+		for (int j = 0; j < 4; j++)
+			patches[segment * 4 + j] = G[j];
+	}
+	nPatchVertices = (int)patches.size();
+
+	if (!patchVAO)
+	{
+		glGenBuffers(1, &patchVBO);
+		glGenVertexArrays(1, &patchVAO);
+		glBindVertexArray(patchVAO);
+		glBindBuffer(GL_ARRAY_BUFFER, patchVBO);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+		glEnableVertexAttribArray(0);
+		glBindVertexArray(0);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, patchVBO);
+	glBufferData(GL_ARRAY_BUFFER, patches.size() * sizeof(GLfloat) * 3, patches.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Curve::drawCurveTessellated(Shader* tessShader, glm::vec4 color, const glm::mat4& viewProjection,
+	int viewportWidth, int viewportHeight, float pixelsPerSegment)
+{
+	if (!patchVAO || !isTessellationSupported())
+		return;
+
+	tessShader->Use();
+	tessShader->setMat4("basis", glm::value_ptr(M));
+	tessShader->setMat4("viewProjection", glm::value_ptr(viewProjection));
+	tessShader->setVec4("finalColor", color.r, color.g, color.b, color.a);
+	tessShader->setVec2("viewportSize", (float)viewportWidth, (float)viewportHeight);
+	tessShader->setFloat("pixelsPerSegment", pixelsPerSegment);
+
+	glBindVertexArray(patchVAO);
+	patchParameteri()(GL_PATCH_VERTICES, 4);
+	glDrawArrays(GL_PATCHES, 0, nPatchVertices);
+	glBindVertexArray(0);
+
+	// O programa das outras curvas volta a ser o atual
+	if (shader)
+		shader->Use();
+}
+
 void Curve::drawCurve(glm::vec4 color)
 {
 	shader->setVec4("finalColor", color.r, color.g, color.b, color.a);
@@ -12,21 +12,102 @@
 
 using namespace std;
 
+// Curva cbica por segmentos: cada segmento  p(t) = G * M * T, com T = (t, t, t, 1),
+// M a matriz de base da subclasse e G os 4 pontos (ou vetores) de controle do segmento
 class Curve
 {
 public:
-	Curve() {}
-	inline void setControlPoints(vector <glm::vec3> controlPoints) { this->controlPoints = controlPoints; }
+	Curve() : VAO(0), VBO(0), patchVAO(0), patchVBO(0), nPatchVertices(0), arcSamplesPerSegment(0),
+		pointsPerSegment(0), adaptiveTolerance(0.0f), adaptiveMaxDepth(0), shader(nullptr) {}
+	// Apaga VAOs e VBOs da curva e dos patches; chamar antes de glfwTerminate, com o contexto ainda ativo
+	void release();
+	// Troca todos os pontos de controle; a curva, os patches e a tabela de comprimento de arco
+	// precisam ser gerados de novo
+	void setControlPoints(const vector <glm::vec3>& controlPoints);
+	// Edio incremental: muda um ponto de controle e marca s os segmentos que usam esse
+	// ponto (1 ou 2, j que segmentos vizinhos dividem a ponta); nada  recalculado at updateCurve
+	void moveControlPoint(int i, const glm::vec3& p);
+	// Gera de novo s os segmentos marcados, no mesmo modo (passo fixo ou adaptativo) da ltima
+	// gerao, e atualiza os patches e a tabela de comprimento de arco, se existirem. Se nenhum
+	// segmento mudou de nmero de pontos (sempre o caso no passo fixo), s os trechos do VBO
+	// desses segmentos so reenviados, com glBufferSubData
+	void updateCurve();
 	void setShader(Shader* shader);
+	// Passo fixo: pointsPerSegment + 1 pontos por segmento, com t = k / pointsPerSegment
+	// (contador inteiro, ento t = 0 e t = 1 saem exatos em todos os segmentos)
 	void generateCurve(int pointsPerSegment);
+	// Passo adaptativo: cada segmento  dividido ao meio at que o polgono de controle
+	// (de Bzier) do pedao fique a menos de 'tolerance' da corda, o que limita a distncia
+	// entre a curva e a linha desenhada. Trechos retos saem com poucos pontos e curvas
+	// fechadas com muitos; maxDepth limita a diviso (no mximo 2^maxDepth pedaos por segmento).
+	// A tolerncia est nas unidades dos pontos: em coordenadas normalizadas da tela, um pixel
+	// de uma janela com altura h vale 2 / h
+	void generateCurveAdaptive(float tolerance, int maxDepth = 12);
 	void drawCurve(glm::vec4 color);
+
+	// Caminho alternativo na GPU (OpenGL 4.0): s as matrizes G dos segmentos vo para a placa,
+	// 4 vrtices por patch, e o shader de avaliao calcula G * M * T. O nmero de pontos de cada
+	// segmento sai do seu comprimento na tela (um trecho de reta a cada pixelsPerSegment pixels),
+	// ento mudar um ponto de controle custa reenviar os patches, no gerar a curva de novo
+	static bool isTessellationSupported();
+	// Envia os patches dos pontos de controle atuais
+	void uploadPatches();
+	// tessShader: programa com curve.vs, curve.tcs, curve.tes e um fragment shader com finalColor
+	void drawCurveTessellated(Shader* tessShader, glm::vec4 color, const glm::mat4& viewProjection,
+		int viewportWidth, int viewportHeight, float pixelsPerSegment = 4.0f);
 	int getNbCurvePoints() { return curvePoints.size(); }
 	glm::vec3 getPointOnCurve(int i) { return curvePoints[i]; }
+	int getNbSegments() const { return controlPoints.size() < 4 ? 0 : ((int)controlPoints.size() - 1) / 3; }
+	// Ponto do segmento em t (0 a 1)
+	glm::vec3 evaluate(int segment, float t) const;
+	// Coeficientes do polinmio do segmento, G * M (ver CurveEval.h)
+	glm::mat4x3 getSegmentCoefficients(int segment) const;
+
+	// Tabela de comprimento de arco: cada segmento  dividido em samplesPerSegment trechos de t
+	// igual e o comprimento de cada trecho  a integral de |p'(t)| por Gauss-Legendre (5 pontos),
+	// acumulada ao longo da curva. Com ela, pointAtDistance e tangentAtDistance acham o trecho por
+	// busca binria (O(log n)) e o t dentro dele com um passo de Newton, ento um objeto que anda
+	// 'velocidade * dt' por quadro tem velocidade constante, independente da densidade dos pontos
+	// da curva e da taxa de quadros. Precisa ser refeita depois de setControlPoints;
+	// updateCurve recalcula s os segmentos editados
+	void buildArcLengthTable(int samplesPerSegment = 16);
+	float getLength() const { return arcLengths.empty() ? 0.0f : arcLengths.back(); }
+	// s de 0 a getLength() (valores fora disso ficam nas pontas)
+	glm::vec3 pointAtDistance(float s) const;
+	// Tangente unitria em s
+	glm::vec3 tangentAtDistance(float s) const;
 protected:
+	// Matriz de geometria G do segmento (os segmentos comeam a cada 3 pontos de controle)
+	virtual glm::mat4x3 getSegmentGeometry(int segment) const = 0;
+	void subdivide(const glm::vec3* b, float tolerance, int depth, vector <glm::vec3>& points);
+	// Pontos de um segmento no modo da ltima gerao, do incio (t = 0) ao fim (t = 1)
+	void tessellateSegment(int segment, vector <glm::vec3>& points);
+	// Recalcula os trechos do segmento na tabela e desloca o comprimento acumulado dos seguintes
+	void updateArcLengthSegment(int segment);
+	// Envia curvePoints para o VBO (criado na primeira vez e reaproveitado depois)
+	void uploadCurve();
+	// Segmento e t do ponto a uma distncia s do incio, pela tabela de comprimento de arco
+	float parameterAtDistance(float s, int& segment) const;
+	// Comprimento do segmento com esses coeficientes entre t0 e t1 (Gauss-Legendre)
+	static float arcLength(const glm::mat4x3& coefficients, float t0, float t1);
+
 	vector <glm::vec3> controlPoints;
 	vector <glm::vec3> curvePoints;
 	glm::mat4 M; //Matriz de base
 	GLuint VAO;
+	GLuint VBO;
+	GLuint patchVAO;
+	GLuint patchVBO;
+	int nPatchVertices;
+	vector <float> arcLengths;                 // comprimento acumulado at cada amostra (a primeira  0)
+	vector <glm::mat4x3> arcCoefficients;      // coeficientes de cada segmento na hora da tabela
+	int arcSamplesPerSegment;
+	int pointsPerSegment;                      // da ltima gerao com passo fixo (0: adaptativa)
+	float adaptiveTolerance;
+	int adaptiveMaxDepth;
+	vector <int> segmentOffsets;               // o segmento s ocupa curvePoints[segmentOffsets[s]] at segmentOffsets[s + 1]
+	vector <int> dirtySegments;
+	vector <char> segmentDirty;
+	vector <glm::vec3> segmentPoints;          // pontos novos de um segmento em updateCurve
 	Shader* shader;
 };
-
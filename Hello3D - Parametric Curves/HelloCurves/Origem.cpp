@@ -29,9 +29,11 @@ using namespace std;
 
 #include <random>
 #include <algorithm>
+#include <cmath>
 
 //Classes utilitrias
 #include "Shader.h"
+#include "DebugDraw.h"
 
 #include "Hermite.h"
 #include "Bezier.h"
@@ -54,6 +56,16 @@ const GLuint WIDTH = 600, HEIGHT = 600;
 
 bool rotateX = false, rotateY = false, rotateZ = false;
 
+// Tecla M alterna a Bzier entre passo fixo e passo adaptativo
+bool adaptiveCurve = true;
+bool curveModeChanged = false;
+// Tecla G alterna a Bzier entre a linha gerada na CPU e a tesselao na GPU
+bool tessellatedCurve = false;
+
+// Ponto de controle da Bzier arrastado com o boto esquerdo do mouse (-1: nenhum)
+int draggedPoint = -1;
+bool leftButtonWasDown = false;
+
 // Funo MAIN
 int main()
 {
@@ -123,15 +135,41 @@ int main()
 	catmull.generateCurve(100);
 	
 	std::vector<glm::vec3> uniPoints = generateUnisinosPointsSet();
-	GLuint VAOUni = generateControlPointsBuffer(uniPoints);
 
 	Bezier bezier;
 	bezier.setControlPoints(uniPoints);
 	bezier.setShader(&shader);
 	bezier.generateCurve(10);
+	int nFixedPoints = bezier.getNbCurvePoints();
+
+	//Tolerncia de meio pixel na altura da janela (as coordenadas normalizadas vo de -1 a 1)
+	float curveTolerance = 0.5f * 2.0f / HEIGHT;
+	bezier.generateCurveAdaptive(curveTolerance);
+	cout << "Bezier: " << nFixedPoints << " pontos com passo fixo (10 por segmento), " << bezier.getNbCurvePoints()
+		<< " com passo adaptativo (tolerancia de 0.5 pixel)" << endl;
 
 	int nbCurvePoints = bezier.getNbCurvePoints();
-	int i = 0;
+
+	//O ponto que percorre a curva anda pelo comprimento de arco, com velocidade constante
+	//(unidades por segundo), qualquer que seja o nmero de pontos gerados ou a taxa de quadros
+	bezier.buildArcLengthTable();
+	float markerSpeed = 0.3f;
+	float markerDistance = 0.0f;
+	double lastTime = glfwGetTime();
+
+	//Na GPU s vo os pontos de controle (como patches); precisa de um contexto OpenGL 4.0
+	Shader* tessShader = nullptr;
+	if (Curve::isTessellationSupported())
+	{
+		tessShader = new Shader("../shaders/curve.vs", "../shaders/curve.fs", "../shaders/curve.tcs", "../shaders/curve.tes");
+		bezier.uploadPatches();
+	}
+	else
+		cout << "Tesselacao indisponivel (OpenGL 4.0): a tecla G nao faz nada" << endl;
+
+	//Polgono de controle e ponto que percorre a curva: acumulados durante o quadro e desenhados juntos
+	DebugDraw debugDraw;
+	debugDraw.initialize(4096);
 
 	// Loop da aplicao - "game loop"
 	while (!glfwWindowShouldClose(window))
@@ -139,6 +177,53 @@ int main()
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funes de callback correspondentes
 		glfwPollEvents();
 
+		double currentTime = glfwGetTime();
+		float deltaTime = (float)(currentTime - lastTime);
+		lastTime = currentTime;
+
+		// Arrasto de pontos de controle: s os segmentos que usam o ponto so gerados de novo
+		// e reenviados (glBufferSubData), o resto da curva fica como est
+		double cursorX, cursorY;
+		int windowWidth, windowHeight;
+		glfwGetCursorPos(window, &cursorX, &cursorY);
+		glfwGetWindowSize(window, &windowWidth, &windowHeight);
+		glm::vec3 cursor((float)(2.0 * cursorX / windowWidth - 1.0), (float)(1.0 - 2.0 * cursorY / windowHeight), 0.0f);
+		bool leftButtonDown = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+		if (leftButtonDown && !leftButtonWasDown)
+		{
+			float closest = 0.03f;
+			for (int p = 0; p < (int)uniPoints.size(); p++)
+			{
+				if (glm::length(uniPoints[p] - cursor) < closest)
+				{
+					closest = glm::length(uniPoints[p] - cursor);
+					draggedPoint = p;
+				}
+			}
+		}
+		else if (!leftButtonDown)
+			draggedPoint = -1;
+		leftButtonWasDown = leftButtonDown;
+
+		if (draggedPoint >= 0 && uniPoints[draggedPoint] != cursor)
+		{
+			uniPoints[draggedPoint] = cursor;
+			bezier.moveControlPoint(draggedPoint, cursor);
+			bezier.updateCurve();
+			nbCurvePoints = bezier.getNbCurvePoints();
+		}
+
+		if (curveModeChanged)
+		{
+			if (adaptiveCurve)
+				bezier.generateCurveAdaptive(curveTolerance);
+			else
+				bezier.generateCurve(10);
+			nbCurvePoints = bezier.getNbCurvePoints();
+			cout << "Bezier " << (adaptiveCurve ? "adaptativa" : "com passo fixo") << ": " << nbCurvePoints << " pontos" << endl;
+			curveModeChanged = false;
+		}
+
 		// Definindo as dimenses da viewport com as mesmas dimenses da janela da aplicao
 		int width, height;
 		glfwGetFramebufferSize(window, &width, &height);
@@ -151,37 +236,32 @@ int main()
 		glLineWidth(10);
 		glPointSize(20);
 
-		
-		glBindVertexArray(VAOUni);
-		shader.setVec4("finalColor", 0, 0, 1, 1);
-		glDrawArrays(GL_LINE_STRIP, 0, uniPoints.size());
-		glBindVertexArray(0);
-
 		//hermite.drawCurve(glm::vec4(1, 0, 0, 1));
-		bezier.drawCurve(glm::vec4(0, 1, 0, 1));
+		if (tessellatedCurve && tessShader)
+			bezier.drawCurveTessellated(tessShader, glm::vec4(0, 1, 0, 1), glm::mat4(1.0f), width, height);
+		else
+			bezier.drawCurve(glm::vec4(0, 1, 0, 1));
 		//catmull.drawCurve(glm::vec4(1, 0, 1, 1));
 
-		glm::vec3 pointOnCurve = bezier.getPointOnCurve(i);
-		vector <glm::vec3> aux;
-		aux.push_back(pointOnCurve);
-		GLuint VAOPoint = generateControlPointsBuffer(aux);
-
-		glBindVertexArray(VAOPoint);
-
-		shader.setVec4("finalColor", 0, 0, 0, 1);
-		// Chamada de desenho - drawcall
-		// CONTORNO e PONTOS - GL_LINE_LOOP e GL_POINTS
-		glDrawArrays(GL_POINTS, 0, aux.size());
-		//glDrawArrays(GL_LINE_STRIP, 0, controlPoints.size());
-		glBindVertexArray(0);
-
-		i = (i + 1) % nbCurvePoints;
+		// Chamadas de desenho - drawcalls: uma para as linhas e uma para os pontos
+		// (as coordenadas j esto no espao da tela, sem cmera)
+		debugDraw.lineStrip(uniPoints.data(), (int)uniPoints.size(), glm::vec4(0, 0, 1, 1));
+		markerDistance = fmod(markerDistance + markerSpeed * deltaTime, bezier.getLength());
+		glm::vec3 marker = bezier.pointAtDistance(markerDistance);
+		debugDraw.point(marker, glm::vec4(0, 0, 0, 1));
+		debugDraw.line(marker, marker + bezier.tangentAtDistance(markerDistance) * 0.1f, glm::vec4(1, 0, 0, 1));
+		debugDraw.flush(glm::mat4(1.0f));
 
 		// Troca os buffers da tela
 		glfwSwapBuffers(window);
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
+	hermite.release();
+	catmull.release();
+	bezier.release();
+	delete tessShader;
+	debugDraw.release();
 	// Finaliza a execuo da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
 	return 0;
@@ -194,6 +274,18 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
+
+	if (key == GLFW_KEY_M && action == GLFW_PRESS)
+	{
+		adaptiveCurve = !adaptiveCurve;
+		curveModeChanged = true;
+	}
+
+	if (key == GLFW_KEY_G && action == GLFW_PRESS)
+	{
+		tessellatedCurve = !tessellatedCurve;
+		cout << "Bezier " << (tessellatedCurve ? "tesselada na GPU" : "gerada na CPU") << endl;
+	}
 }
 
 std::vector<glm::vec3> generateControlPointsSet(int nPoints) {
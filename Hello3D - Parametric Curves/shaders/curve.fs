@@ -0,0 +1,11 @@
+#version 400 core
+
+// Mesmo que hello.fs, na verso da tesselao para ligar com curve.tcs e curve.tes
+uniform vec4 finalColor;
+
+out vec4 color;
+
+void main()
+{
+    color = finalColor;
+}
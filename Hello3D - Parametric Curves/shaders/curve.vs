@@ -0,0 +1,10 @@
+#version 400 core
+layout (location = 0) in vec3 position;
+
+// Os vrtices so as colunas da matriz de geometria G de cada segmento (4 por patch)
+out vec3 vPosition;
+
+void main()
+{
+    vPosition = position;
+}
@@ -4,6 +4,9 @@ void Mesh::initialize(GLuint VAO, int nVertices, Shader* shader, glm::vec3 posit
 {
 	this->VAO = VAO;
 	this->nVertices = nVertices;
+	this->instanceVBO = 0;
+	this->nInstances = 0;
+	this->instanceCapacity = 0;
 	this->shader = shader;
 	this->position = position;
 	this->scale = scale;
@@ -26,3 +29,46 @@ void Mesh::draw()
 	glDrawArrays(GL_TRIANGLES, 0, nVertices);
 	glBindVertexArray(0);
 }
+
+void Mesh::setInstances(const std::vector<MeshInstance>& instances)
+{
+	if (!instanceVBO)
+	{
+		// Os atributos por instncia ficam no mesmo VAO: a matriz ocupa 4 locations (uma por coluna)
+		glGenBuffers(1, &instanceVBO);
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		for (int i = 0; i < 4; i++)
+		{
+			glVertexAttribPointer(4 + i, 4, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (GLvoid*)(i * sizeof(glm::vec4)));
+			glEnableVertexAttribArray(4 + i);
+			glVertexAttribDivisor(4 + i, 1);
+		}
+		//Cor (r, g, b) e expoente especular
+		glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (GLvoid*)offsetof(MeshInstance, color));
+		glEnableVertexAttribArray(8);
+		glVertexAttribDivisor(8, 1);
+		glBindVertexArray(0);
+	}
+
+	//O nmero de instncias muda a cada quadro com o recorte: o buffer s  realocado quando cresce
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	if ((int)instances.size() <= instanceCapacity)
+		glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(MeshInstance), instances.data());
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(MeshInstance), instances.data(), GL_DYNAMIC_DRAW);
+		instanceCapacity = (int)instances.size();
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	nInstances = (int)instances.size();
+}
+
+void Mesh::drawInstanced()
+{
+	shader->setBool("instanced", true);
+	glBindVertexArray(VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, nVertices, nInstances);
+	glBindVertexArray(0);
+	shader->setBool("instanced", false);
+}
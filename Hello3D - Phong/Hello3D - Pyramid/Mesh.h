@@ -5,8 +5,17 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <vector>
+
 #include "Shader.h"
 
+// Atributos de uma instncia no modo instanciado (locations 4 a 8 do vertex shader)
+struct MeshInstance
+{
+	glm::mat4 model;
+	glm::vec3 color;
+	float q; //Expoente especular
+};
 
 class Mesh
 {
@@ -17,9 +26,17 @@ public:
 	void update();
 	void draw();
 
+	//Modo instanciado: todas as instncias compartilham o VAO e so desenhadas com uma nica chamada
+	void setInstances(const std::vector<MeshInstance>& instances);
+	void drawInstanced();
+	int getNbInstances() const { return nInstances; }
+
 protected:
 	GLuint VAO; //Identificador do Vertex Array Object - Vrtices e seus atributos
 	int nVertices;
+	GLuint instanceVBO; //Buffer com um MeshInstance por instncia (divisor 1)
+	int nInstances;
+	int instanceCapacity; //Instncias que cabem no buffer sem realocar
 
 	//Informaes sobre as transformaes a serem aplicadas no objeto
 	glm::vec3 position;
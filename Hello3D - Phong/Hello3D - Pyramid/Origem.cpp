@@ -13,6 +13,8 @@
 #include <vector>
 #include <fstream>
 #include <sstream>
+#include <cmath>
+#include <cstdlib>
 
 using namespace std;
 
@@ -30,17 +32,27 @@ using namespace std;
 #include "Shader.h"
 
 #include "Mesh.h"
+#include "ObjLoader.h"
+#include "Frustum.h"
+#include "InstanceBVH.h"
+#include "HeadlessCapture.h"
+#include "Profiler.h"
+#include "DebugDraw.h"
 
 
 // Prottipo da funo de callback de teclado
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 // Prottipo da funo de callback do mouse
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 
 
 // Prottipos das funes
 int setupGeometry();
-int loadSimpleOBJ(string filepath, int &nVerts, glm::vec3 color = glm::vec3(1.0,0.0,1.0));
+int loadSimpleOBJ(string filepath, int &nVerts, glm::vec3 color = glm::vec3(1.0,0.0,1.0),
+	glm::vec3* boundsMin = nullptr, glm::vec3* boundsMax = nullptr);
+void addSuzanne(vector<Mesh>& objects, vector<MeshInstance>& instances, GLuint VAO, int nVerts, Shader* shader,
+	glm::vec3 position, float angle, glm::vec3 color, float q);
 
 // Dimenses da janela (pode ser alterado em tempo de execuo)
 const GLuint WIDTH = 1000, HEIGHT = 1000;
@@ -56,11 +68,40 @@ float lastX, lastY;
 float sensitivity = 0.05;
 float pitch = 0.0, yaw = -90.0;
 
+// Tecla I alterna entre um nico draw instanciado e um draw por objeto
+bool instancedMode = true;
+// Tecla C alterna o recorte pelo volume de visualizao: pela BVH, pela lista inteira (SIMD) ou desligado
+enum CullingMode { CULL_BVH = 0, CULL_LIST, CULL_NONE };
+int cullingMode = CULL_BVH;
+const char* cullingNames[] = { "BVH", "lista SIMD", "sem recorte" };
+
+// Clique com o boto esquerdo seleciona a Suzanne na mira (centro da tela)
+bool pickRequested = false;
+
+// Tempos de CPU e GPU por etapa do quadro; tecla P mostra o painel, T grava um trace do Chrome
+Profiler profiler;
+ProfilerOverlay profilerOverlay;
+bool showProfiler = false;
+
+// Tecla B mostra os ns da BVH, a luz e o volume de visualizao do momento em que foi apertada
+DebugDraw debugDraw;
+bool showDebug = false;
+bool freezeDebugFrustum = false;
+glm::mat4 debugFrustum;
+
 // Funo MAIN
-int main()
+// Com "--stress [n]" desenha n Suzannes (100 mil por padro) e mostra o tempo mdio de quadro
+// Com "--headless [--frames N] [--out pasta]" desenha N quadros sem janela, grava cada um em PNG e termina
+int main(int argc, char** argv)
 {
+	HeadlessOptions headless;
+	if (!parseHeadlessOptions(argc, argv, headless))
+		return 1;
+
 	// Inicializao da GLFW
 	glfwInit();
+	if (headless.enabled)
+		setHeadlessWindowHints(headless);
 
 	//Muita ateno aqui: alguns ambientes no aceitam essas configuraes
 	//Voc deve adaptar para a verso do OpenGL suportada por sua placa
@@ -77,18 +118,26 @@ int main()
 
 	// Criao da janela GLFW
 	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Ola 3D!", nullptr, nullptr);
+	if (!window)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return 1;
+	}
 	glfwMakeContextCurrent(window);
 
 	// Fazendo o registro da funo de callback para a janela GLFW
 	glfwSetKeyCallback(window, key_callback);
 	glfwSetCursorPosCallback(window, mouse_callback);
+	glfwSetMouseButtonCallback(window, mouse_button_callback);
 	
 
 	glfwSetCursorPos(window,WIDTH / 2, HEIGHT / 2);
 
 
 	//Desabilita o desenho do cursor 
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	if (!headless.enabled)
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 
 	// GLAD: carrega todos os ponteiros d funes da OpenGL
@@ -107,6 +156,19 @@ int main()
 	// Definindo as dimenses da viewport com as mesmas dimenses da janela da aplicao
 	int width, height;
 	glfwGetFramebufferSize(window, &width, &height);
+	//Sem janela, a imagem  desenhada num framebuffer prprio do tamanho da janela
+	HeadlessCapture capture;
+	if (headless.enabled)
+	{
+		width = WIDTH;
+		height = HEIGHT;
+		if (!capture.initialize(headless, width, height))
+		{
+			capture.release();
+			glfwTerminate();
+			return 1;
+		}
+	}
 	glViewport(0, 0, width, height);
 
 
@@ -126,33 +188,111 @@ int main()
 
 	glEnable(GL_DEPTH_TEST);
 
+	int nStress = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (string(argv[i]) == "--stress")
+		{
+			nStress = i + 1 < argc ? atoi(argv[i + 1]) : 0;
+			if (nStress <= 0)
+				nStress = 100000;
+		}
+	}
+
+	//A Suzanne  carregada uma nica vez; cor, posio e brilho de cada cpia so atributos por instncia
 	int nVerts;
-	GLuint VAO = loadSimpleOBJ("../../3D_models/Suzanne/suzanneTriLowPoly.obj", nVerts, glm::vec3(0.0,1.0,1.0));
-	GLuint VAO2 = loadSimpleOBJ("../../3D_models/Suzanne/suzanneTriLowPoly.obj", nVerts);
-	GLuint VAO3 = loadSimpleOBJ("../../3D_models/Suzanne/suzanneTriLowPoly.obj", nVerts, glm::vec3(1.0, 1.0, 0.0));
+	glm::vec3 boundsMin(0.0), boundsMax(0.0);
+	GLuint VAO = loadSimpleOBJ("../../3D_models/Suzanne/suzanneTriLowPoly.obj", nVerts, glm::vec3(1.0, 0.0, 1.0), &boundsMin, &boundsMax);
+
+	//As mesmas cpias como objetos separados (um draw cada), para comparar com o modo instanciado.
+	//Cor e brilho de cada cpia vm dos uniforms, com os mesmos valores das instncias.
+	vector<Mesh> objects;
+	vector<MeshInstance> instances;
+	if (nStress > 0)
+	{
+		//Grade de side x side x side  frente da cmera
+		int side = (int)ceil(cbrt((double)nStress));
+		float q[3] = { 10.0f, 1.0f, 250.0f };
+		for (int i = 0; i < nStress; i++)
+		{
+			int x = i % side, y = (i / side) % side, z = i / (side * side);
+			glm::vec3 position((x - side / 2) * 3.0f, (y - side / 2) * 3.0f, -5.0f - z * 3.0f);
+			glm::vec3 color((float)x / side, (float)y / side, 1.0f - (float)z / side);
+			addSuzanne(objects, instances, VAO, nVerts, &shader, position, (float)(i * 37 % 360), color, q[i % 3]);
+		}
 
-	Mesh suzanne1, suzanne2, suzanne3;
-	suzanne1.initialize(VAO, nVerts, &shader,glm::vec3(-2.75,0.0,0.0));
-	suzanne2.initialize(VAO2, nVerts, &shader);
-	suzanne3.initialize(VAO3, nVerts, &shader,glm::vec3(2.75, 0.0, 0.0));
+		projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 1000.0f);
+		shader.setMat4("projection", glm::value_ptr(projection));
+
+		//Sem esperar o vsync, para medir o tempo de quadro
+		glfwSwapInterval(0);
+	}
+	else
+	{
+		addSuzanne(objects, instances, VAO, nVerts, &shader, glm::vec3(-2.75, 0.0, 0.0), 0.0f, glm::vec3(0.0, 1.0, 1.0), 10.0f);
+		addSuzanne(objects, instances, VAO, nVerts, &shader, glm::vec3(0.0, 0.0, 0.0), 0.0f, glm::vec3(1.0, 0.0, 1.0), 1.0f);
+		addSuzanne(objects, instances, VAO, nVerts, &shader, glm::vec3(2.75, 0.0, 0.0), 0.0f, glm::vec3(1.0, 1.0, 0.0), 250.0f);
+	}
+
+	Mesh suzanne;
+	suzanne.initialize(VAO, nVerts, &shader);
+	suzanne.setInstances(instances);
+
+	//A cena no se move: a caixa de cada instncia no mundo e a BVH sobre elas so calculadas uma vez s
+	BoxList instanceBoxes;
+	instanceBoxes.reserve((int)instances.size());
+	vector<glm::vec3> instanceMin(instances.size()), instanceMax(instances.size());
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		transformBounds(boundsMin, boundsMax, instances[i].model, instanceMin[i], instanceMax[i]);
+		instanceBoxes.add(instanceMin[i], instanceMax[i]);
+	}
+	InstanceBVH bvh;
+	double buildStart = glfwGetTime();
+	bvh.build(instanceMin.data(), instanceMax.data(), (int)instances.size());
+	cout << "BVH: " << bvh.getNbNodes() << " nos para " << bvh.getNbItems() << " instancias em "
+		<< (glfwGetTime() - buildStart) * 1000.0 << " ms" << endl;
+
+	Frustum frustum;
+	vector<unsigned char> visible;
+	vector<int> visibleItems;
+	vector<MeshInstance> visibleInstances;
+	visibleInstances.reserve(instances.size());
+	int nVisible = (int)instances.size();
+
+	//Instncia selecionada e a cor que ela tinha antes do destaque
+	int picked = -1;
+	glm::vec3 pickedColor;
 
 
 	//Definindo as propriedades do material da superficie
 	shader.setFloat("ka", 0.2);
 	shader.setFloat("kd", 0.5);
 	shader.setFloat("ks", 0.5);
-	shader.setFloat("q", 10.0);
 
 	//Definindo a fonte de luz pontual
 	shader.setVec3("lightPos", -2.0, 10.0, 2.0);
 	shader.setVec3("lightColor", 1.0, 1.0, 0.0);
 
 
+	double lastTime = glfwGetTime();
+	int nFrames = 0;
+	bool measuredMode = instancedMode;
+	int measuredCulling = cullingMode;
+
+	//Sem janela a captura j mede o quadro inteiro na GPU, e GL_TIME_ELAPSED no aninha
+	profiler.initialize(240, !headless.enabled);
+	profilerOverlay.initialize();
+	debugDraw.initialize(256 * 1024);
+
 	// Loop da aplicao - "game loop"
-	while (!glfwWindowShouldClose(window))
+	while (headless.enabled ? !capture.isDone() : !glfwWindowShouldClose(window))
 	{
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funes de callback correspondentes
 		glfwPollEvents();
+		if (headless.enabled)
+			capture.beginFrame();
+		profiler.beginFrame();
 
 		// Limpa o buffer de cor
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f); //cor de fundo
@@ -168,27 +308,132 @@ int main()
 		//Atualizando o shader com a posio da cmera
 		shader.setVec3("cameraPos", cameraPos.x, cameraPos.y, cameraPos.z);
 
-		// Chamada de desenho - drawcall
-		shader.setFloat("q", 10.0);
-		suzanne1.update();
-		suzanne1.draw();
+		//Seleo: o raio sai da cmera pela mira; a BVH responde sem percorrer todas as instncias
+		if (pickRequested)
+		{
+			ProfileScope scope(profiler, "Selecao");
+			pickRequested = false;
+			if (picked >= 0)
+				instances[picked].color = pickedColor;
+			float distance = 0.0f;
+			picked = bvh.intersectRay(cameraPos, cameraFront, &distance);
+			if (picked >= 0)
+			{
+				pickedColor = instances[picked].color;
+				instances[picked].color = glm::vec3(1.0, 0.0, 0.0);
+				cout << "Selecionada a Suzanne " << picked << " a " << distance << " unidades" << endl;
+			}
+		}
+
+		//Recorte: s as instncias cuja caixa toca o volume de visualizao so desenhadas
+		profiler.beginScope("Recorte");
+		frustum.extract(projection * view);
+		frustum.resetStats();
+		if (cullingMode == CULL_BVH)
+		{
+			nVisible = bvh.cull(frustum, visibleItems);
+			visible.assign(instances.size(), 0);
+			for (size_t i = 0; i < visibleItems.size(); i++)
+				visible[visibleItems[i]] = 1;
+		}
+		else if (cullingMode == CULL_LIST)
+			nVisible = frustum.cull(instanceBoxes, visible);
+		else
+		{
+			nVisible = (int)instances.size();
+			visible.assign(instances.size(), 1);
+		}
+		profiler.endScope();
 
-		shader.setFloat("q", 1.0);
-		suzanne2.update();
-		suzanne2.draw();
+		// Chamada de desenho - drawcall: uma para todas as instncias, ou uma por objeto
+		profiler.beginScope("Desenho", true);
+		if (instancedMode)
+		{
+			visibleInstances.clear();
+			for (size_t i = 0; i < instances.size(); i++)
+				if (visible[i])
+					visibleInstances.push_back(instances[i]);
+			suzanne.setInstances(visibleInstances);
+			suzanne.drawInstanced();
+		}
+		else
+		{
+			for (size_t i = 0; i < objects.size(); i++)
+			{
+				if (!visible[i])
+					continue;
+				shader.setFloat("q", instances[i].q);
+				shader.setVec3("objectColor", instances[i].color.r, instances[i].color.g, instances[i].color.b);
+				objects[i].update();
+				objects[i].draw();
+			}
+		}
+		profiler.endScope();
 
-		shader.setFloat("q", 250.0);
-		suzanne3.update();
-		suzanne3.draw();
+		//Depurao: os 10 primeiros nveis da BVH bastam para ver como ela divide a cena
+		if (showDebug)
+		{
+			ProfileScope scope(profiler, "Depuracao", true);
+			if (freezeDebugFrustum)
+			{
+				debugFrustum = projection * view;
+				freezeDebugFrustum = false;
+			}
+			debugDraw.bvh(bvh, glm::vec4(0.0, 0.6, 0.0, 1.0), glm::vec4(1.0, 0.5, 0.0, 1.0), 10);
+			debugDraw.cross(glm::vec3(-2.0, 10.0, 2.0), 1.0f, glm::vec4(1.0, 0.8, 0.0, 1.0));
+			debugDraw.frustum(debugFrustum, glm::vec4(1.0, 0.0, 1.0, 1.0));
+			debugDraw.flush(projection * view);
+		}
 
-		// Troca os buffers da tela
-		glfwSwapBuffers(window);
+		if (showProfiler)
+		{
+			ProfileScope scope(profiler, "Painel", true);
+			profilerOverlay.draw(profiler, width, height);
+		}
+		profiler.endFrame();
+
+		// Troca os buffers da tela (ou grava o quadro)
+		if (headless.enabled)
+			capture.endFrame();
+		else
+			glfwSwapBuffers(window);
+
+		// Tempo mdio de quadro da cena de estresse, a cada 2 segundos (recomea ao trocar de modo)
+		if (nStress > 0 && !headless.enabled)
+		{
+			double now = glfwGetTime();
+			if (measuredMode != instancedMode || measuredCulling != cullingMode)
+			{
+				measuredMode = instancedMode;
+				measuredCulling = cullingMode;
+				lastTime = now;
+				nFrames = 0;
+			}
+			else
+			{
+				nFrames++;
+				if (now - lastTime >= 2.0)
+				{
+					cout << nStress << " Suzannes, " << (instancedMode ? "instanciado (1 draw)" : "um draw por objeto") << ": "
+						<< (now - lastTime) * 1000.0 / nFrames << " ms por quadro";
+					cout << ", " << cullingNames[cullingMode] << " (" << nVisible << " visiveis, "
+						<< nStress - nVisible << " descartadas)" << endl;
+					lastTime = now;
+					nFrames = 0;
+				}
+			}
+		}
 	}
+	int exitCode = headless.enabled ? capture.finish() : 0;
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
+	debugDraw.release();
+	profilerOverlay.release();
+	profiler.release();
+	capture.release();
 	// Finaliza a execuo da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
-	return 0;
+	return exitCode;
 }
 
 // Funo de callback de teclado - s pode ter uma instncia (deve ser esttica se
@@ -220,6 +465,33 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 		rotateZ = true;
 	}
 
+	if (key == GLFW_KEY_I && action == GLFW_PRESS)
+	{
+		instancedMode = !instancedMode;
+	}
+
+	if (key == GLFW_KEY_C && action == GLFW_PRESS)
+	{
+		cullingMode = (cullingMode + 1) % 3;
+		cout << "Recorte: " << cullingNames[cullingMode] << endl;
+	}
+
+	if (key == GLFW_KEY_P && action == GLFW_PRESS)
+	{
+		showProfiler = !showProfiler;
+	}
+
+	if (key == GLFW_KEY_T && action == GLFW_PRESS && !profiler.isCapturing())
+	{
+		profiler.captureTrace("profile.json");
+	}
+
+	if (key == GLFW_KEY_B && action == GLFW_PRESS)
+	{
+		showDebug = !showDebug;
+		freezeDebugFrustum = showDebug;
+	}
+
 	float cameraSpeed = 0.05;
 
 	if (key == GLFW_KEY_W)
@@ -243,6 +515,12 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 }
 
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+		pickRequested = true;
+}
+
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
 	//cout << xpos << " " << ypos << endl;
@@ -372,106 +650,65 @@ int setupGeometry()
 	return VAO;
 }
 
-int loadSimpleOBJ(string filepath, int &nVerts, glm::vec3 color)
+// Cria a mesma Suzanne como objeto separado e como instncia; a matriz da instncia 
+// calculada como em Mesh::update (translao, rotao em torno de y)
+void addSuzanne(vector<Mesh>& objects, vector<MeshInstance>& instances, GLuint VAO, int nVerts, Shader* shader,
+	glm::vec3 position, float angle, glm::vec3 color, float q)
 {
-	vector <glm::vec3> vertices;
-	vector <GLuint> indices;
-	vector <glm::vec2> texCoords;
-	vector <glm::vec3> normals;
-	vector <GLfloat> vbuffer;
+	glm::vec3 axis(0.0, 1.0, 0.0);
 
-	ifstream inputFile;
-	inputFile.open(filepath.c_str());
-	if (inputFile.is_open())
-	{
-		char line[100];
-		string sline;
-		
-		
-		
-		while (!inputFile.eof())
-		{
-			inputFile.getline(line, 100);
-			sline = line;
-			
-			string word;
-			
-			istringstream ssline(line);
-			ssline >> word;
-
-			//cout << word << " ";
-			if (word == "v")
-			{
-				glm::vec3 v;
+	Mesh object;
+	object.initialize(VAO, nVerts, shader, position, glm::vec3(1.0, 1.0, 1.0), angle, axis);
+	objects.push_back(object);
 
-				ssline >> v.x >> v.y >> v.z;
-				
-				vertices.push_back(v);
-			}
-			if (word == "vt")
-			{
-				glm::vec2 vt;
+	MeshInstance instance;
+	instance.model = glm::rotate(glm::translate(glm::mat4(1), position), glm::radians(angle), axis);
+	instance.color = color;
+	instance.q = q;
+	instances.push_back(instance);
+}
 
-				ssline >> vt.s >> vt.t;
-				
-				texCoords.push_back(vt);
-			}
-			if (word == "vn")
-			{
-				glm::vec3 vn;
+int loadSimpleOBJ(string filepath, int &nVerts, glm::vec3 color, glm::vec3* boundsMin, glm::vec3* boundsMax)
+{
+	vector <GLfloat> vbuffer;
 
-				ssline >> vn.x >> vn.y >> vn.z;
+	//Leitura do OBJ mapeado em memria, dividida entre todas as threads
+	ObjData obj;
+	if (loadObj(filepath, obj, 0))
+	{
+		vbuffer.reserve(obj.corners.size() * 11);
 
-				normals.push_back(vn);
-			}
-			if (word == "f")
-			{
-				string tokens[3];
-				
-				ssline >> tokens[0] >> tokens[1] >> tokens[2];
-				
-				for (int i = 0; i < 3; i++)
-				{
-					//Recuperando os indices de v
-					int pos = tokens[i].find("/");
-					string token = tokens[i].substr(0, pos);
-					int index = atoi(token.c_str()) - 1;
-					indices.push_back(index);
-					
-					vbuffer.push_back(vertices[index].x);
-					vbuffer.push_back(vertices[index].y);
-					vbuffer.push_back(vertices[index].z);
-					vbuffer.push_back(color.r);
-					vbuffer.push_back(color.g);
-					vbuffer.push_back(color.b);
-				
-					//Recuperando os indices de vts
-					tokens[i] = tokens[i].substr(pos + 1);
-					pos = tokens[i].find("/");
-					token = tokens[i].substr(0, pos);
-					index = atoi(token.c_str()) - 1;
-
-					vbuffer.push_back(texCoords[index].s);
-					vbuffer.push_back(texCoords[index].t);
-
-					//Recuperando os indices de vns
-					tokens[i] = tokens[i].substr(pos + 1);
-					index = atoi(tokens[i].c_str()) - 1;
-
-					vbuffer.push_back(normals[index].x);
-					vbuffer.push_back(normals[index].y);
-					vbuffer.push_back(normals[index].z);
-				}
-			}
+		for (size_t i = 0; i < obj.corners.size(); i++)
+		{
+			const ObjIndex& corner = obj.corners[i];
 
+			glm::vec3 v = obj.positions[corner.v];
+			glm::vec2 vt = corner.vt >= 0 ? obj.texCoords[corner.vt] : glm::vec2(0.0);
+			glm::vec3 vn = corner.vn >= 0 ? obj.normals[corner.vn] : glm::vec3(0.0);
+
+			vbuffer.insert(vbuffer.end(), { v.x, v.y, v.z });
+			vbuffer.insert(vbuffer.end(), { color.r, color.g, color.b });
+			vbuffer.insert(vbuffer.end(), { vt.s, vt.t });
+			vbuffer.insert(vbuffer.end(), { vn.x, vn.y, vn.z });
 		}
 
+		//Caixa envolvente nas coordenadas do objeto, para o recorte
+		glm::vec3 vMin = obj.positions.empty() ? glm::vec3(0.0) : obj.positions[0];
+		glm::vec3 vMax = vMin;
+		for (size_t i = 1; i < obj.positions.size(); i++)
+		{
+			vMin = glm::min(vMin, obj.positions[i]);
+			vMax = glm::max(vMax, obj.positions[i]);
+		}
+		if (boundsMin)
+			*boundsMin = vMin;
+		if (boundsMax)
+			*boundsMax = vMax;
 	}
 	else
 	{
 		cout << "Problema ao encontrar o arquivo " << filepath << endl;
 	}
-	inputFile.close();
 
 	GLuint VBO, VAO;
 
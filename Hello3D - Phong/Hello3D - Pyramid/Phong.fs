@@ -4,6 +4,7 @@
 in vec3 finalColor;
 in vec3 fragPos;
 in vec3 scaledNormal;
+flat in float shininess;
 
 out vec4 color;
 
@@ -11,7 +12,6 @@ out vec4 color;
 uniform float ka;
 uniform float kd;
 uniform float ks;
-uniform float q;
 
 //Propriedades da fonte de luz
 uniform vec3 lightPos;
@@ -35,7 +35,7 @@ void main()
 	vec3 V = normalize(cameraPos - fragPos);
 	vec3 R = normalize(reflect(-L,N));
 	float spec = max(dot(R,V),0.0);
-	spec = pow(spec,q);
+	spec = pow(spec,shininess);
 	vec3 specular = ks * spec * lightColor;
 
 	vec3 result = (ambient + diffuse) * finalColor + specular;
@@ -5,19 +5,28 @@ layout (location = 1) in vec3 color;
 layout (location = 2) in vec2 texc;
 layout (location = 3) in vec3 normal;
 
+//Atributos por instncia (modo instanciado): matriz de modelo e cor + expoente especular
+layout (location = 4) in mat4 instanceModel;
+layout (location = 8) in vec4 instanceColor;
+
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform float q;
+uniform vec3 objectColor; //Cor no modo de um draw por objeto, a mesma da instncia
+uniform bool instanced;
 
 out vec3 finalColor;
 out vec3 fragPos;
 out vec3 scaledNormal;
+flat out float shininess;
 
 void main()
 {
-	//...pode ter mais linhas de cdigo aqui!
-	gl_Position = projection * view * model * vec4(position, 1.0);
-	finalColor = color;
-	scaledNormal = normal;
-	fragPos = vec3(model * vec4(position, 1.0));
+	mat4 M = instanced ? instanceModel : model;
+	gl_Position = projection * view * M * vec4(position, 1.0);
+	finalColor = instanced ? instanceColor.rgb : objectColor;
+	shininess = instanced ? instanceColor.a : q;
+	scaledNormal = mat3(M) * normal;
+	fragPos = vec3(M * vec4(position, 1.0));
 }
\ No newline at end of file
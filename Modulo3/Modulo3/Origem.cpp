@@ -17,6 +17,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include "stb_image.h"
 #include "Shader.h"
+#include "ObjLoader.h"
 
 using namespace std;
 
@@ -207,56 +208,24 @@ void readFromMtl(const string& path) {
 }
 
 void readFromObj(const string& path) {
-    ifstream file(path);
-    if (!file.is_open()) {
-        cerr << "Failed to open the OBJ file." << endl;
+    ObjData obj;
+    // loadObj já informa o erro
+    if (!loadObj(path, obj, 0))
         return;
-    }
-
-    vector<glm::vec3> temp_vertices, temp_normals;
-    vector<glm::vec2> temp_textures;
-    string line;
 
-    while (getline(file, line)) {
-        if (line.empty()) continue;
+    mtlFilePath = obj.mtlFileName;
 
-        istringstream iss(line);
-        string prefix;
-        iss >> prefix;
+    vertices.reserve(obj.corners.size() * 3);
+    textures.reserve(obj.corners.size() * 2);
+    for (const ObjIndex& corner : obj.corners) {
+        const glm::vec3& vertex = obj.positions[corner.v];
+        glm::vec2 uv = corner.vt >= 0 ? obj.texCoords[corner.vt] : glm::vec2(0.0f);
 
-        if (prefix == "v") {
-            glm::vec3 vertex;
-            iss >> vertex.x >> vertex.y >> vertex.z;
-            temp_vertices.push_back(vertex);
-        }
-        else if (prefix == "vt") {
-            glm::vec2 uv;
-            iss >> uv.x >> uv.y;
-            temp_textures.push_back(uv);
-        }
-        else if (prefix == "vn") {
-            glm::vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            temp_normals.push_back(normal);
-        }
-        else if (prefix == "f") {
-            unsigned int vertexIndex, uvIndex, normalIndex;
-            char slash;
-            for (int i = 0; i < 3; ++i) {
-                iss >> vertexIndex >> slash >> uvIndex >> slash >> normalIndex;
-                glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-                glm::vec2 uv = temp_textures[uvIndex - 1];
-
-                vertices.push_back(vertex.x);
-                vertices.push_back(vertex.y);
-                vertices.push_back(vertex.z);
-                textures.push_back(uv.x);
-                textures.push_back(uv.y);
-            }
-        }
-        else if (prefix == "mtllib") {
-            iss >> mtlFilePath;
-        }
+        vertices.push_back(vertex.x);
+        vertices.push_back(vertex.y);
+        vertices.push_back(vertex.z);
+        textures.push_back(uv.x);
+        textures.push_back(uv.y);
     }
 }
 
@@ -4,6 +4,8 @@ void Mesh::initialize(GLuint VAO, int nVertices, Shader* shader, glm::vec3 posit
 {
 	this->VAO = VAO;
 	this->nVertices = nVertices;
+	this->nIndices = 0;
+	this->indexType = GL_UNSIGNED_INT;
 	this->shader = shader;
 	this->position = position;
 	this->scale = scale;
@@ -23,6 +25,15 @@ void Mesh::update()
 void Mesh::draw()
 {
 	glBindVertexArray(VAO);
-	glDrawArrays(GL_TRIANGLES, 0, nVertices);
+	if (nIndices > 0)
+		glDrawElements(GL_TRIANGLES, nIndices, indexType, 0);
+	else
+		glDrawArrays(GL_TRIANGLES, 0, nVertices);
 	glBindVertexArray(0);
 }
+
+void Mesh::setIndexBuffer(int nIndices, GLenum indexType)
+{
+	this->nIndices = nIndices;
+	this->indexType = indexType;
+}
@@ -15,11 +15,15 @@ public:
 	~Mesh() {}
 	void initialize(GLuint VAO, int nVertices, Shader* shader, glm::vec3 position = glm::vec3(0.0, 0.0, 0.0), glm::vec3 scale = glm::vec3(1.0, 1.0, 1.0), float angle = 0.0, glm::vec3 axis = glm::vec3(0.0, 0.0, 1.0));
 	void update();
+	// Passa a desenhar com glDrawElements usando o EBO associado ao VAO
+	void setIndexBuffer(int nIndices, GLenum indexType);
 	void draw();
 
 protected:
 	GLuint VAO; //Identificador do Vertex Array Object - Vrtices e seus atributos
 	int nVertices;
+	int nIndices; //Quantidade de ndices no EBO (0 quando no indexado)
+	GLenum indexType; //GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT
 
 	//Informaes sobre as transformaes a serem aplicadas no objeto
 	glm::vec3 position;
@@ -21,6 +21,9 @@
 #include "stb_image.h"
 #include "Shader.h"
 #include "Mesh.h"
+#include "ObjLoader.h"
+#include "MeshCache.h"
+#include "CookedTexture.h"
 
 using namespace std;
 
@@ -31,13 +34,13 @@ void resetAllRotate();
 void setupTransformations(glm::mat4& model);
 
 // Configuração da geometria
-void readFromObj(string path);
+bool readFromObj(string path);
 void readMtlFile(string path);
 int setupGeometry();
 int loadTexture(string path);
 
-// Valores do OBJ
-vector<GLfloat> totalVertices;
+// Valores do OBJ (vértices únicos intercalados e índices das faces), lidos do cache .meshbin
+MeshCache meshCache;
 vector<GLfloat> vertexPositions;
 vector<GLfloat> textureCoords;
 vector<GLfloat> normals;
@@ -77,7 +80,10 @@ int main()
     Shader shader("../shaders/sprite.vs", "../shaders/sprite.fs");
 
     // Ler arquivos OBJ e MTL
-    readFromObj(basePath + objFileName);
+    if (!readFromObj(basePath + objFileName)) {
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
     readMtlFile(basePath + mtlFilePath);
 
     // Carregar textura
@@ -88,21 +94,24 @@ int main()
 
     // Usar o programa de shader
     glUseProgram(shader.ID);
-    glUniform1i(glGetUniformLocation(shader.ID, "tex_buffer"), 0);
+    shader.setInt("tex_buffer", 0);
+
+    // Uniforms atualizados a cada quadro, resolvidos uma única vez
+    UniformMat4 modelUniform = shader.uniform("model");
+    UniformMat4 viewUniform = shader.uniform("view");
 
     // Configurar matriz de projeção
     glm::mat4 projection = glm::ortho(0.0f, 800.0f, 0.0f, 600.0f, -1000.0f, 1000.0f);
-    GLint projLoc = glGetUniformLocation(shader.ID, "projection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    shader.setMat4("projection", glm::value_ptr(projection));
 
     // Configurar matriz de visualização
     glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    GLint viewLoc = glGetUniformLocation(shader.ID, "view");
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+    viewUniform.set(glm::value_ptr(view));
 
     // Inicializar o objeto
     Mesh object;
-    object.initialize(VAO, (totalVertices.size() / 8), &shader, glm::vec3(-2.75f, 0.0f, 0.0f));
+    object.initialize(VAO, meshCache.getNbVertices(), &shader, glm::vec3(-2.75f, 0.0f, 0.0f));
+    object.setIndexBuffer(meshCache.getNbIndices(), meshCache.getIndexSize() == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
 
     // Configurar parâmetros de iluminação
     shader.setVec3("ka", ka[0], ka[1], ka[2]);
@@ -138,11 +147,10 @@ int main()
         // Configurar matriz de modelo
         glm::mat4 model = glm::mat4(1.0f);
         setupTransformations(model);
-        GLint modelLoc = glGetUniformLocation(shader.ID, "model");
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+        modelUniform.set(glm::value_ptr(model));
 
-        // Passar matriz de visualização para o shader
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        // Passar matriz de visualização para o shader (só é enviada de novo se mudar)
+        viewUniform.set(glm::value_ptr(view));
 
         // Ativar textura e desenhar o objeto
         glActiveTexture(GL_TEXTURE0);
@@ -205,27 +213,38 @@ void readMtlFile(string path)
 
 int setupGeometry()
 {
-    GLuint VBO, VAO;
+    GLuint VBO, EBO, VAO;
 
-    // Gerar buffer de vértices e array de vértices
+    // Gerar buffer de vértices, de índices e array de vértices
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
     glGenVertexArrays(1, &VAO);
 
     // Bind do VBO e VAO
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, totalVertices.size() * sizeof(GLfloat), totalVertices.data(), GL_STATIC_DRAW);
+    // Os dados vêm direto do arquivo mapeado, sem cópias intermediárias
+    glBufferData(GL_ARRAY_BUFFER, meshCache.getVerticesSize(), meshCache.getVertices(), GL_STATIC_DRAW);
     glBindVertexArray(VAO);
 
-    // Configurar atributos de vértices
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
-    glEnableVertexAttribArray(0);
+    // Índices ficam associados ao VAO; o cache já os guarda em 16 bits quando há até 65536 vértices
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshCache.getIndicesSize(), meshCache.getIndices(), GL_STATIC_DRAW);
 
-    // Configurar atributos de textura
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+    GLsizei stride = meshCache.getVertexStride();
+    if (meshCache.getVertexFormat() == MESH_VERTEX_QUANTIZED) {
+        // Malha cozida pelo AssetCooker: textura em half float e normal em snorm16 normalizado
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)12);
+        glVertexAttribPointer(2, 3, GL_SHORT, GL_TRUE, stride, (void*)16);
+    }
+    else {
+        // Configurar atributos de vértices, textura e normais
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(GLfloat)));
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(GLfloat)));
+    }
+    glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
-
-    // Configurar atributos de normais
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(5 * sizeof(GLfloat)));
     glEnableVertexAttribArray(2);
 
     // Desvincular VBO e VAO
@@ -235,74 +254,25 @@ int setupGeometry()
     return VAO;
 }
 
-void readFromObj(string path) {
-    std::ifstream file(path);
-
-    if (!file.is_open()) {
-        std::cout << "Failed to open the file." << std::endl;
-        return;
+bool readFromObj(string path) {
+    // Usa o .meshbin ao lado do OBJ; na primeira execução (ou se o OBJ mudou) o OBJ é
+    // lido em paralelo, cada trinca (v, vt, vn) distinta vira um vértice de 8 floats e o cache é gravado
+    double startTime = glfwGetTime();
+    if (!meshCache.load(path, 0)) {
+        std::cout << "Failed to load " << path << std::endl;
+        return false;
     }
+    double elapsedMs = (glfwGetTime() - startTime) * 1000.0;
 
-    std::vector<glm::vec3> tempVertices;
-    std::vector<glm::vec2> tempTextures;
-    std::vector<glm::vec3> tempNormals;
-
-    std::string line;
-
-    // Ler cada linha do arquivo .obj
-    while (std::getline(file, line)) {
-        if (!line.empty()) {
-            std::istringstream iss(line);
-            std::string prefix;
-            iss >> prefix;
-
-            // Verificar prefixos e carregar dados apropriados
-            if (prefix == "v") {
-                glm::vec3 values;
-                iss >> values.x >> values.y >> values.z;
-                tempVertices.push_back(values);
-            }
-            else if (prefix == "vt") {
-                glm::vec2 values;
-                iss >> values.x >> values.y;
-                tempTextures.push_back(values);
-            }
-            else if (prefix == "vn") {
-                glm::vec3 values;
-                iss >> values.x >> values.y >> values.z;
-                tempNormals.push_back(values);
-            }
-            else if (prefix == "f") {
-                unsigned int vertexIndex[3], textIndex[3], normalIndex[3];
-                char slash;
-
-                // Ler índices de vértices, texturas e normais
-                for (int i = 0; i < 3; ++i) {
-                    iss >> vertexIndex[i] >> slash >> textIndex[i] >> slash >> normalIndex[i];
-
-                    // Verificar se os índices estão dentro dos limites
-                    if (vertexIndex[i] > tempVertices.size() || textIndex[i] > tempTextures.size() || normalIndex[i] > tempNormals.size()) {
-                        std::cerr << "Index out of bounds in OBJ file at line: " << line << std::endl;
-                        return;
-                    }
-
-                    // Carregar vértices, texturas e normais nos vetores correspondentes
-                    glm::vec3 vertex = tempVertices[vertexIndex[i] - 1];
-                    glm::vec3 normal = tempNormals[normalIndex[i] - 1];
-                    glm::vec2 texture = tempTextures[textIndex[i] - 1];
-
-                    totalVertices.insert(totalVertices.end(), { vertex.x, vertex.y, vertex.z });
-                    totalVertices.insert(totalVertices.end(), { texture.x, texture.y });
-                    totalVertices.insert(totalVertices.end(), { normal.x, normal.y, normal.z });
-                }
-            }
-            else if (prefix == "mtllib") {
-                iss >> mtlFilePath;
-            }
-        }
-    }
+    mtlFilePath = meshCache.getMtlFileName();
 
-    file.close();
+    int nUniqueVertices = meshCache.getNbVertices();
+    std::cout << path << ": " << meshCache.getNbIndices() << " cantos -> " << nUniqueVertices
+        << " vertices unicos (reuso de " << (nUniqueVertices ? (float)meshCache.getNbIndices() / nUniqueVertices : 0.0f) << "x)" << std::endl;
+    const char* source = !meshCache.wasCacheHit() ? "OBJ lido e cache .meshbin gravado"
+        : meshCache.isCooked() ? "Malha cozida (AssetCooker) carregada" : "Cache .meshbin carregado";
+    std::cout << source << " em " << elapsedMs << " ms" << std::endl;
+    return true;
 }
 
 int loadTexture(string path)
@@ -318,9 +288,21 @@ int loadTexture(string path)
     // Configurar parâmetros de textura
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
+    // Textura cozida pelo AssetCooker: mipmaps prontos, sem decodificar a imagem
+    CookedTexture cooked;
+    if (cooked.load(path)) {
+        for (int level = 0; level < cooked.getNbLevels(); level++) {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, cooked.getWidth(level), cooked.getHeight(level), 0,
+                GL_RGBA, GL_UNSIGNED_BYTE, cooked.getLevel(level));
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, cooked.getNbLevels() - 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return textureID;
+    }
+
     // Carregar imagem da textura
     int width, height, nrChannels;
     unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
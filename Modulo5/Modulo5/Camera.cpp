@@ -6,10 +6,12 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-void Camera::initialize(Shader* shader, int width, int height, glm::vec3 cameraPos, glm::vec3 cameraFront, glm::vec3 cameraUp, bool firstMouse,
+void Camera::initialize(UniformBuffer* frameBuffer, int width, int height, glm::vec3 cameraPos, glm::vec3 cameraFront, glm::vec3 cameraUp, bool firstMouse,
 	float lastX, float lastY, float sensitivity, float pitch, float yaw)
 {
-	this->shader = shader;
+	this->frameBuffer = frameBuffer;
+	this->pickTarget = nullptr;
+	this->picked = -1;
 
 	this->cameraPos = cameraPos;
 	this->cameraFront = cameraFront;
@@ -22,22 +24,24 @@ void Camera::initialize(Shader* shader, int width, int height, glm::vec3 cameraP
 	this->pitch = pitch;
 	this->yaw = yaw;
 
-	// Matriz de view -- posio e orientao da cmera
-	glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-	shader->setMat4("view", glm::value_ptr(view));
-
 	// Matriz de projeo perspectiva - definindo o volume de visualizao (frustum)
-	glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
-	shader->setMat4("projection", glm::value_ptr(projection));
+	frame.projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
+	frame.pad0 = 0.0f;
+
+	// Matriz de view -- posio e orientao da cmera
+	update();
 }
 
 void Camera::update()
 {
-	glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-	shader->setMat4("view", glm::value_ptr(view));
+	frame.view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
 
-	// Atualizando o shader com a posio da cmera
-	shader->setVec3("cameraPos", cameraPos.x, cameraPos.y, cameraPos.z);
+	// Atualizando o bloco com a posio da cmera; uma nica escrita serve a todos os programas
+	frame.cameraPos = cameraPos;
+	frameBuffer->update(&frame);
+
+	// Os mesmos planos servem para descartar na CPU o que no aparece neste quadro
+	frustum.extract(frame.projection * frame.view);
 }
 
 void Camera::mouseCallback(GLFWwindow* window, double xpos, double ypos)
@@ -69,6 +73,12 @@ void Camera::mouseCallback(GLFWwindow* window, double xpos, double ypos)
 	cameraFront = glm::normalize(front);
 }
 
+int Camera::pick()
+{
+	picked = pickTarget ? pickTarget->intersectRay(cameraPos, cameraFront) : -1;
+	return picked;
+}
+
 void Camera::setCameraPos(int key, float cameraSpeed) {
 	if (key == GLFW_KEY_W)
 	{
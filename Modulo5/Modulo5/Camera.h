@@ -6,6 +6,9 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Shader.h"
+#include "UniformBuffer.h"
+#include "Frustum.h"
+#include "InstanceBVH.h"
 
 
 class Camera
@@ -13,11 +16,12 @@ class Camera
 public:
 	Camera() {}
 	~Camera() {}
+	// view, projection e cameraPos vo para o bloco PerFrame de frameBuffer
 	void initialize(
-		Shader* shader,
+		UniformBuffer* frameBuffer,
 		int width, int height,
 		glm::vec3 cameraPos = glm::vec3(0.0, 0.0, 3.0),
-        glm::vec3 cameraFront = glm::vec3(0.0, 0.0, 0.0),
+        glm::vec3 cameraFront = glm::vec3(0.0, 0.0, -1.0),
         glm::vec3 cameraUp = glm::vec3(0.0, 1.0, 0.0),
 		bool firstMouse = true,
 		float lastX = 0, 
@@ -30,6 +34,19 @@ public:
 	void mouseCallback(GLFWwindow* window, double xpos, double ypos);
 	void setCameraPos(int key, float cameraSpeed = 0.5f);
 
+	const glm::mat4& getView() const { return frame.view; }
+	const glm::mat4& getProjection() const { return frame.projection; }
+	glm::mat4 getViewProjection() const { return frame.projection * frame.view; }
+	// Planos do volume de visualizao, atualizados por update()
+	Frustum& getFrustum() { return frustum; }
+
+	// Com o cursor preso, o raio de seleo sai da cmera pelo centro da tela; pick procura na BVH
+	// o objeto atingido (-1 se nenhum ou sem BVH). Chamar uma vez por quadro, depois de update
+	void setPickTarget(const InstanceBVH* pickTarget) { this->pickTarget = pickTarget; picked = -1; }
+	void getPickRay(glm::vec3& origin, glm::vec3& direction) const { origin = cameraPos; direction = cameraFront; }
+	int pick();
+	int getPicked() const { return picked; }
+
 protected:
 	glm::vec3 cameraPos;
 	glm::vec3 cameraFront;
@@ -43,5 +60,10 @@ protected:
 	float pitch;
 	float yaw;
 
-	Shader* shader;
+	UniformBuffer* frameBuffer;
+	PerFrameBlock frame;
+	Frustum frustum;
+
+	const InstanceBVH* pickTarget;
+	int picked;
 };
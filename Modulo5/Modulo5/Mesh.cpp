@@ -4,6 +4,12 @@ void Mesh::initialize(GLuint VAO, int nVertices, Shader* shader, glm::vec3 posit
 {
 	this->VAO = VAO;
 	this->nVertices = nVertices;
+	this->nIndices = 0;
+	this->indexType = GL_UNSIGNED_INT;
+	this->subMeshes.clear();
+	this->nMaterialBinds = 0;
+	this->materialBuffer = nullptr;
+	this->hasBounds = false;
 	this->shader = shader;
 	this->position = position;
 	this->scale = scale;
@@ -16,6 +22,103 @@ void Mesh::draw(GLuint texId)
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, texId);
 	glBindVertexArray(VAO);
-	glDrawArrays(GL_TRIANGLES, 0, nVertices);
+	if (!subMeshes.empty())
+	{
+		// Os materiais só são trocados quando mudam de um intervalo para o próximo
+		size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+		int bound = -1;
+		nMaterialBinds = 0;
+		for (size_t i = 0; i < subMeshes.size(); i++)
+		{
+			const SubMeshRange& range = subMeshes[i];
+			if (range.materialBlock != bound || i == 0)
+			{
+				applyMaterial(range, texId);
+				bound = range.materialBlock;
+				nMaterialBinds++;
+			}
+			glDrawElements(GL_TRIANGLES, range.indexCount, indexType, (void*)(range.firstIndex * indexSize));
+		}
+	}
+	else if (nIndices > 0)
+		glDrawElements(GL_TRIANGLES, nIndices, indexType, 0);
+	else
+		glDrawArrays(GL_TRIANGLES, 0, nVertices);
 	glBindVertexArray(0);
 }
+
+void Mesh::submit(RenderQueue& queue, GLuint texId, const glm::mat4* model, float depth, Frustum* frustum)
+{
+	// Caixas de todas as submalhas (ou da malha inteira) testadas de uma vez contra o frustum
+	bool culling = frustum && (!subMeshes.empty() || hasBounds);
+	if (culling)
+	{
+		glm::mat4 world = model ? *model : glm::mat4(1.0f);
+		cullBoxes.clear();
+		if (subMeshes.empty())
+			cullBoxes.add(boundsMin, boundsMax, world);
+		for (size_t i = 0; i < subMeshes.size(); i++)
+			cullBoxes.add(subMeshes[i].boundsMin, subMeshes[i].boundsMax, world);
+		if (frustum->cull(cullBoxes, visible) == 0)
+			return;
+	}
+
+	DrawItem item = RenderQueue::makeItem(shader, VAO, 0, nVertices);
+	item.texture = texId;
+	item.model = model ? glm::value_ptr(*model) : nullptr;
+	item.depth = depth;
+	if (nIndices > 0)
+	{
+		item.indexType = indexType;
+		item.count = nIndices;
+	}
+
+	if (subMeshes.empty())
+	{
+		queue.add(item);
+		return;
+	}
+
+	for (size_t i = 0; i < subMeshes.size(); i++)
+	{
+		if (culling && !visible[i])
+			continue;
+
+		const SubMeshRange& range = subMeshes[i];
+		item.first = range.firstIndex;
+		item.count = range.indexCount;
+		item.texture = range.material && range.material->textureId ? range.material->textureId : texId;
+		item.materialBuffer = materialBuffer;
+		item.materialBlock = range.materialBlock;
+		queue.add(item);
+	}
+}
+
+void Mesh::addSubMesh(int firstIndex, int indexCount, const Material* material, int materialBlock,
+	const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	SubMeshRange range = { firstIndex, indexCount, material, materialBlock, boundsMin, boundsMax };
+	subMeshes.push_back(range);
+}
+
+void Mesh::setBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	this->boundsMin = boundsMin;
+	this->boundsMax = boundsMax;
+	this->hasBounds = true;
+}
+
+void Mesh::applyMaterial(const SubMeshRange& range, GLuint texId)
+{
+	// As propriedades já estão no buffer: trocar de material é só ligar outro intervalo
+	if (materialBuffer)
+		materialBuffer->bind(range.materialBlock);
+
+	glBindTexture(GL_TEXTURE_2D, range.material && range.material->textureId ? range.material->textureId : texId);
+}
+
+void Mesh::setIndexBuffer(int nIndices, GLenum indexType)
+{
+	this->nIndices = nIndices;
+	this->indexType = indexType;
+}
@@ -5,7 +5,13 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <vector>
+
 #include "Shader.h"
+#include "MtlLoader.h"
+#include "UniformBuffer.h"
+#include "RenderQueue.h"
+#include "Frustum.h"
 
 
 class Mesh
@@ -18,11 +24,59 @@ public:
 		glm::vec3 scale = glm::vec3(1.0, 1.0, 1.0), 
 		float angle = 0.0, 
 		glm::vec3 axis = glm::vec3(0.0, 0.0, 1.0));
+	// Passa a desenhar com glDrawElements usando o EBO associado ao VAO
+	void setIndexBuffer(int nIndices, GLenum indexType);
+	// Buffer com um bloco PerMaterial por material, usado pelas submalhas
+	void setMaterialBuffer(UniformBuffer* materialBuffer) { this->materialBuffer = materialBuffer; }
+	// Intervalo de ndices desenhado com um material (textura) e a cpia 'materialBlock' do bloco
+	// PerMaterial; intervalos do mesmo material devem ser vizinhos. boundsMin e boundsMax
+	// envolvem os tringulos do intervalo, em coordenadas do objeto
+	void addSubMesh(int firstIndex, int indexCount, const Material* material, int materialBlock,
+		const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	// Caixa da malha inteira, usada no recorte quando no h submalhas
+	void setBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	// texId  usada quando no h submalhas ou quando o material no tem textura
 	void draw(GLuint texId);
+	// Como draw, mas coloca um item por submalha na fila em vez de desenhar; model e depth vo para os itens.
+	// Com frustum, as submalhas cuja caixa (levada ao mundo por model) est fora do volume no entram na fila
+	void submit(RenderQueue& queue, GLuint texId, const glm::mat4* model = nullptr, float depth = 0.0f, Frustum* frustum = nullptr);
+	int getNbMaterialBinds() const { return nMaterialBinds; }
+
+	int getNbSubMeshes() const { return (int)subMeshes.size(); }
+	const Material* getSubMeshMaterial(int i) const { return subMeshes[i].material; }
+	// Caixa da submalha em espao de mundo
+	void getSubMeshBounds(int i, const glm::mat4& model, glm::vec3& worldMin, glm::vec3& worldMax) const
+	{
+		transformBounds(subMeshes[i].boundsMin, subMeshes[i].boundsMax, model, worldMin, worldMax);
+	}
 
 protected:
+	struct SubMeshRange
+	{
+		int firstIndex;
+		int indexCount;
+		const Material* material;
+		int materialBlock;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+	};
+
+	void applyMaterial(const SubMeshRange& range, GLuint texId);
+
 	GLuint VAO; //Identificador do Vertex Array Object - Vrtices e seus atributos
 	int nVertices;
+	int nIndices; //Quantidade de ndices no EBO (0 quando no indexado)
+	GLenum indexType; //GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT
+	std::vector<SubMeshRange> subMeshes;
+	UniformBuffer* materialBuffer;
+	int nMaterialBinds; //Trocas de material no ltimo draw
+
+	//Limites da malha e caixas do ltimo recorte, reaproveitadas a cada quadro
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	bool hasBounds;
+	BoxList cullBoxes;
+	std::vector<unsigned char> visible;
 
 	//Informaes sobre as transformaes a serem aplicadas no objeto
 	glm::vec3 position;
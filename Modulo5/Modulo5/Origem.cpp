@@ -13,6 +13,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdio>
+#include <algorithm>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp> 
@@ -21,39 +22,45 @@
 #include "stb_image.h"
 #include "Shader.h"
 #include "Mesh.h"
+#include "ObjLoader.h"
+#include "MeshCache.h"
+#include "MtlLoader.h"
+#include "AsyncTextureLoader.h"
+#include "TextureManager.h"
+#include "UniformBuffer.h"
+#include "RenderQueue.h"
+#include "InstanceBVH.h"
 #include "Camera.h"
+#include "HeadlessCapture.h"
+#include "Profiler.h"
 
 using namespace std;
 
 // Configuração da janela
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-void setupWindow(GLFWwindow*& window);
-void setupTransformations(glm::mat4& model);
-void setupShader(Shader shader);
+void setupWindow(GLFWwindow*& window, const HeadlessOptions& headless);
+void setupTransformations(glm::mat4& model, float time);
+void setupShader(Shader& shader);
+void setupMaterials();
 
 // Configuração da geometria
-void readFromObj(string path);
+bool readFromObj(string path);
 void readFromMtl(string path);
-int setupGeometry();
-int loadTexture(string path);
+void updateTextures();
+int setupGeometry(GLuint& VBO, GLuint& EBO);
+GLuint createDefaultTexture();
 
-// Valores do OBJ
-vector<GLfloat> totalVertices;
-vector<GLfloat> vertexPositions;
-vector<GLfloat> textureCoords;
-vector<GLfloat> normals;
+// Valores do OBJ (vértices únicos intercalados e índices das faces), lidos do cache .meshbin
+MeshCache meshCache;
 
 // Valores dos arquivos
 string mtlFilePath = "";
-string textureFilePath = "";
 string basePath = "../../3D_Models/Suzanne/";
 string objFileName = "CuboTextured.obj";
 
-// Valores de iluminação
-vector<GLfloat> ka;
-vector<GLfloat> ks;
-float ns;
+// Materiais do MTL (Ka, Kd, Ks, Ke, Ns, Ni, d, illum e map_Kd de cada newmtl)
+vector<Material> materials;
 
 bool firstMouse = true;
 float lastX, lastY;
@@ -77,38 +84,111 @@ GLfloat translateZ = 0.0f;
 
 Camera camera;
 
-int main()
+// Texturas decodificadas em segundo plano e enviadas aos poucos a cada quadro
+AsyncTextureLoader textureLoader;
+
+// Texturas compartilhadas entre materiais (e modelos), por caminho e conteúdo
+TextureManager textureManager;
+
+// Blocos std140 compartilhados pelos programas: câmera (por quadro), luz e um bloco por material
+UniformBuffer frameBuffer;
+UniformBuffer lightBuffer;
+UniformBuffer materialBuffer;
+
+// Itens de desenho do quadro, ordenados por estado antes de desenhar
+RenderQueue renderQueue;
+
+// BVH sobre as caixas das submalhas no mundo, usada na seleção pelo centro da tela
+InstanceBVH sceneBVH;
+vector<glm::vec3> subMeshMin, subMeshMax;
+
+// Tempos de CPU e GPU por etapa do quadro; P mostra o painel, T grava um trace do Chrome
+Profiler profiler;
+ProfilerOverlay profilerOverlay;
+bool showProfiler = false;
+
+// Com "--headless [--frames N] [--out pasta]" desenha N quadros numa janela invisível, grava cada um em PNG e termina
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    HeadlessOptions headless;
+    if (!parseHeadlessOptions(argc, argv, headless))
+        return EXIT_FAILURE;
+
     // Configuração da janela
-    setupWindow(window);
+    setupWindow(window, headless);
 
-    // Obter o tamanho do framebuffer
+    // Obter o tamanho do framebuffer (sem janela, o do framebuffer próprio)
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
+    HeadlessCapture capture;
+    if (headless.enabled) {
+        width = WINDOW_WIDTH;
+        height = WINDOW_HEIGHT;
+        if (!capture.initialize(headless, width, height)) {
+            capture.release();
+            glfwTerminate();
+            return EXIT_FAILURE;
+        }
+    }
     glViewport(0, 0, width, height);
 
     // Carregar shaders
     Shader shader("../shaders/sprite.vs", "../shaders/sprite.fs");
 
+    // Blocos da câmera e da luz (o dos materiais depende do MTL)
+    frameBuffer.initialize(PER_FRAME_BINDING, sizeof(PerFrameBlock));
+    lightBuffer.initialize(PER_LIGHT_BINDING, sizeof(PerLightBlock));
+
+    // Até 4 MB de texturas por quadro
+    textureLoader.initialize(4 * 1024 * 1024);
+    textureManager.initialize(&textureLoader, 256 * 1024 * 1024);
+
     // Ler arquivos OBJ e MTL
-    readFromObj(basePath + objFileName);
+    if (!readFromObj(basePath + objFileName)) {
+        textureLoader.release();
+        frameBuffer.release();
+        lightBuffer.release();
+        capture.release();
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
     readFromMtl(basePath + mtlFilePath);
+    setupMaterials();
 
-    // Carregar textura
-    GLuint textureID = loadTexture(basePath + textureFilePath);
+    // Textura branca para materiais sem map_Kd (as demais são carregadas por readFromMtl)
+    GLuint textureID = createDefaultTexture();
 
     // Configurar geometria
-    GLuint VAO = setupGeometry();
+    GLuint VBO, EBO;
+    GLuint VAO = setupGeometry(VBO, EBO);
 
     // Usar o programa de shader
     glUseProgram(shader.ID);
-    glUniform1i(glGetUniformLocation(shader.ID, "tex_buffer"), 0);
+    shader.setInt("tex_buffer", 0);
 
     // Inicializar o objeto
     Mesh object;
-    object.initialize(VAO, (totalVertices.size() / 8), &shader);
+    object.initialize(VAO, meshCache.getNbVertices(), &shader);
+    object.setIndexBuffer(meshCache.getNbIndices(), meshCache.getIndexSize() == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+    object.setMaterialBuffer(&materialBuffer);
+    object.setBounds(meshCache.getBoundsMin(), meshCache.getBoundsMax());
+
+    // Uma submalha por material, todas no mesmo VAO/EBO; faces sem usemtl (ou com um material
+    // que não está no MTL) usam o último material do arquivo, como antes. O bloco do material i
+    // é a cópia i de materialBuffer (a última cópia é um Material padrão, para MTL vazio).
+    int defaultBlock = materials.empty() ? 0 : (int)materials.size() - 1;
+    const SubMesh* subMeshes = meshCache.getSubMeshes();
+    for (int i = 0; i < meshCache.getNbSubMeshes(); i++) {
+        int materialIndex = -1;
+        if (subMeshes[i].materialIndex >= 0)
+            materialIndex = findMaterial(materials, meshCache.getMaterialNames()[subMeshes[i].materialIndex]);
+        int block = materialIndex >= 0 ? materialIndex : defaultBlock;
+        object.addSubMesh(subMeshes[i].firstIndex, subMeshes[i].indexCount,
+            block < (int)materials.size() ? &materials[block] : nullptr, block,
+            glm::make_vec3(subMeshes[i].boundsMin), glm::make_vec3(subMeshes[i].boundsMax));
+    }
 
     // Configurar shaders
     setupShader(shader);
@@ -117,13 +197,53 @@ int main()
     glEnable(GL_DEPTH_TEST);
 
     // Inicializar câmera
-    camera.initialize(&shader, width, height);
+    camera.initialize(&frameBuffer, width, height);
+    camera.setPickTarget(&sceneBVH);
+    subMeshMin.resize(object.getNbSubMeshes());
+    subMeshMax.resize(object.getNbSubMeshes());
+
+    // Sem janela a captura já mede o quadro inteiro na GPU, e GL_TIME_ELAPSED não aninha
+    profiler.initialize(240, !headless.enabled);
+    profilerOverlay.initialize();
+
+    // Tempo de quadro enquanto as texturas chegam
+    double streamStart = glfwGetTime();
+    double lastFrame = streamStart;
+    double worstFrameMs = 0.0;
+    bool streaming = textureLoader.getNbPending() > 0;
+
+    // Sem janela, todos os quadros são gravados com as texturas completas
+    if (headless.enabled) {
+        while (textureLoader.getNbPending() > 0)
+            updateTextures();
+    }
 
     // Loop de renderização
-    while (!glfwWindowShouldClose(window))
+    while (headless.enabled ? !capture.isDone() : !glfwWindowShouldClose(window))
     {
         // Verificar eventos
         glfwPollEvents();
+        if (headless.enabled)
+            capture.beginFrame();
+        profiler.beginFrame();
+
+        // Enviar o próximo trecho das texturas já decodificadas
+        profiler.beginScope("Texturas");
+        updateTextures();
+        profiler.endScope();
+        if (streaming) {
+            double now = glfwGetTime();
+            worstFrameMs = std::max(worstFrameMs, (now - lastFrame) * 1000.0);
+            lastFrame = now;
+            if (textureLoader.getNbPending() == 0) {
+                std::cout << "Texturas prontas em " << (now - streamStart) * 1000.0 << " ms ("
+                    << textureLoader.getUploadedBytes() / (1024.0 * 1024.0) << " MB, pior quadro "
+                    << worstFrameMs << " ms)" << std::endl;
+                textureManager.printStats();
+                renderQueue.printStats();
+                streaming = false;
+            }
+        }
 
         // Limpar buffers de cor e profundidade
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -131,105 +251,160 @@ int main()
 
         // Configurar matriz de modelo
         glm::mat4 model = glm::mat4(1.0f);
-        setupTransformations(model);
-        GLint modelLoc = glGetUniformLocation(shader.ID, "model");
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-        // Atualizar câmera
+        setupTransformations(model, (float)(headless.enabled ? capture.getTime() : glfwGetTime()));
+
+        // Caixas das submalhas no mundo: enquanto o objeto gira a BVH só é ajustada (refit),
+        // e é refeita quando a topologia muda ou a árvore degrada demais
+        profiler.beginScope("BVH");
+        for (int i = 0; i < object.getNbSubMeshes(); i++)
+            object.getSubMeshBounds(i, model, subMeshMin[i], subMeshMax[i]);
+        if (sceneBVH.getNbItems() != object.getNbSubMeshes() || sceneBVH.needsRebuild())
+            sceneBVH.build(subMeshMin.data(), subMeshMax.data(), object.getNbSubMeshes());
+        else
+            sceneBVH.refit(subMeshMin.data(), subMeshMax.data());
+        profiler.endScope();
+
+        // Atualizar câmera; o objeto pode ter girado para baixo da mira, então a seleção é refeita
+        profiler.beginScope("Camera");
         camera.update();
-
-        // Ativar textura e desenhar o objeto
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-
-        object.draw(textureID);
+        camera.pick();
+        profiler.endScope();
+
+        // Desenhar o objeto pela fila: uma troca de textura/material só quando muda de um item para o próximo;
+        // submalhas fora do volume de visualização nem entram na fila
+        Frustum& frustum = camera.getFrustum();
+        frustum.resetStats();
+        profiler.beginScope("Desenho", true);
+        object.submit(renderQueue, textureID, &model, 0.0f, &frustum);
+        renderQueue.flush();
+        profiler.endScope();
 
         glBindTexture(GL_TEXTURE_2D, 0);
 
-        // Trocar buffers
-        glfwSwapBuffers(window);
+        if (showProfiler) {
+            ProfileScope scope(profiler, "Painel", true);
+            profilerOverlay.draw(profiler, width, height);
+        }
+        profiler.endFrame();
+
+        // Trocar buffers (ou gravar o quadro)
+        if (headless.enabled)
+            capture.endFrame();
+        else
+            glfwSwapBuffers(window);
     }
+    int exitCode = headless.enabled ? capture.finish() : EXIT_SUCCESS;
 
     // Limpar recursos
+    for (const Material& material : materials)
+        textureManager.release(material.textureId);
+    textureManager.clear();
+    textureLoader.release();
+    frameBuffer.release();
+    lightBuffer.release();
+    materialBuffer.release();
+    profilerOverlay.release();
+    profiler.release();
+    capture.release();
     glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
 
-void setupShader(Shader shader) {
-    shader.setVec3("ka", ka[0], ka[1], ka[2]);
-    shader.setFloat("kd", 0.7f);
-    shader.setVec3("ks", ks[0], ks[1], ks[2]);
-    shader.setFloat("q", ns);
+void setupShader(Shader& shader) {
+    // Liga os blocos do programa aos buffers; outros programas com os mesmos blocos fazem só isto
+    frameBuffer.bindToProgram(shader.ID, "PerFrame");
+    lightBuffer.bindToProgram(shader.ID, "PerLight");
+    materialBuffer.bindToProgram(shader.ID, "PerMaterial");
+
+    // A luz não muda: uma escrita só
+    PerLightBlock light;
+    light.lightPos = glm::vec3(-2.0f, 100.0f, 2.0f);
+    light.lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    light.pad0 = light.pad1 = 0.0f;
+    lightBuffer.update(&light);
+}
 
-    shader.setVec3("lightPos", -2.0f, 100.0f, 2.0f);
-    shader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+void setupMaterials()
+{
+    // Propriedades de todos os materiais gravadas uma vez; o Mesh só escolhe o intervalo a cada troca
+    materialBuffer.initialize(PER_MATERIAL_BINDING, sizeof(PerMaterialBlock), (int)materials.size() + 1);
+    for (size_t i = 0; i <= materials.size(); i++) {
+        Material material = i < materials.size() ? materials[i] : Material();
+        PerMaterialBlock block;
+        block.ka = material.ka;
+        block.kd = material.kd;
+        block.ks = material.ks;
+        block.ke = material.ke;
+        block.q = material.ns;
+        block.d = material.d;
+        block.pad0 = block.pad1 = 0.0f;
+        materialBuffer.update(&block, (int)i);
+    }
 }
 
 void readFromMtl(string path)
 {
-    std::ifstream file(path);
-
-    if (!file.is_open()) {
-        std::cout << "Failed to open the file." << std::endl;
+    // Todos os blocos newmtl do arquivo; cada material segura uma referência à sua textura,
+    // e o TextureManager carrega (em segundo plano) só uma vez cada arquivo
+    if (!loadMtl(path, materials)) {
         return;
     }
 
-    std::string line;
+    for (Material& material : materials) {
+        if (!material.mapKd.empty())
+            material.textureId = textureManager.acquire(basePath + material.mapKd);
+    }
 
-    // Ler cada linha do arquivo .mtl
-    while (std::getline(file, line)) {
-        if (!line.empty()) {
-            std::istringstream iss(line);
-            std::string prefix;
-            iss >> prefix;
+    std::cout << path << ": " << materials.size() << " materiais, " << textureManager.getNbTextures() << " texturas" << std::endl;
+}
 
-            // Verificar prefixos e carregar dados apropriados
-            if (prefix == "map_Kd") {
-                iss >> textureFilePath;
-            }
-            else if (prefix == "Ka") {
-                glm::vec3 tempKa;
-                iss >> tempKa.x >> tempKa.y >> tempKa.z;
-                ka = { tempKa.x, tempKa.y, tempKa.z };
-            }
-            else if (prefix == "Ks") {
-                glm::vec3 tempKs;
-                iss >> tempKs.x >> tempKs.y >> tempKs.z;
-                ks = { tempKs.x, tempKs.y, tempKs.z };
-            }
-            else if (prefix == "Ns") {
-                iss >> ns;
-            }
-        }
-    }
+void updateTextures()
+{
+    textureLoader.update();
+    textureManager.update();
 
-    file.close();
+    // Materiais que apontavam para uma cópia de outra imagem passam a usar a original
+    for (Material& material : materials)
+        material.textureId = textureManager.rebind(material.textureId);
 }
 
-int setupGeometry()
+int setupGeometry(GLuint& VBO, GLuint& EBO)
 {
-    GLuint VBO, VAO;
+    GLuint VAO;
 
-    // Gerar buffer de vértices e array de vértices
+    // Gerar buffer de vértices, de índices e array de vértices
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
     glGenVertexArrays(1, &VAO);
 
     // Bind do VBO e VAO
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, totalVertices.size() * sizeof(GLfloat), totalVertices.data(), GL_STATIC_DRAW);
+    // Os dados vêm direto do arquivo mapeado, sem cópias intermediárias
+    glBufferData(GL_ARRAY_BUFFER, meshCache.getVerticesSize(), meshCache.getVertices(), GL_STATIC_DRAW);
     glBindVertexArray(VAO);
 
-    // Configurar atributos de vértices
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);
-    glEnableVertexAttribArray(0);
+    // Índices ficam associados ao VAO; o cache já os guarda em 16 bits quando há até 65536 vértices
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshCache.getIndicesSize(), meshCache.getIndices(), GL_STATIC_DRAW);
 
-    // Configurar atributos de textura
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+    GLsizei stride = meshCache.getVertexStride();
+    if (meshCache.getVertexFormat() == MESH_VERTEX_QUANTIZED) {
+        // Malha cozida pelo AssetCooker: textura em half float e normal em snorm16 normalizado
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)12);
+        glVertexAttribPointer(2, 3, GL_SHORT, GL_TRUE, stride, (void*)16);
+    }
+    else {
+        // Configurar atributos de vértices, textura e normais
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(GLfloat)));
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(GLfloat)));
+    }
+    glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
-
-    // Configurar atributos de normais
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(5 * sizeof(GLfloat)));
     glEnableVertexAttribArray(2);
 
     // Desvincular VBO e VAO
@@ -239,121 +414,53 @@ int setupGeometry()
     return VAO;
 }
 
-void readFromObj(string path) {
-    std::ifstream file(path);
-
-    if (!file.is_open()) {
-        std::cout << "Failed to open the file." << std::endl;
-        return;
+bool readFromObj(string path) {
+    // Usa o .meshbin ao lado do OBJ; na primeira execução (ou se o OBJ mudou) o OBJ é
+    // lido em paralelo, cada trinca (v, vt, vn) distinta vira um vértice de 8 floats e o cache é gravado
+    double startTime = glfwGetTime();
+    if (!meshCache.load(path, 0)) {
+        std::cout << "Failed to load " << path << std::endl;
+        return false;
     }
+    double elapsedMs = (glfwGetTime() - startTime) * 1000.0;
 
-    std::vector<glm::vec3> tempVertices;
-    std::vector<glm::vec2> tempTextures;
-    std::vector<glm::vec3> tempNormals;
-
-    std::string line;
+    mtlFilePath = meshCache.getMtlFileName();
 
-    // Ler cada linha do arquivo .obj
-    while (std::getline(file, line)) {
-        if (!line.empty()) {
-            std::istringstream iss(line);
-            std::string prefix;
-            iss >> prefix;
-
-            // Verificar prefixos e carregar dados apropriados
-            if (prefix == "v") {
-                glm::vec3 values;
-                iss >> values.x >> values.y >> values.z;
-                tempVertices.push_back(values);
-            }
-            else if (prefix == "vt") {
-                glm::vec2 values;
-                iss >> values.x >> values.y;
-                tempTextures.push_back(values);
-            }
-            else if (prefix == "vn") {
-                glm::vec3 values;
-                iss >> values.x >> values.y >> values.z;
-                tempNormals.push_back(values);
-            }
-            else if (prefix == "f") {
-                unsigned int vertexIndex[3], textIndex[3], normalIndex[3];
-                char slash;
-
-                // Ler índices de vértices, texturas e normais
-                for (int i = 0; i < 3; ++i) {
-                    iss >> vertexIndex[i] >> slash >> textIndex[i] >> slash >> normalIndex[i];
-
-                    // Verificar se os índices estão dentro dos limites
-                    if (vertexIndex[i] > tempVertices.size() || textIndex[i] > tempTextures.size() || normalIndex[i] > tempNormals.size()) {
-                        std::cerr << "Index out of bounds in OBJ file at line: " << line << std::endl;
-                        return;
-                    }
-
-                    // Carregar vértices, texturas e normais nos vetores correspondentes
-                    glm::vec3 vertex = tempVertices[vertexIndex[i] - 1];
-                    glm::vec3 normal = tempNormals[normalIndex[i] - 1];
-                    glm::vec2 texture = tempTextures[textIndex[i] - 1];
-
-                    totalVertices.insert(totalVertices.end(), { vertex.x, vertex.y, vertex.z });
-                    totalVertices.insert(totalVertices.end(), { texture.x, texture.y });
-                    totalVertices.insert(totalVertices.end(), { normal.x, normal.y, normal.z });
-                }
-            }
-            else if (prefix == "mtllib") {
-                iss >> mtlFilePath;
-            }
-        }
-    }
-
-    file.close();
+    int nUniqueVertices = meshCache.getNbVertices();
+    std::cout << path << ": " << meshCache.getNbIndices() << " cantos -> " << nUniqueVertices
+        << " vertices unicos (reuso de " << (nUniqueVertices ? (float)meshCache.getNbIndices() / nUniqueVertices : 0.0f) << "x)" << std::endl;
+    const char* source = !meshCache.wasCacheHit() ? "OBJ lido e cache .meshbin gravado"
+        : meshCache.isCooked() ? "Malha cozida (AssetCooker) carregada" : "Cache .meshbin carregado";
+    std::cout << source << " em " << elapsedMs << " ms" << std::endl;
+    return true;
 }
 
-int loadTexture(string path)
+GLuint createDefaultTexture()
 {
-    std::cout << "Texture path: " << path << std::endl;
-
+    // Textura 1x1 branca: o material fica só com as cores do MTL
     GLuint textureID;
+    const unsigned char white[4] = { 255, 255, 255, 255 };
 
-    // Gerar e bind de textura
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
-
-    // Configurar parâmetros de textura
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    // Carregar imagem da textura
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data) {
-        if (nrChannels == 3) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        }
-        else if (nrChannels == 4) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        }
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-
-    stbi_image_free(data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glBindTexture(GL_TEXTURE_2D, 0);
 
     return textureID;
 }
 
-void setupWindow(GLFWwindow*& window) {
+void setupWindow(GLFWwindow*& window, const HeadlessOptions& headless) {
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         exit(EXIT_FAILURE);
     }
 
+    // Janela invisível, só para ter o contexto
+    if (headless.enabled)
+        setHeadlessWindowHints(headless);
+
     // Criar janela GLFW
     window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Modulo 5 - Melissa Kunst", nullptr, nullptr);
     if (!window) {
@@ -368,7 +475,8 @@ void setupWindow(GLFWwindow*& window) {
     glfwSetCursorPosCallback(window, mouse_callback);
 
     // Desabilita o desenho do cursor
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (!headless.enabled)
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     // Inicializar GLAD
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -383,9 +491,9 @@ void setupWindow(GLFWwindow*& window) {
     std::cout << "OpenGL version supported: " << version << std::endl;
 }
 
-void setupTransformations(glm::mat4& model) {
+void setupTransformations(glm::mat4& model, float time) {
     // Calcular ângulo de rotação baseado no tempo
-    float angle = static_cast<GLfloat>(glfwGetTime());
+    float angle = time;
 
     // Aplicar rotações
     if (rotateX) {
@@ -431,6 +539,12 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         rotateZ = true;
 
     }
+
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+        showProfiler = !showProfiler;
+
+    if (key == GLFW_KEY_T && action == GLFW_PRESS && !profiler.isCapturing())
+        profiler.captureTrace("profile.json");
     camera.setCameraPos(key);
 }
 
@@ -6,18 +6,31 @@ in vec3 scaledNormal;
 in vec3 fragPos;
 in vec2 texCoord;
 
-//Propriedades do material do objeto
-uniform vec3 ka;
-uniform float kd;
-uniform vec3 ks;
-uniform float q;
+//Propriedades do material do objeto (um bloco por material no mesmo buffer)
+layout (std140) uniform PerMaterial
+{
+	vec3 ka;
+	float q;
+	vec3 kd;
+	float d;
+	vec3 ks;
+	vec3 ke;
+};
 
 //Propriedades da fonte de luz
-uniform vec3 lightPos;
-uniform vec3 lightColor;
+layout (std140) uniform PerLight
+{
+	vec3 lightPos;
+	vec3 lightColor;
+};
 
 //Posi??o da c?mera 
-uniform vec3 cameraPos;
+layout (std140) uniform PerFrame
+{
+	mat4 view;
+	mat4 projection;
+	vec3 cameraPos;
+};
 
 //Buffer de sa?da (color buffer)
 out vec4 color;
@@ -42,7 +55,8 @@ void main()
     vec3 specular = spec * ks * lightColor;
     
     vec4 texColor = texture(colorBuffer,texCoord);
-    vec3 result = (ambient + diffuse) * vec3(texColor) + specular;
+    vec3 result = (ambient + diffuse) * vec3(texColor) + specular + ke;
 
+    //Sem GL_BLEND neste caminho o d nao teria efeito: a saida e sempre opaca
     color = vec4(result, 1.0f);
 }
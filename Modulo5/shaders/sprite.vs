@@ -8,9 +8,15 @@ out vec3 fragPos;
 out vec2 texCoord;
 out vec3 scaledNormal;
 
-uniform mat4 projection;
+// Camera, gravada uma vez por quadro e compartilhada entre os programas
+layout (std140) uniform PerFrame
+{
+	mat4 view;
+	mat4 projection;
+	vec3 cameraPos;
+};
+
 uniform mat4 model;
-uniform mat4 view;
 
 void main()
 {
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "InstanceBVH.h"
+#include "MtlLoader.h"
+
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+};
+
+// Interseção mais próxima: triângulo original e coordenadas baricêntricas (u, v)
+struct Hit
+{
+    float t;
+    int triangle;
+    float u;
+    float v;
+};
+
+// Imagem de map_Kd em RGBA8, amostrada como a textura dos módulos (repetição, bilinear)
+struct RtTexture
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+
+    glm::vec4 sample(const glm::vec2& uv) const;
+};
+
+// Cena pronta para o traçado: vértices já em espaço de mundo, materiais do MTL e a BVH dos triângulos
+class Scene
+{
+public:
+    // Lê o OBJ e o seu MTL (com as texturas) e aplica a mesma transformação de modelo do módulo
+    bool load(const std::string& objPath, const glm::mat4& model, int nThreads = 0);
+
+    bool intersect(const Ray& ray, Hit& hit) const;
+    // Qualquer interseção antes de maxT (raios de sombra)
+    bool isOccluded(const Ray& ray, float maxT) const;
+
+    // Atributos interpolados do ponto atingido
+    glm::vec3 getNormal(const Hit& hit) const;
+    glm::vec2 getTexCoord(const Hit& hit) const;
+    const Material& getMaterial(const Hit& hit) const;
+    const RtTexture* getTexture(const Hit& hit) const;
+
+    int getNbTriangles() const { return (int)triangleMaterial.size(); }
+    int getNbNodes() const { return bvh.getNbNodes(); }
+    double getBuildMs() const { return buildMs; }
+
+private:
+    // Triângulo na ordem das folhas: v0 e as arestas para o teste de Möller-Trumbore
+    struct Triangle
+    {
+        glm::vec3 v0;
+        glm::vec3 e1;
+        glm::vec3 e2;
+        int index; // triângulo original
+    };
+
+    template <bool anyHit>
+    bool traverse(const Ray& ray, float maxT, Hit& hit) const;
+
+    std::vector<float> vertices;        // 8 floats por vértice (posição, textura, normal), já transformados
+    std::vector<unsigned int> indices;
+    std::vector<int> triangleMaterial;  // posição em materials
+    std::vector<Material> materials;    // faces sem material usam o último, como no Módulo 5
+    std::vector<RtTexture> textures;    // uma por material (vazia se não houver map_Kd)
+
+    InstanceBVH bvh;
+    std::vector<Triangle> triangles;
+    double buildMs = 0.0;
+};
+
+// Parâmetros do render; câmera, luz e modelo iguais aos do Módulo 5
+struct RenderSettings
+{
+    int width = 800;
+    int height = 600;
+    int samplesPerPixel = 1;  // amostras por pixel, com deslocamento aleatório dentro do pixel
+    int maxDepth = 3;         // reflexões de materiais com illum 3
+    bool shadows = true;
+    int tileSize = 32;
+    float fov = 45.0f;
+    glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
+    glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 lightPos = glm::vec3(-2.0f, 100.0f, 2.0f);
+    glm::vec3 lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    glm::vec3 background = glm::vec3(1.0f, 1.0f, 1.0f);
+};
+
+struct RenderStats
+{
+    uint64_t primaryRays = 0;
+    uint64_t shadowRays = 0;
+    uint64_t secondaryRays = 0;
+    int nTiles = 0;
+    double ms = 0.0;
+
+    uint64_t getTotalRays() const { return primaryRays + shadowRays + secondaryRays; }
+};
+
+// Traça a imagem em blocos distribuídos entre as threads; rgba recebe width x height pixels
+void renderScene(const Scene& scene, const RenderSettings& settings, int nThreads, std::vector<unsigned char>& rgba, RenderStats& stats);
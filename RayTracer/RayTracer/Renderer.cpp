@@ -0,0 +1,146 @@
+#include "RayTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+// Deslocamento dos raios secundários ao longo da normal, para não atingirem a própria superfície
+static const float surfaceOffset = 1e-4f;
+
+// Estado de um bloco: contadores próprios, somados no fim sem disputa entre threads
+struct TileStats
+{
+    uint64_t primaryRays = 0;
+    uint64_t shadowRays = 0;
+    uint64_t secondaryRays = 0;
+};
+
+// Número pseudoaleatório em [0, 1) a partir do pixel e da amostra; o mesmo render sai sempre igual
+static float hashToFloat(uint32_t x, uint32_t y, uint32_t sample)
+{
+    uint32_t h = x * 0x8DA6B343u ^ y * 0xD8163841u ^ sample * 0xCB1AB31Fu;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+// Modelo de Phong do sprite.fs do Módulo 5, com a luz testada por um raio de sombra
+static glm::vec3 shade(const Scene& scene, const RenderSettings& settings, const Ray& ray, int depth, TileStats& stats)
+{
+    Hit hit;
+    if (!scene.intersect(ray, hit))
+        return settings.background;
+
+    const Material& material = scene.getMaterial(hit);
+    glm::vec3 fragPos = ray.origin + ray.direction * hit.t;
+    glm::vec3 N = scene.getNormal(hit);
+    glm::vec3 V = -ray.direction;
+    // Faces vistas por trás (malhas abertas) usam a normal virada para a câmera
+    if (glm::dot(N, V) < 0.0f)
+        N = -N;
+
+    glm::vec4 texColor = glm::vec4(1.0f);
+    const RtTexture* texture = scene.getTexture(hit);
+    if (texture)
+        texColor = texture->sample(scene.getTexCoord(hit));
+
+    glm::vec3 ambient = settings.lightColor * material.ka;
+    glm::vec3 L = glm::normalize(settings.lightPos - fragPos);
+    float diff = max(glm::dot(N, L), 0.0f);
+    glm::vec3 R = glm::reflect(-L, N);
+    float spec = pow(max(glm::dot(R, V), 0.0f), material.ns);
+
+    // Na sombra só fica a parcela ambiente
+    if (settings.shadows && (diff > 0.0f || spec > 0.0f)) {
+        Ray shadowRay = { fragPos + N * surfaceOffset, L };
+        stats.shadowRays++;
+        if (scene.isOccluded(shadowRay, glm::length(settings.lightPos - shadowRay.origin))) {
+            diff = 0.0f;
+            spec = 0.0f;
+        }
+    }
+
+    glm::vec3 diffuse = diff * settings.lightColor * material.kd;
+    glm::vec3 specular = spec * material.ks * settings.lightColor;
+    glm::vec3 color = (ambient + diffuse) * glm::vec3(texColor) + specular + material.ke;
+
+    // illum 3: reflexão especular ideal, ponderada por Ks
+    if (material.illum == 3 && depth < settings.maxDepth && glm::dot(material.ks, material.ks) > 0.0f) {
+        Ray reflected = { fragPos + N * surfaceOffset, glm::normalize(glm::reflect(ray.direction, N)) };
+        stats.secondaryRays++;
+        color += material.ks * shade(scene, settings, reflected, depth + 1, stats);
+    }
+    return color;
+}
+
+void renderScene(const Scene& scene, const RenderSettings& settings, int nThreads, vector<unsigned char>& rgba, RenderStats& stats)
+{
+    int width = settings.width;
+    int height = settings.height;
+    int tileSize = max(settings.tileSize, 1);
+    int samples = max(settings.samplesPerPixel, 1);
+    rgba.assign((size_t)width * height * 4, 255);
+
+    // Mesma câmera de glm::perspective + glm::lookAt: semiplano da imagem a uma unidade do olho
+    glm::vec3 forward = glm::normalize(settings.cameraFront);
+    glm::vec3 right = glm::normalize(glm::cross(forward, settings.cameraUp));
+    glm::vec3 up = glm::cross(right, forward);
+    float halfHeight = tan(glm::radians(settings.fov) * 0.5f);
+    float halfWidth = halfHeight * width / height;
+
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+    int nTiles = tilesX * tilesY;
+    vector<TileStats> tileStats(nTiles);
+
+    auto start = chrono::high_resolution_clock::now();
+    ThreadPool pool(nThreads);
+    pool.parallelFor(nTiles, [&](int tile) {
+        int x0 = (tile % tilesX) * tileSize;
+        int y0 = (tile / tilesX) * tileSize;
+        int x1 = min(x0 + tileSize, width);
+        int y1 = min(y0 + tileSize, height);
+        TileStats& local = tileStats[tile];
+
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                glm::vec3 color = glm::vec3(0.0f);
+                for (int s = 0; s < samples; s++) {
+                    // Uma amostra fica no centro do pixel; as demais são espalhadas dentro dele
+                    float jx = samples > 1 ? hashToFloat(x, y, s * 2) : 0.5f;
+                    float jy = samples > 1 ? hashToFloat(x, y, s * 2 + 1) : 0.5f;
+                    float px = ((x + jx) / width * 2.0f - 1.0f) * halfWidth;
+                    float py = (1.0f - (y + jy) / height * 2.0f) * halfHeight;
+
+                    Ray ray = { settings.cameraPos, glm::normalize(forward + right * px + up * py) };
+                    local.primaryRays++;
+                    color += shade(scene, settings, ray, 0, local);
+                }
+                color = glm::clamp(color / (float)samples, 0.0f, 1.0f);
+
+                // Linha 0 no topo, como o PNG espera
+                unsigned char* pixel = &rgba[((size_t)y * width + x) * 4];
+                pixel[0] = (unsigned char)(color.r * 255.0f + 0.5f);
+                pixel[1] = (unsigned char)(color.g * 255.0f + 0.5f);
+                pixel[2] = (unsigned char)(color.b * 255.0f + 0.5f);
+                pixel[3] = 255;
+            }
+        }
+    });
+    stats.ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+    stats.primaryRays = stats.shadowRays = stats.secondaryRays = 0;
+    for (const TileStats& local : tileStats) {
+        stats.primaryRays += local.primaryRays;
+        stats.shadowRays += local.shadowRays;
+        stats.secondaryRays += local.secondaryRays;
+    }
+    stats.nTiles = nTiles;
+}
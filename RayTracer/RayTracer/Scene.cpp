@@ -0,0 +1,337 @@
+#include "RayTracer.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+
+//GLM
+#include <glm/gtc/type_ptr.hpp>
+
+#include "ObjLoader.h"
+#include "stb_image.h"
+
+// SSE faz parte de todo alvo x64 (e do x86 com /arch:SSE ou mais); nos demais fica o teste escalar
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define RAYTRACER_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+using namespace std;
+
+// Profundidade máxima da BVH; a pilha da travessia fica na pilha da thread
+static const int maxTraversalDepth = 128;
+
+// ---------------------------------------------------------------------------
+// Texturas
+
+static glm::vec4 fetchTexel(const RtTexture& texture, int x, int y)
+{
+    x = ((x % texture.width) + texture.width) % texture.width;
+    y = ((y % texture.height) + texture.height) % texture.height;
+    const unsigned char* p = &texture.pixels[((size_t)y * texture.width + x) * 4];
+    return glm::vec4(p[0], p[1], p[2], p[3]) / 255.0f;
+}
+
+glm::vec4 RtTexture::sample(const glm::vec2& uv) const
+{
+    if (pixels.empty())
+        return glm::vec4(1.0f);
+
+    // O vertex shader usa (s, 1 - t) e a imagem é enviada sem inverter as linhas
+    float x = uv.x * width - 0.5f;
+    float y = (1.0f - uv.y) * height - 0.5f;
+    int x0 = (int)floor(x);
+    int y0 = (int)floor(y);
+    float fx = x - x0;
+    float fy = y - y0;
+    glm::vec4 top = glm::mix(fetchTexel(*this, x0, y0), fetchTexel(*this, x0 + 1, y0), fx);
+    glm::vec4 bottom = glm::mix(fetchTexel(*this, x0, y0 + 1), fetchTexel(*this, x0 + 1, y0 + 1), fx);
+    return glm::mix(top, bottom, fy);
+}
+
+// ---------------------------------------------------------------------------
+// Carga
+
+bool Scene::load(const string& objPath, const glm::mat4& model, int nThreads)
+{
+    ObjData obj;
+    if (!loadObj(objPath, obj, nThreads)) {
+        cout << "Nao foi possivel ler " << objPath << endl;
+        return false;
+    }
+
+    MeshData mesh;
+    buildMeshData(obj, mesh);
+    vertices = std::move(mesh.vertices);
+    indices = std::move(mesh.indices);
+
+    // Posições e normais em espaço de mundo, como fragPos e scaledNormal no vertex shader
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    for (size_t i = 0; i < vertices.size(); i += 8) {
+        glm::vec3 position = glm::vec3(model * glm::vec4(vertices[i], vertices[i + 1], vertices[i + 2], 1.0f));
+        glm::vec3 normal = normalMatrix * glm::vec3(vertices[i + 5], vertices[i + 6], vertices[i + 7]);
+        for (int k = 0; k < 3; k++) {
+            vertices[i + k] = position[k];
+            vertices[i + 5 + k] = normal[k];
+        }
+    }
+
+    // Materiais do MTL e a imagem de map_Kd de cada um
+    size_t slash = objPath.find_last_of("/\\");
+    string folder = slash == string::npos ? "" : objPath.substr(0, slash + 1);
+    materials.clear();
+    if (!mesh.mtlFileName.empty() && !loadMtl(folder + mesh.mtlFileName, materials))
+        cout << "Nao foi possivel ler " << folder + mesh.mtlFileName << endl;
+    if (materials.empty())
+        materials.push_back(Material());
+
+    textures.assign(materials.size(), RtTexture());
+    for (size_t i = 0; i < materials.size(); i++) {
+        if (materials[i].mapKd.empty())
+            continue;
+        int width, height, nChannels;
+        unsigned char* data = stbi_load((folder + materials[i].mapKd).c_str(), &width, &height, &nChannels, 4);
+        if (!data) {
+            cout << "Failed to load texture " << folder + materials[i].mapKd << endl;
+            continue;
+        }
+        textures[i].width = width;
+        textures[i].height = height;
+        textures[i].pixels.assign(data, data + (size_t)width * height * 4);
+        stbi_image_free(data);
+    }
+
+    int nTriangles = (int)(indices.size() / 3);
+    int defaultMaterial = (int)materials.size() - 1;
+    triangleMaterial.assign(nTriangles, defaultMaterial);
+    for (const SubMesh& subMesh : mesh.subMeshes) {
+        int material = subMesh.materialIndex >= 0 ? findMaterial(materials, mesh.materialNames[subMesh.materialIndex]) : -1;
+        if (material < 0)
+            material = defaultMaterial;
+        for (unsigned int t = subMesh.firstIndex / 3; t < (subMesh.firstIndex + subMesh.indexCount) / 3; t++)
+            triangleMaterial[t] = material;
+    }
+
+    // BVH sobre as caixas dos triângulos; os triângulos são copiados na ordem das folhas
+    auto start = chrono::high_resolution_clock::now();
+    vector<glm::vec3> boundsMin(nTriangles), boundsMax(nTriangles);
+    for (int t = 0; t < nTriangles; t++) {
+        glm::vec3 v0 = glm::make_vec3(&vertices[indices[t * 3] * 8]);
+        glm::vec3 v1 = glm::make_vec3(&vertices[indices[t * 3 + 1] * 8]);
+        glm::vec3 v2 = glm::make_vec3(&vertices[indices[t * 3 + 2] * 8]);
+        boundsMin[t] = glm::min(v0, glm::min(v1, v2));
+        boundsMax[t] = glm::max(v0, glm::max(v1, v2));
+    }
+    bvh.build(boundsMin.data(), boundsMax.data(), nTriangles);
+
+    const vector<int>& order = bvh.getItemOrder();
+    triangles.resize(nTriangles);
+    for (int i = 0; i < nTriangles; i++) {
+        int t = order[i];
+        glm::vec3 v0 = glm::make_vec3(&vertices[indices[t * 3] * 8]);
+        triangles[i].v0 = v0;
+        triangles[i].e1 = glm::make_vec3(&vertices[indices[t * 3 + 1] * 8]) - v0;
+        triangles[i].e2 = glm::make_vec3(&vertices[indices[t * 3 + 2] * 8]) - v0;
+        triangles[i].index = t;
+    }
+    buildMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+    // Os filhos vêm depois do pai no array: a profundidade sai numa passada
+    const vector<BVHNode>& nodes = bvh.getNodes();
+    vector<int> depth(nodes.size(), 1);
+    int maxDepth = nodes.empty() ? 0 : 1;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].count > 0)
+            continue;
+        depth[nodes[i].leftFirst] = depth[nodes[i].leftFirst + 1] = depth[i] + 1;
+        maxDepth = max(maxDepth, depth[i] + 1);
+    }
+    if (maxDepth > maxTraversalDepth) {
+        cout << "BVH com profundidade " << maxDepth << " (maximo " << maxTraversalDepth << ")" << endl;
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Travessia
+
+#ifdef RAYTRACER_USE_SSE
+struct RayData
+{
+    __m128 origin;
+    __m128 inverseDirection;
+};
+
+// Entrada na caixa do nó pelo método das placas, com os três eixos numa instrução (FLT_MAX se não atinge antes de maxT)
+static inline float intersectNode(const BVHNode& node, const RayData& ray, float maxT)
+{
+    // Os cantos são lidos com o inteiro seguinte na 4ª posição, que é trocada por uma cópia da 3ª
+    __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.boundsMin.x), ray.origin), ray.inverseDirection);
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.boundsMax.x), ray.origin), ray.inverseDirection);
+    __m128 tNear = _mm_min_ps(t0, t1);
+    __m128 tFar = _mm_max_ps(t0, t1);
+    tNear = _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2, 2, 1, 0));
+    tFar = _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2, 2, 1, 0));
+
+    // Máximo das entradas e mínimo das saídas entre as posições
+    tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(1, 0, 3, 2)));
+    tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2, 3, 0, 1)));
+    tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(1, 0, 3, 2)));
+    tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    float tEnter = max(_mm_cvtss_f32(tNear), 0.0f);
+    float tExit = min(_mm_cvtss_f32(tFar), maxT);
+    return tEnter <= tExit ? tEnter : FLT_MAX;
+}
+#else
+struct RayData
+{
+    glm::vec3 origin;
+    glm::vec3 inverseDirection;
+};
+
+static inline float intersectNode(const BVHNode& node, const RayData& ray, float maxT)
+{
+    glm::vec3 t0 = (node.boundsMin - ray.origin) * ray.inverseDirection;
+    glm::vec3 t1 = (node.boundsMax - ray.origin) * ray.inverseDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float tEnter = max(max(tNear.x, tNear.y), max(tNear.z, 0.0f));
+    float tExit = min(min(tFar.x, tFar.y), min(tFar.z, maxT));
+    return tEnter <= tExit ? tEnter : FLT_MAX;
+}
+#endif
+
+template <bool anyHit>
+bool Scene::traverse(const Ray& ray, float maxT, Hit& hit) const
+{
+    const vector<BVHNode>& nodes = bvh.getNodes();
+    if (nodes.empty())
+        return false;
+
+    // Componentes nulas viram um valor enorme: as placas paralelas ao raio ficam sem limite
+    glm::vec3 inverseDirection;
+    for (int i = 0; i < 3; i++)
+        inverseDirection[i] = ray.direction[i] != 0.0f ? 1.0f / ray.direction[i] : FLT_MAX;
+    RayData data;
+#ifdef RAYTRACER_USE_SSE
+    data.origin = _mm_set_ps(0.0f, ray.origin.z, ray.origin.y, ray.origin.x);
+    data.inverseDirection = _mm_set_ps(0.0f, inverseDirection.z, inverseDirection.y, inverseDirection.x);
+#else
+    data.origin = ray.origin;
+    data.inverseDirection = inverseDirection;
+#endif
+
+    float best = maxT;
+    bool found = false;
+    int stack[maxTraversalDepth + 1];
+    int top = 0;
+    if (intersectNode(nodes[0], data, best) != FLT_MAX)
+        stack[top++] = 0;
+
+    while (top > 0) {
+        const BVHNode& node = nodes[stack[--top]];
+
+        if (node.count > 0) {
+            // Möller-Trumbore
+            for (int i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+                const Triangle& triangle = triangles[i];
+                glm::vec3 p = glm::cross(ray.direction, triangle.e2);
+                float det = glm::dot(triangle.e1, p);
+                if (fabs(det) < 1e-12f)
+                    continue;
+                float inverseDet = 1.0f / det;
+                glm::vec3 s = ray.origin - triangle.v0;
+                float u = glm::dot(s, p) * inverseDet;
+                if (u < 0.0f || u > 1.0f)
+                    continue;
+                glm::vec3 q = glm::cross(s, triangle.e1);
+                float v = glm::dot(ray.direction, q) * inverseDet;
+                if (v < 0.0f || u + v > 1.0f)
+                    continue;
+                float t = glm::dot(triangle.e2, q) * inverseDet;
+                if (t <= 0.0f || t >= best)
+                    continue;
+
+                if (anyHit)
+                    return true;
+                best = t;
+                hit.triangle = triangle.index;
+                hit.u = u;
+                hit.v = v;
+                found = true;
+            }
+            continue;
+        }
+
+        // O filho mais próximo sai primeiro da pilha; os que começam depois do melhor acerto nem entram
+        int nearChild = node.leftFirst;
+        int farChild = node.leftFirst + 1;
+        float tNear = intersectNode(nodes[nearChild], data, best);
+        float tFar = intersectNode(nodes[farChild], data, best);
+        if (tFar < tNear) {
+            swap(nearChild, farChild);
+            swap(tNear, tFar);
+        }
+        if (tFar != FLT_MAX)
+            stack[top++] = farChild;
+        if (tNear != FLT_MAX)
+            stack[top++] = nearChild;
+    }
+
+    hit.t = best;
+    return found;
+}
+
+bool Scene::intersect(const Ray& ray, Hit& hit) const
+{
+    return traverse<false>(ray, FLT_MAX, hit);
+}
+
+bool Scene::isOccluded(const Ray& ray, float maxT) const
+{
+    Hit hit;
+    return traverse<true>(ray, maxT, hit);
+}
+
+// ---------------------------------------------------------------------------
+// Atributos
+
+glm::vec3 Scene::getNormal(const Hit& hit) const
+{
+    const unsigned int* triangle = &indices[hit.triangle * 3];
+    float w = 1.0f - hit.u - hit.v;
+    glm::vec3 normal = glm::make_vec3(&vertices[triangle[0] * 8 + 5]) * w
+        + glm::make_vec3(&vertices[triangle[1] * 8 + 5]) * hit.u
+        + glm::make_vec3(&vertices[triangle[2] * 8 + 5]) * hit.v;
+
+    // OBJ sem normais: normal da face
+    if (glm::dot(normal, normal) < 1e-12f) {
+        glm::vec3 v0 = glm::make_vec3(&vertices[triangle[0] * 8]);
+        normal = glm::cross(glm::make_vec3(&vertices[triangle[1] * 8]) - v0, glm::make_vec3(&vertices[triangle[2] * 8]) - v0);
+    }
+    return glm::normalize(normal);
+}
+
+glm::vec2 Scene::getTexCoord(const Hit& hit) const
+{
+    const unsigned int* triangle = &indices[hit.triangle * 3];
+    float w = 1.0f - hit.u - hit.v;
+    return glm::make_vec2(&vertices[triangle[0] * 8 + 3]) * w
+        + glm::make_vec2(&vertices[triangle[1] * 8 + 3]) * hit.u
+        + glm::make_vec2(&vertices[triangle[2] * 8 + 3]) * hit.v;
+}
+
+const Material& Scene::getMaterial(const Hit& hit) const
+{
+    return materials[triangleMaterial[hit.triangle]];
+}
+
+const RtTexture* Scene::getTexture(const Hit& hit) const
+{
+    const RtTexture& texture = textures[triangleMaterial[hit.triangle]];
+    return texture.pixels.empty() ? nullptr : &texture;
+}
@@ -0,0 +1,144 @@
+﻿/*
+*   SoftRasterizer
+*
+*   Rasterização na CPU da cena do Módulo 5, para máquinas sem GPU (integração contínua,
+*   fazenda de render): mesma transformação projection * view * model, mesmo Phong do
+*   sprite.fs, buffer de profundidade e texturas com filtro bilinear. A tela é dividida em
+*   blocos de 64x64 rasterizados em paralelo, com as funções de aresta em SSE.
+*   Renderiza a cena em várias resoluções, informa ms por quadro e grava um PNG de cada.
+*
+*   Uso: SoftRasterizer [modelo.obj] [--out prefixo] [--sizes LxA,LxA,...] [--frames N]
+*                       [--threads N] [--scale S]
+*     modelo padrão: ../../3D_Models/Suzanne/CuboTextured.obj (escala 0.5, como no módulo)
+*     imagens: prefixo_LxA.png (padrão: render_800x600.png, ...)
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Rasterizer.h"
+#include "PngWriter.h"
+
+using namespace std;
+
+struct Resolution
+{
+    int width;
+    int height;
+};
+
+static void printUsage()
+{
+    cout << "Uso: SoftRasterizer [modelo.obj] [--out prefixo] [--sizes LxA,LxA,...] [--frames N] [--threads N] [--scale S]" << endl;
+}
+
+// Lista "800x600,1920x1080"
+static bool parseSizes(const string& text, vector<Resolution>& sizes)
+{
+    sizes.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == string::npos)
+            end = text.size();
+        Resolution size;
+        if (sscanf(text.substr(start, end - start).c_str(), "%dx%d", &size.width, &size.height) != 2 || size.width <= 0 || size.height <= 0)
+            return false;
+        sizes.push_back(size);
+        start = end + 1;
+    }
+    return !sizes.empty();
+}
+
+int main(int argc, char** argv)
+{
+    string objPath = "../../3D_Models/Suzanne/CuboTextured.obj";
+    string outPrefix = "render";
+    vector<Resolution> sizes = { { 800, 600 }, { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 } };
+    int nFrames = 20;
+    int nThreads = 0;
+    float scale = 0.5f;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc)
+            outPrefix = argv[++i];
+        else if (arg == "--sizes" && i + 1 < argc) {
+            if (!parseSizes(argv[++i], sizes)) {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+            nFrames = max(atoi(argv[++i]), 1);
+        else if (arg == "--threads" && i + 1 < argc)
+            nThreads = atoi(argv[++i]);
+        else if (arg == "--scale" && i + 1 < argc)
+            scale = (float)atof(argv[++i]);
+        else if (arg[0] == '-') {
+            printUsage();
+            return 1;
+        }
+        else
+            objPath = arg;
+    }
+
+    RasterMesh mesh;
+    if (!mesh.load(objPath, nThreads))
+        return 1;
+
+    Rasterizer rasterizer(nThreads);
+    printf("%s: %d triangulos, %d threads\n", objPath.c_str(), mesh.getNbTriangles(), rasterizer.getNbThreads());
+
+    // Câmera, luz e modelo do Módulo 5 (Camera::update e a função main)
+    glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
+    glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+    RasterFrame frame;
+    frame.view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+    frame.cameraPos = cameraPos;
+    frame.lightPos = glm::vec3(-2.0f, 100.0f, 2.0f);
+    frame.lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(scale));
+
+    bool ok = true;
+    for (const Resolution& size : sizes) {
+        rasterizer.resize(size.width, size.height);
+        frame.projection = glm::perspective(glm::radians(45.0f), (float)size.width / (float)size.height, 0.1f, 100.0f);
+
+        // Um quadro de aquecimento (alocação dos blocos) fora da medição
+        rasterizer.clear(glm::vec3(1.0f, 1.0f, 1.0f));
+        rasterizer.draw(mesh, model, frame);
+
+        double minMs = 1e30, totalMs = 0.0;
+        for (int f = 0; f < nFrames; f++) {
+            auto start = chrono::high_resolution_clock::now();
+            rasterizer.clear(glm::vec3(1.0f, 1.0f, 1.0f));
+            rasterizer.draw(mesh, model, frame);
+            double ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+            minMs = min(minMs, ms);
+            totalMs += ms;
+        }
+        printf("%5dx%-5d %4d quadros: %8.2f ms/quadro (minimo %.2f ms), %d triangulos nos blocos\n", size.width, size.height,
+            nFrames, totalMs / nFrames, minMs, rasterizer.getNbTrianglesBinned());
+
+        vector<unsigned char> rgba;
+        rasterizer.readPixels(rgba);
+        string path = outPrefix + "_" + to_string(size.width) + "x" + to_string(size.height) + ".png";
+        if (!writePng(path, size.width, size.height, 4, rgba.data())) {
+            cout << "Nao foi possivel gravar " << path << endl;
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,463 @@
+#include "Rasterizer.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//GLM
+#include <glm/gtc/type_ptr.hpp>
+
+#include "ObjLoader.h"
+#include "stb_image.h"
+
+// SSE faz parte de todo alvo x64 (e do x86 com /arch:SSE ou mais); nos demais fica o laço escalar
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define RASTERIZER_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+using namespace std;
+
+static const int tileSize = 64;            // múltiplo de 4: os grupos SSE nunca cruzam blocos
+static const int trianglesPerChunk = 1024;
+static const int verticesPerTask = 4096;
+
+// ---------------------------------------------------------------------------
+// Malha e texturas
+
+static glm::vec4 fetchTexel(const RasterTexture& texture, int x, int y)
+{
+    x = ((x % texture.width) + texture.width) % texture.width;
+    y = ((y % texture.height) + texture.height) % texture.height;
+    const unsigned char* p = &texture.pixels[((size_t)y * texture.width + x) * 4];
+    return glm::vec4(p[0], p[1], p[2], p[3]) / 255.0f;
+}
+
+glm::vec4 RasterTexture::sample(const glm::vec2& uv) const
+{
+    float x = uv.x * width - 0.5f;
+    float y = uv.y * height - 0.5f;
+    int x0 = (int)floor(x);
+    int y0 = (int)floor(y);
+    float fx = x - x0;
+    float fy = y - y0;
+    glm::vec4 top = glm::mix(fetchTexel(*this, x0, y0), fetchTexel(*this, x0 + 1, y0), fx);
+    glm::vec4 bottom = glm::mix(fetchTexel(*this, x0, y0 + 1), fetchTexel(*this, x0 + 1, y0 + 1), fx);
+    return glm::mix(top, bottom, fy);
+}
+
+bool RasterMesh::load(const string& objPath, int nThreads)
+{
+    ObjData obj;
+    if (!loadObj(objPath, obj, nThreads)) {
+        cout << "Nao foi possivel ler " << objPath << endl;
+        return false;
+    }
+
+    MeshData mesh;
+    buildMeshData(obj, mesh);
+    vertices = std::move(mesh.vertices);
+    indices = std::move(mesh.indices);
+
+    size_t slash = objPath.find_last_of("/\\");
+    string folder = slash == string::npos ? "" : objPath.substr(0, slash + 1);
+    materials.clear();
+    if (!mesh.mtlFileName.empty() && !loadMtl(folder + mesh.mtlFileName, materials))
+        cout << "Nao foi possivel ler " << folder + mesh.mtlFileName << endl;
+    if (materials.empty())
+        materials.push_back(Material());
+
+    textures.assign(materials.size(), RasterTexture());
+    for (size_t i = 0; i < materials.size(); i++) {
+        if (materials[i].mapKd.empty())
+            continue;
+        int width, height, nChannels;
+        unsigned char* data = stbi_load((folder + materials[i].mapKd).c_str(), &width, &height, &nChannels, 4);
+        if (!data) {
+            cout << "Failed to load texture " << folder + materials[i].mapKd << endl;
+            continue;
+        }
+        textures[i].width = width;
+        textures[i].height = height;
+        textures[i].pixels.assign(data, data + (size_t)width * height * 4);
+        stbi_image_free(data);
+    }
+
+    int defaultMaterial = (int)materials.size() - 1;
+    triangleMaterial.assign(getNbTriangles(), defaultMaterial);
+    for (const SubMesh& subMesh : mesh.subMeshes) {
+        int material = subMesh.materialIndex >= 0 ? findMaterial(materials, mesh.materialNames[subMesh.materialIndex]) : -1;
+        if (material < 0)
+            material = defaultMaterial;
+        for (unsigned int t = subMesh.firstIndex / 3; t < (subMesh.firstIndex + subMesh.indexCount) / 3; t++)
+            triangleMaterial[t] = material;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Rasterizador
+
+Rasterizer::Rasterizer(int nThreads)
+    : pool(nThreads), width(0), height(0), stride(0), tilesX(0), tilesY(0), nChunks(0), nTrianglesBinned(0)
+{
+}
+
+void Rasterizer::resize(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    stride = (width + 3) & ~3;
+    tilesX = (width + tileSize - 1) / tileSize;
+    tilesY = (height + tileSize - 1) / tileSize;
+    color.assign((size_t)stride * height, 0);
+    depth.assign((size_t)stride * height, 1.0f);
+}
+
+static uint32_t packColor(const glm::vec3& c)
+{
+    glm::vec3 v = glm::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f;
+    return (uint32_t)v.r | ((uint32_t)v.g << 8) | ((uint32_t)v.b << 16) | 0xFF000000u;
+}
+
+void Rasterizer::clear(const glm::vec3& clearColor)
+{
+    fill(color.begin(), color.end(), packColor(clearColor));
+    fill(depth.begin(), depth.end(), 1.0f);
+}
+
+void Rasterizer::readPixels(vector<unsigned char>& rgba) const
+{
+    rgba.resize((size_t)width * height * 4);
+    for (int y = 0; y < height; y++)
+        memcpy(&rgba[(size_t)y * width * 4], &color[(size_t)y * stride], (size_t)width * 4);
+}
+
+// Vértice durante o recorte pelo plano próximo
+struct ClipVertex
+{
+    glm::vec4 position;
+    float attributes[8];
+};
+
+static ClipVertex lerpVertex(const ClipVertex& a, const ClipVertex& b, float t)
+{
+    ClipVertex v;
+    v.position = glm::mix(a.position, b.position, t);
+    for (int k = 0; k < 8; k++)
+        v.attributes[k] = a.attributes[k] + (b.attributes[k] - a.attributes[k]) * t;
+    return v;
+}
+
+void Rasterizer::draw(const RasterMesh& mesh, const glm::mat4& model, const RasterFrame& frame)
+{
+    // Vertex shader: posição de recorte, fragPos, texCoord (com t invertido) e scaledNormal
+    int nVertices = (int)(mesh.vertices.size() / 8);
+    clipPositions.resize(nVertices);
+    worldAttributes.resize((size_t)nVertices * 8);
+    glm::mat4 mvp = frame.projection * frame.view * model;
+    glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+
+    int nVertexTasks = (nVertices + verticesPerTask - 1) / verticesPerTask;
+    pool.parallelFor(nVertexTasks, [&](int task) {
+        int last = min((task + 1) * verticesPerTask, nVertices);
+        for (int i = task * verticesPerTask; i < last; i++) {
+            const float* v = &mesh.vertices[(size_t)i * 8];
+            glm::vec4 position = glm::vec4(v[0], v[1], v[2], 1.0f);
+            clipPositions[i] = mvp * position;
+
+            glm::vec3 fragPos = glm::vec3(model * position);
+            glm::vec3 normal = normalMatrix * glm::vec3(v[5], v[6], v[7]);
+            float* out = &worldAttributes[(size_t)i * 8];
+            out[0] = fragPos.x;
+            out[1] = fragPos.y;
+            out[2] = fragPos.z;
+            out[3] = v[3];
+            out[4] = 1.0f - v[4];
+            out[5] = normal.x;
+            out[6] = normal.y;
+            out[7] = normal.z;
+        }
+    });
+
+    // Montagem e distribuição nos blocos, uma faixa de triângulos por tarefa
+    int nTiles = tilesX * tilesY;
+    nChunks = max((mesh.getNbTriangles() + trianglesPerChunk - 1) / trianglesPerChunk, 1);
+    if ((int)chunkSetups.size() < nChunks)
+        chunkSetups.resize(nChunks);
+    if (bins.size() < (size_t)nChunks * nTiles)
+        bins.resize((size_t)nChunks * nTiles);
+    chunkBinned.assign(nChunks, 0);
+    pool.parallelFor(nChunks, [&](int chunk) { setupTriangles(mesh, chunk); });
+
+    nTrianglesBinned = 0;
+    for (int binned : chunkBinned)
+        nTrianglesBinned += binned;
+
+    pool.parallelFor(nTiles, [&](int tile) { rasterizeTile(mesh, frame, tile); });
+}
+
+void Rasterizer::setupTriangles(const RasterMesh& mesh, int chunk)
+{
+    int nTiles = tilesX * tilesY;
+    vector<Setup>& setups = chunkSetups[chunk];
+    setups.clear();
+    for (int tile = 0; tile < nTiles; tile++)
+        bins[(size_t)chunk * nTiles + tile].clear();
+
+    int first = chunk * trianglesPerChunk;
+    int last = min(first + trianglesPerChunk, mesh.getNbTriangles());
+    for (int t = first; t < last; t++) {
+        const unsigned int* triangle = &mesh.indices[(size_t)t * 3];
+        glm::vec4 c[3] = { clipPositions[triangle[0]], clipPositions[triangle[1]], clipPositions[triangle[2]] };
+
+        // Descarte quando os três vértices estão fora do mesmo plano do volume de recorte
+        bool outside = false;
+        for (int axis = 0; axis < 3 && !outside; axis++) {
+            outside = (c[0][axis] > c[0].w && c[1][axis] > c[1].w && c[2][axis] > c[2].w)
+                || (c[0][axis] < -c[0].w && c[1][axis] < -c[1].w && c[2][axis] < -c[2].w);
+        }
+        if (outside)
+            continue;
+
+        ClipVertex polygon[4];
+        int nPolygon = 0;
+        ClipVertex input[3];
+        for (int k = 0; k < 3; k++) {
+            input[k].position = c[k];
+            memcpy(input[k].attributes, &worldAttributes[(size_t)triangle[k] * 8], sizeof(input[k].attributes));
+        }
+
+        // Só o plano próximo (z >= -w) é recortado; os demais ficam para o retângulo de cada bloco
+        if (c[0].z >= -c[0].w && c[1].z >= -c[1].w && c[2].z >= -c[2].w) {
+            polygon[0] = input[0];
+            polygon[1] = input[1];
+            polygon[2] = input[2];
+            nPolygon = 3;
+        }
+        else {
+            for (int k = 0; k < 3; k++) {
+                const ClipVertex& a = input[k];
+                const ClipVertex& b = input[(k + 1) % 3];
+                float da = a.position.z + a.position.w;
+                float db = b.position.z + b.position.w;
+                if (da >= 0.0f)
+                    polygon[nPolygon++] = a;
+                if ((da >= 0.0f) != (db >= 0.0f))
+                    polygon[nPolygon++] = lerpVertex(a, b, da / (da - db));
+            }
+        }
+
+        // Leque de triângulos do polígono recortado
+        for (int k = 1; k + 1 < nPolygon; k++) {
+            const ClipVertex* corners[3] = { &polygon[0], &polygon[k], &polygon[k + 1] };
+            Setup setup;
+            for (int i = 0; i < 3; i++) {
+                const glm::vec4& p = corners[i]->position;
+                float invW = 1.0f / p.w;
+                setup.x[i] = (p.x * invW * 0.5f + 0.5f) * width;
+                setup.y[i] = (0.5f - p.y * invW * 0.5f) * height;
+                setup.z[i] = p.z * invW * 0.5f + 0.5f;
+                setup.invW[i] = invW;
+                for (int a = 0; a < 8; a++)
+                    setup.attributes[i][a] = corners[i]->attributes[a] * invW;
+            }
+
+            // Sem descarte de faces (o Módulo 5 não liga GL_CULL_FACE): todos ficam com área positiva
+            float area = (setup.x[1] - setup.x[0]) * (setup.y[2] - setup.y[0]) - (setup.x[2] - setup.x[0]) * (setup.y[1] - setup.y[0]);
+            if (area == 0.0f || area != area)
+                continue;
+            if (area < 0.0f) {
+                swap(setup.x[1], setup.x[2]);
+                swap(setup.y[1], setup.y[2]);
+                swap(setup.z[1], setup.z[2]);
+                swap(setup.invW[1], setup.invW[2]);
+                swap(setup.attributes[1], setup.attributes[2]);
+            }
+            setup.material = mesh.triangleMaterial[t];
+
+            float minX = min(setup.x[0], min(setup.x[1], setup.x[2]));
+            float maxX = max(setup.x[0], max(setup.x[1], setup.x[2]));
+            float minY = min(setup.y[0], min(setup.y[1], setup.y[2]));
+            float maxY = max(setup.y[0], max(setup.y[1], setup.y[2]));
+            if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height)
+                continue;
+
+            // Limita ainda em float: vértices muito fora da tela não cabem em int
+            int tileX0 = (int)max(minX, 0.0f) / tileSize;
+            int tileX1 = (int)min(maxX, (float)(width - 1)) / tileSize;
+            int tileY0 = (int)max(minY, 0.0f) / tileSize;
+            int tileY1 = (int)min(maxY, (float)(height - 1)) / tileSize;
+            int index = (int)setups.size();
+            setups.push_back(setup);
+            for (int ty = tileY0; ty <= tileY1; ty++)
+                for (int tx = tileX0; tx <= tileX1; tx++)
+                    bins[(size_t)chunk * nTiles + ty * tilesX + tx].push_back(index);
+            chunkBinned[chunk]++;
+        }
+    }
+}
+
+// Phong do sprite.fs; atributos já corrigidos pela perspectiva
+static uint32_t shadePixel(const RasterMesh& mesh, const RasterFrame& frame, int materialIndex, const float* attributes)
+{
+    const Material& material = mesh.materials[materialIndex];
+    const RasterTexture& texture = mesh.textures[materialIndex];
+    glm::vec3 fragPos = glm::make_vec3(attributes);
+    glm::vec2 texCoord = glm::make_vec2(attributes + 3);
+    glm::vec3 N = glm::normalize(glm::make_vec3(attributes + 5));
+
+    glm::vec3 ambient = frame.lightColor * material.ka;
+    glm::vec3 L = glm::normalize(frame.lightPos - fragPos);
+    float diff = max(glm::dot(N, L), 0.0f);
+    glm::vec3 diffuse = diff * frame.lightColor * material.kd;
+
+    glm::vec3 R = glm::reflect(-L, N);
+    glm::vec3 V = glm::normalize(frame.cameraPos - fragPos);
+    float spec = pow(max(glm::dot(R, V), 0.0f), material.ns);
+    glm::vec3 specular = spec * material.ks * frame.lightColor;
+
+    glm::vec4 texColor = texture.pixels.empty() ? glm::vec4(1.0f) : texture.sample(texCoord);
+    return packColor((ambient + diffuse) * glm::vec3(texColor) + specular + material.ke);
+}
+
+void Rasterizer::rasterizeTile(const RasterMesh& mesh, const RasterFrame& frame, int tile)
+{
+    int nTiles = tilesX * tilesY;
+    int tileX0 = (tile % tilesX) * tileSize;
+    int tileY0 = (tile / tilesX) * tileSize;
+    int tileX1 = min(tileX0 + tileSize, width);
+    int tileY1 = min(tileY0 + tileSize, height);
+
+    // As faixas são percorridas na ordem de envio, como a GPU faria com os triângulos
+    for (int chunk = 0; chunk < nChunks; chunk++) {
+        const vector<int>& bin = bins[(size_t)chunk * nTiles + tile];
+        for (int index : bin) {
+            const Setup& s = chunkSetups[chunk][index];
+
+            // Retângulo do triângulo dentro do bloco, com x alinhado a grupos de 4 pixels;
+            // limitado ao bloco ainda em float, como na montagem
+            int x0 = (int)max((float)tileX0, min(s.x[0], min(s.x[1], s.x[2]))) & ~3;
+            int x1 = min(tileX1, (int)min((float)tileX1, max(s.x[0], max(s.x[1], s.x[2]))) + 1);
+            int y0 = (int)max((float)tileY0, min(s.y[0], min(s.y[1], s.y[2])));
+            int y1 = min(tileY1, (int)min((float)tileY1, max(s.y[0], max(s.y[1], s.y[2]))) + 1);
+            if (x0 >= x1 || y0 >= y1)
+                continue;
+
+            // Funções de aresta E = A * (px - xa) + B * (py - ya), positivas dentro; a aresta i é oposta ao vértice i
+            float A[3], B[3];
+            bool topLeft[3];
+            for (int e = 0; e < 3; e++) {
+                int a = (e + 1) % 3;
+                int b = (e + 2) % 3;
+                A[e] = s.y[a] - s.y[b];
+                B[e] = s.x[b] - s.x[a];
+                // Regra topo-esquerda do GL: pixels exatamente na aresta só entram nas arestas de cima e da esquerda
+                topLeft[e] = A[e] > 0.0f || (A[e] == 0.0f && B[e] > 0.0f);
+            }
+            float invArea = 1.0f / (A[2] * (s.x[2] - s.x[0]) + B[2] * (s.y[2] - s.y[0]));
+            float px = x0 + 0.5f;
+
+#ifdef RASTERIZER_USE_SSE
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 allOnes = _mm_cmpeq_ps(zero, zero);
+            const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+            __m128 stepX[3], isTopLeft[3];
+            for (int e = 0; e < 3; e++) {
+                stepX[e] = _mm_set1_ps(A[e] * 4.0f);
+                isTopLeft[e] = topLeft[e] ? allOnes : zero;
+            }
+            const __m128 z0 = _mm_set1_ps(s.z[0]);
+            const __m128 dz1 = _mm_set1_ps((s.z[1] - s.z[0]) * invArea);
+            const __m128 dz2 = _mm_set1_ps((s.z[2] - s.z[0]) * invArea);
+#else
+            float dz1 = (s.z[1] - s.z[0]) * invArea;
+            float dz2 = (s.z[2] - s.z[0]) * invArea;
+#endif
+
+            for (int y = y0; y < y1; y++) {
+                float py = y + 0.5f;
+                float* depthRow = &depth[(size_t)y * stride];
+                uint32_t* colorRow = &color[(size_t)y * stride];
+
+#ifdef RASTERIZER_USE_SSE
+                __m128 E[3];
+                for (int e = 0; e < 3; e++) {
+                    int a = (e + 1) % 3;
+                    float rowStart = A[e] * (px - s.x[a]) + B[e] * (py - s.y[a]);
+                    E[e] = _mm_add_ps(_mm_set1_ps(rowStart), _mm_mul_ps(lane, _mm_set1_ps(A[e])));
+                }
+#else
+                // Mesmas operações das posições SSE, para o resultado não depender do caminho
+                float E[3][4];
+                for (int e = 0; e < 3; e++) {
+                    int a = (e + 1) % 3;
+                    float rowStart = A[e] * (px - s.x[a]) + B[e] * (py - s.y[a]);
+                    for (int i = 0; i < 4; i++)
+                        E[e][i] = rowStart + i * A[e];
+                }
+#endif
+
+                for (int x = x0; x < x1; x += 4) {
+                    alignas(16) float e1[4], e2[4], z[4];
+                    int mask = 0;
+#ifdef RASTERIZER_USE_SSE
+                    // Cobertura dos 4 pixels: E > 0, ou E >= 0 nas arestas topo-esquerda
+                    __m128 inside = allOnes;
+                    for (int e = 0; e < 3; e++) {
+                        __m128 edgeInside = _mm_or_ps(_mm_cmpgt_ps(E[e], zero), _mm_and_ps(isTopLeft[e], _mm_cmpeq_ps(E[e], zero)));
+                        inside = _mm_and_ps(inside, edgeInside);
+                    }
+                    if (_mm_movemask_ps(inside)) {
+                        // Profundidade interpolada linearmente na tela e testada com GL_LESS
+                        __m128 depth4 = _mm_add_ps(z0, _mm_add_ps(_mm_mul_ps(E[1], dz1), _mm_mul_ps(E[2], dz2)));
+                        inside = _mm_and_ps(inside, _mm_cmplt_ps(depth4, _mm_loadu_ps(depthRow + x)));
+                        mask = _mm_movemask_ps(inside);
+                        if (mask) {
+                            _mm_store_ps(e1, E[1]);
+                            _mm_store_ps(e2, E[2]);
+                            _mm_store_ps(z, depth4);
+                        }
+                    }
+                    for (int e = 0; e < 3; e++)
+                        E[e] = _mm_add_ps(E[e], stepX[e]);
+#else
+                    for (int i = 0; i < 4; i++) {
+                        bool covered = true;
+                        for (int e = 0; e < 3; e++)
+                            covered = covered && (E[e][i] > 0.0f || (E[e][i] == 0.0f && topLeft[e]));
+                        e1[i] = E[1][i];
+                        e2[i] = E[2][i];
+                        z[i] = s.z[0] + (E[1][i] * dz1 + E[2][i] * dz2);
+                        if (covered && z[i] < depthRow[x + i])
+                            mask |= 1 << i;
+                    }
+                    for (int e = 0; e < 3; e++)
+                        for (int i = 0; i < 4; i++)
+                            E[e][i] += A[e] * 4.0f;
+#endif
+                    // Pixels além da largura (preenchimento do stride) nunca são escritos
+                    if (x + 4 > tileX1)
+                        mask &= (1 << (tileX1 - x)) - 1;
+
+                    for (int i = 0; mask; i++, mask >>= 1) {
+                        if (!(mask & 1))
+                            continue;
+                        // Baricêntricas de tela, corrigidas pela perspectiva com 1/w
+                        float b1 = e1[i] * invArea;
+                        float b2 = e2[i] * invArea;
+                        float b0 = 1.0f - b1 - b2;
+                        float w = 1.0f / (b0 * s.invW[0] + b1 * s.invW[1] + b2 * s.invW[2]);
+                        float attributes[8];
+                        for (int a = 0; a < 8; a++)
+                            attributes[a] = (b0 * s.attributes[0][a] + b1 * s.attributes[1][a] + b2 * s.attributes[2][a]) * w;
+
+                        depthRow[x + i] = z[i];
+                        colorRow[x + i] = shadePixel(mesh, frame, s.material, attributes);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "MtlLoader.h"
+#include "ThreadPool.h"
+
+// Imagem de map_Kd em RGBA8, amostrada com filtro bilinear e repetição; a linha 0 é t = 0,
+// como na textura enviada sem inverter pelo Módulo 5. Não há mipmaps: o Módulo 5 usa
+// GL_LINEAR_MIPMAP_LINEAR, então texturas vistas reduzidas podem sair diferentes
+struct RasterTexture
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+
+    glm::vec4 sample(const glm::vec2& uv) const;
+};
+
+// Malha indexada com os materiais do MTL: o equivalente, na CPU, ao VAO e às texturas do Módulo 5
+struct RasterMesh
+{
+    std::vector<float> vertices;        // 8 floats por vértice (posição, textura, normal), em espaço de modelo
+    std::vector<unsigned int> indices;
+    std::vector<int> triangleMaterial;  // posição em materials
+    std::vector<Material> materials;    // faces sem material usam o último, como no Módulo 5
+    std::vector<RasterTexture> textures; // uma por material (vazia se não houver map_Kd)
+
+    bool load(const std::string& objPath, int nThreads = 0);
+    int getNbTriangles() const { return (int)(indices.size() / 3); }
+};
+
+// Estado que o Módulo 5 passa nos blocos PerFrame e PerLight
+struct RasterFrame
+{
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    glm::vec3 lightPos = glm::vec3(0.0f);
+    glm::vec3 lightColor = glm::vec3(1.0f);
+};
+
+// Rasterizador em blocos: os triângulos são transformados e distribuídos em faixas de
+// triângulos entre as threads, cada faixa anota em quais blocos da tela cada triângulo cai
+// e depois cada bloco é rasterizado por uma única thread, percorrendo as faixas na ordem
+// de envio (o resultado não depende de quantas threads existem). As funções de aresta são
+// avaliadas para quatro pixels por vez em SSE, com teste de profundidade GL_LESS.
+class Rasterizer
+{
+public:
+    // nThreads <= 0 usa todas as threads de hardware
+    explicit Rasterizer(int nThreads = 0);
+
+    void resize(int width, int height);
+    void clear(const glm::vec3& color);
+    // Desenha a malha com a mesma transformação (projection * view * model) e o Phong do sprite.fs
+    void draw(const RasterMesh& mesh, const glm::mat4& model, const RasterFrame& frame);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getNbThreads() const { return pool.getNbThreads(); }
+    // width x height pixels RGBA8, linha 0 no topo
+    void readPixels(std::vector<unsigned char>& rgba) const;
+
+    // Contadores do último draw
+    int getNbTrianglesBinned() const { return nTrianglesBinned; }
+
+private:
+    Rasterizer(const Rasterizer&);
+    Rasterizer& operator=(const Rasterizer&);
+
+    // Triângulo pronto para a rasterização, em coordenadas de tela
+    struct Setup
+    {
+        float x[3], y[3];
+        float z[3];            // profundidade de janela
+        float invW[3];
+        float attributes[3][8]; // posição de mundo, textura e normal de mundo, já divididas por w
+        int material;
+    };
+
+    void setupTriangles(const RasterMesh& mesh, int chunk);
+    void rasterizeTile(const RasterMesh& mesh, const RasterFrame& frame, int tile);
+
+    ThreadPool pool;
+    int width;
+    int height;
+    int stride;   // largura arredondada para múltiplo de 4 (um grupo SSE por vez)
+    int tilesX;
+    int tilesY;
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+
+    // Vértices transformados: posição de recorte e atributos em espaço de mundo
+    std::vector<glm::vec4> clipPositions;
+    std::vector<float> worldAttributes;
+    // Triângulos montados e, por faixa de triângulos, a lista de cada bloco
+    std::vector<std::vector<Setup>> chunkSetups;
+    std::vector<std::vector<int>> bins; // bins[chunk * nTiles + tile]
+    std::vector<int> chunkBinned;
+    int nChunks;
+    int nTrianglesBinned;
+};